@@ -7,41 +7,76 @@
 #include <sensor_msgs/JointState.h>
 #include <gazebo_msgs/LinkState.h>
 #include <geometry_msgs/Pose.h>
+#include <cdpr/TrajectoryPreview.h>
 #include <visp/vpHomogeneousMatrix.h>
+#include <cdpr/dynamics.h>
+#include <cdpr/observer.h>
+#include <mutex>
+#include <memory>
+
+// callbacks and accessors are guarded by a mutex, so that the control tick
+// may run on another thread than the one processing the ROS callbacks
 
 class CDPR
 {
+    typedef std::lock_guard<std::mutex> Lock;
 public:
     CDPR(ros::NodeHandle &_nh);
 
-    inline bool ok() {return cables_ok && platform_ok && trajectory_ok ;}
+    inline bool ok() {Lock lock(mtx); return cables_ok && platform_ok && trajectory_ok ;}
 
     inline void setDesiredPose(double x, double y, double z, double tx, double ty, double tz)
-        {Md_ = vpHomogeneousMatrix(x,y,z,tx,ty,tz);}
-    inline void getPose(vpHomogeneousMatrix &M) {M = M_;}
-    inline void getVelocity(vpColVector &v) {v = v_;}
-    inline void getDesiredPose(vpHomogeneousMatrix &M) {M = Md_;}
-    inline vpPoseVector getPoseError() { return vpPoseVector(M_.inverse()*Md_);}
+        {Lock lock(mtx); Md_ = vpHomogeneousMatrix(x,y,z,tx,ty,tz);}
+    inline void getPose(vpHomogeneousMatrix &M) {Lock lock(mtx); M = pose();}
+    inline void getVelocity(vpColVector &v) {Lock lock(mtx); v = observer ? v_est : v_;}
+    // only available with the observer
+    inline void getAcceleration(vpColVector &a) {Lock lock(mtx); a = a_est;}
+    inline void getDesiredPose(vpHomogeneousMatrix &M) {Lock lock(mtx); M = Md_;}
+    inline vpPoseVector getPoseError() {Lock lock(mtx); return vpPoseVector(pose().inverse()*Md_);}
     inline vpPoseVector getDesiredPoseError(vpHomogeneousMatrix &M_p, vpHomogeneousMatrix &M_c) {return vpPoseVector(M_c.inverse()*M_p);}
 
-    inline void getDesiredVelocity(vpColVector &v) {v = v_d;}
-    inline void getDesiredAcceleration(vpColVector &a) {a = a_d;}
+    inline void getDesiredVelocity(vpColVector &v) {Lock lock(mtx); v = v_d;}
+    inline void getDesiredAcceleration(vpColVector &a) {Lock lock(mtx); a = a_d;}
+
+    // samples the desired pose, velocity and acceleration at time t from the last trajectory preview
+    // to be called at each control tick, before the getters above; does nothing without a preview
+    void updateDesired(const ros::Time &t = ros::Time::now());
 
     void sendTensions(vpColVector &f);
+    // setpoint for the cable-space inner loop of the Gazebo plugin:
+    // desired lengths, length rates and feedforward tensions
+    void sendCableSetpoint(const vpColVector &L, const vpColVector &dL, const vpColVector &f);
 
     // get model parameters
     inline unsigned int n_cables() {return n_cable;}
     inline double mass() {return mass_;}
     inline vpMatrix inertia() {return inertia_;}
     inline void tensionMinMax(double &fmin, double &fmax) {fmin = f_min; fmax = f_max;}
+    // axial stiffness EA of the cables [N], the stiffness of a cable is EA/L
+    inline double cableStiffness() {return stiffness_;}
 
-    // structure matrix
-    //void computeW(vpMatrix &W);
+    // structure matrix, in platform frame
     void computeW(vpMatrix &W);
+    // at any pose, e.g. for offline computations
+    void computeW(const vpHomogeneousMatrix &M, vpMatrix &W);
     void computeDesiredW(vpMatrix &Wd);
     void computeLength(vpColVector &L);
     void computeDesiredLength(vpColVector &Ld);
+
+    // platform dynamics, see dynamics.h
+    // model with the mass and inertia of the platform
+    PlatformDynamics dynamicsModel();
+    // updates dyn from the current pose and twist
+    void computeDynamics(PlatformDynamics &dyn);
+
+    // state observer, see observer.h
+    // once enabled, the pose / velocity accessors and the model computations use the estimates
+    void enableObserver(const StateObserver::Noise &noise = StateObserver::Noise());
+    // to be called at each control tick: predicts over dt and fuses the measurements received since the last call
+    void updateObserver(double dt);
 protected:
+    std::mutex mtx;
+
     // subscriber to gazebo data
     ros::Subscriber cables_sub, platform_sub;
     bool cables_ok, platform_ok, trajectory_ok;
@@ -49,18 +84,35 @@ protected:
 
     // subscriber to desired pose
     ros::Subscriber setpoint_sub, desiredVel_sub, desiredAcc_sub;
+    // or to the trajectory preview
+    ros::Subscriber preview_sub;
+    cdpr::TrajectoryPreviewConstPtr preview;
 
     // publisher to tensions
     ros::Publisher tensions_pub;
     sensor_msgs::JointState tensions_msg;
+    ros::Publisher setpoint_pub;
+    sensor_msgs::JointState setpoint_msg;
     
 
     // pf pose and velocity
     vpHomogeneousMatrix M_, Md_;
     vpColVector v_, v_d, a_d;
 
+    // observer and its estimates
+    std::unique_ptr<StateObserver> observer;
+    vpHomogeneousMatrix M_est;
+    vpColVector v_est, a_est;
+    // new measurements since the last update, and their buffers
+    bool pose_new, cables_new;
+    std::vector<double> L_meas, dL_meas;
+    // cable lengths at the joint zero (home pose)
+    vpColVector L0;
+
+    inline const vpHomogeneousMatrix& pose() const {return observer ? M_est : M_;}
+
     // model data
-    double mass_, f_min, f_max;
+    double mass_, f_min, f_max, stiffness_;
     vpMatrix inertia_;
     std::vector<vpTranslationVector> Pf, Pp;
     unsigned int n_cable;
@@ -69,7 +121,9 @@ protected:
     // callback for platform state
     void PFState_cb(const gazebo_msgs::LinkStateConstPtr &_msg)
     {
+        Lock lock(mtx);
         platform_ok = true;
+        pose_new = true;
         M_.insert(vpTranslationVector(_msg->pose.position.x, _msg->pose.position.y, _msg->pose.position.z));
         M_.insert(vpQuaternionVector(_msg->pose.orientation.x, _msg->pose.orientation.y, _msg->pose.orientation.z,_msg->pose.orientation.w));
         v_.resize(6);
@@ -80,6 +134,7 @@ protected:
     // callback for pose setpoint
     void Setpoint_cb(const geometry_msgs::PoseConstPtr &_msg)
     {
+        Lock lock(mtx);
         Md_.insert(vpTranslationVector(_msg->position.x, _msg->position.y, _msg->position.z)); 
         Md_.insert(vpQuaternionVector(_msg->orientation.x, _msg->orientation.y, _msg->orientation.z,_msg->orientation.w));
     }
@@ -87,20 +142,31 @@ protected:
     // callback for cable states
     void Cables_cb(const sensor_msgs::JointState &_msg)
     {
+        Lock lock(mtx);
         cables_ok = true;
+        cables_new = true;
         cable_states = _msg;
     }
 
     void DesiredVel_cb(const geometry_msgs::TwistConstPtr &_msg)
     {   
+        Lock lock(mtx);
         trajectory_ok=true;
         v_d.resize(6);
         v_d[0]=_msg->linear.x; v_d[1]=_msg->linear.y; v_d[2]=_msg->linear.z;
         v_d[3]=_msg->angular.x; v_d[4]=_msg->angular.y; v_d[5]=_msg->angular.z;       
     }
 
+    void Preview_cb(const cdpr::TrajectoryPreviewConstPtr &_msg)
+    {
+        Lock lock(mtx);
+        trajectory_ok = true;
+        preview = _msg;
+    }
+
     void DesiredAcc_cb(const geometry_msgs::TwistConstPtr &_msg)
     {
+        Lock lock(mtx);
         a_d.resize(6);
         a_d[0]=_msg->linear.x; a_d[1]=_msg->linear.y; a_d[2]=_msg->linear.z;
         a_d[3]=_msg->angular.x; a_d[4]=_msg->angular.y; a_d[5]=_msg->angular.z;
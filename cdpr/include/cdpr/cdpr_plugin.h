@@ -7,6 +7,7 @@
 #include <sensor_msgs/JointState.h>
 #include <gazebo_msgs/LinkState.h>
 #include <cdpr/Tensions.h>
+#include <algorithm>
 
 namespace gazebo
 {
@@ -41,6 +42,27 @@ private:
         command_received_ = true;
     }
 
+    // length setpoint for the inner loop
+    void CableSetpointCallBack(const sensor_msgs::JointStateConstPtr &_msg)
+    {
+        if(_msg->name.size() != _msg->position.size())
+        {
+            ROS_WARN("Received inconsistent cable setpoint dimensions");
+            return;
+        }
+        for(unsigned int i = 0; i < _msg->name.size(); ++i)
+        {
+            const auto joint = std::find(joint_states_.name.begin(), joint_states_.name.end(), _msg->name[i]);
+            if(joint == joint_states_.name.end())
+                continue;
+            const unsigned int idx = joint - joint_states_.name.begin();
+            setpoint_L_[idx] = _msg->position[i];
+            setpoint_dL_[idx] = i < _msg->velocity.size() ? _msg->velocity[i] : 0;
+            setpoint_ff_[idx] = i < _msg->effort.size() ? _msg->effort[i] : 0;
+        }
+        setpoint_received_ = true;
+    }
+
     // full cable tensions
     void TensionCallBack(const cdpr::TensionsConstPtr &msg)
     {
@@ -88,6 +110,18 @@ private:
     std::vector<Tension> tension_command_;
     bool command_received_;
 
+    // -- cable-space inner loop ----------------------------------
+    // runs at the physics rate when /model/inner_loop/enabled is set
+    // the controller sends length setpoints on cable_setpoint (position = L, velocity = dL/dt, effort = feedforward)
+    // applied tension = feedforward + Kp.(L - Ld) + Kd.(dL - dLd), clamped to [0, f_max]
+    bool inner_loop_;
+    double inner_Kp_, inner_Kd_;
+    // cable lengths at joint position 0 (home pose), L = L0 - q
+    std::vector<double> L0_;
+    std::vector<double> setpoint_L_, setpoint_dL_, setpoint_ff_;
+    ros::Subscriber setpoint_subscriber_;
+    bool setpoint_received_;
+
 
     // -- publishers ----------------------------------------
 
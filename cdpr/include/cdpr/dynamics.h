@@ -0,0 +1,86 @@
+#ifndef CDPR_DYNAMICS_H
+#define CDPR_DYNAMICS_H
+
+#include <Eigen/Core>
+
+// rigid-body dynamics of the platform in the world frame, for computed-torque control
+// with the twist v = (linear velocity, angular velocity ω) and the acceleration a, the wrench to apply is
+//      w = M.a + c - g
+// where
+//      M = diag(m.I3, R.I.R^T)        mass matrix
+//      c = (0, ω x (R.I.R^T).ω)       Coriolis / centrifugal wrench
+//      g = (0, 0, -m.g0, 0, 0, 0)     gravity wrench
+// all terms use fixed-size types and are computed in closed form without allocation
+
+class PlatformDynamics
+{
+public:
+    typedef Eigen::Matrix3d Matrix3d;
+    typedef Eigen::Vector3d Vector3d;
+    typedef Eigen::Matrix<double, 6, 6> Matrix6d;
+    typedef Eigen::Matrix<double, 6, 1> Vector6d;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    PlatformDynamics(double mass = 0, const Matrix3d &inertia = Matrix3d::Zero(), double g0 = 9.81)
+    {
+        setModel(mass, inertia, g0);
+    }
+
+    // mass and inertia in the platform frame
+    inline void setModel(double mass, const Matrix3d &inertia, double g0 = 9.81)
+    {
+        m = mass;
+        I = inertia;
+        g.setZero();
+        g(2) = -m*g0;
+        M.setZero();
+        M.topLeftCorner<3,3>().diagonal().setConstant(m);
+        Iw = I;
+        c.setZero();
+    }
+
+    // updates the terms for the platform orientation R (platform to world) and twist v in world frame
+    inline void update(const Matrix3d &R, const Vector6d &v)
+    {
+        Iw.noalias() = R * I * R.transpose();
+        M.bottomRightCorner<3,3>() = Iw;
+        const Vector3d omega = v.tail<3>();
+        c.tail<3>() = omega.cross(Iw*omega);
+    }
+
+    inline double mass() const {return m;}
+    // inertia in platform and world frames
+    inline const Matrix3d& inertia() const {return I;}
+    inline const Matrix3d& worldInertia() const {return Iw;}
+
+    inline const Matrix6d& massMatrix() const {return M;}
+    inline const Vector6d& coriolis() const {return c;}
+    inline const Vector6d& gravity() const {return g;}
+
+    // w = M.a + c - g, exploiting the block-diagonal structure of M
+    inline Vector6d wrench(const Vector6d &a) const
+    {
+        Vector6d w;
+        w.head<3>() = m*a.head<3>();
+        w.tail<3>().noalias() = Iw*a.tail<3>();
+        return w + c - g;
+    }
+
+    // M.a only
+    inline Vector6d inertiaWrench(const Vector6d &a) const
+    {
+        Vector6d w;
+        w.head<3>() = m*a.head<3>();
+        w.tail<3>().noalias() = Iw*a.tail<3>();
+        return w;
+    }
+
+protected:
+    double m;
+    Matrix3d I, Iw;
+    Matrix6d M;
+    Vector6d c, g;
+};
+
+#endif // CDPR_DYNAMICS_H
@@ -0,0 +1,80 @@
+#ifndef CDPR_GRID_MAP_H
+#define CDPR_GRID_MAP_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// regular 3D grid over the platform position, with a few float fields per cell
+// written offline, then memory-mapped read-only: a lookup is a trilinear interpolation on 8 cells
+//
+// file layout (native endianness):
+//  - grid_map::Header
+//  - field names, FIELD_NAME bytes each
+//  - cells as floats, fields of a cell are contiguous, x varies fastest
+
+namespace grid_map
+{
+
+const char MAGIC[8] = {'C','D','P','R','G','R','D','\0'};
+const uint32_t VERSION = 1;
+const unsigned int FIELD_NAME = 32;
+
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t fields;
+    uint32_t size[3];       // cells along x, y, z
+    uint32_t data_offset;   // bytes
+    double origin[3];       // position of cell (0,0,0)
+    double step[3];
+};
+
+}
+
+class GridMap
+{
+public:
+    // data has size[0]*size[1]*size[2]*names.size() values
+    static bool write(const std::string &file, const unsigned int size[3], const double origin[3], const double step[3],
+                      const std::vector<std::string> &names, const std::vector<float> &data);
+
+    explicit GridMap(const std::string &file);
+    ~GridMap();
+    GridMap(const GridMap&) = delete;
+    GridMap& operator=(const GridMap&) = delete;
+
+    inline bool ok() const {return cells != nullptr;}
+    inline unsigned int fields() const {return header.fields;}
+    inline const std::vector<std::string>& names() const {return names_;}
+    // index of a field, -1 if not found
+    int field(const std::string &name) const;
+
+    inline unsigned int size(unsigned int axis) const {return header.size[axis];}
+    inline double origin(unsigned int axis) const {return header.origin[axis];}
+    inline double step(unsigned int axis) const {return header.step[axis];}
+
+    inline const float* cell(unsigned int i, unsigned int j, unsigned int k) const
+    {
+        return cells + header.fields*(i + (size_t) header.size[0]*(j + (size_t) header.size[1]*k));
+    }
+
+    // all fields at (x, y, z), the position is clamped to the grid
+    // returns false if the position was outside
+    bool interpolate(double x, double y, double z, double *out) const;
+    // only one field
+    bool interpolate(double x, double y, double z, unsigned int field, double &value) const;
+
+protected:
+    // fields [first, first+count)
+    bool interpolate(double x, double y, double z, unsigned int first, unsigned int count, double *out) const;
+
+    grid_map::Header header;
+    std::vector<std::string> names_;
+    char* data;
+    size_t bytes;
+    const float* cells;
+};
+
+#endif // CDPR_GRID_MAP_H
@@ -0,0 +1,73 @@
+#ifndef CDPR_INTERFERENCE_H
+#define CDPR_INTERFERENCE_H
+
+#include <ros/ros.h>
+#include <visp/vpHomogeneousMatrix.h>
+#include <vector>
+
+// clearances between the cables, and between the cables and the platform box, at a given pose
+// cables are segments of radius r from the frame points to the platform points
+//
+// - broadphase: pairs whose bounding boxes are farther than range are culled
+// - narrowphase: segment-segment distances of the remaining pairs, branch-free on contiguous arrays
+//   so that the compiler vectorizes the loop
+// - cables that share an anchor always touch there by design (pulleys), their distance is not meaningful:
+//   the angle between them is checked instead
+// - the cable-platform clearance ignores the first anchor_offset of the cable from the platform point,
+//   it is negative if the cable goes through the box
+//
+// does not allocate after construction, use one instance per thread
+
+class Interference
+{
+public:
+    struct Result
+    {
+        double cable;               // smallest clearance between two cables [m], range if no pair is closer
+        int pair[2];                // cables of that pair, -1 if none
+        double platform;            // smallest clearance between a cable and the platform [m]
+        int cable_platform;         // that cable
+        double anchor_angle;        // smallest angle between cables that share an anchor [rad], pi if none
+        int anchor_pair[2];
+        unsigned int candidates;    // pairs kept by the broadphase
+
+        inline bool ok(double min_angle = 0.01) const {return cable > 0 && platform > 0 && anchor_angle > min_angle;}
+    };
+
+    // model parameters: attach points in frame / platform frames, platform box centered on the platform frame
+    Interference(const std::vector<vpTranslationVector> &Pf, const std::vector<vpTranslationVector> &Pp,
+                 const double platform_size[3], double radius, double range = 0.1, double anchor_offset = 0.05);
+    // from the model on the parameter server, as in CDPR (points, platform/size, cable/radius)
+    explicit Interference(ros::NodeHandle &nh, double range = 0.1, double anchor_offset = 0.05);
+
+    inline unsigned int n_cables() const {return n;}
+
+    // platform pose in world frame
+    void compute(const vpHomogeneousMatrix &M, Result &result);
+    // same with R row-major and t
+    void compute(const double R[9], const double t[3], Result &result);
+
+    // clearance of each pair of the last call, range for culled pairs and pairs sharing an anchor
+    inline double clearance(unsigned int i, unsigned int j) const
+    {
+        return i < j ? pair_clearance[i*n + j] : pair_clearance[j*n + i];
+    }
+
+protected:
+    void init(const std::vector<vpTranslationVector> &Pf, const std::vector<vpTranslationVector> &Pp,
+              const double platform_size[3]);
+
+    unsigned int n;
+    double radius, range, anchor_offset, half[3];
+    std::vector<double> frame, platform;        // attach points, 3 per cable
+    // pairs that share an anchor, and the others
+    std::vector<unsigned int> shared_i, shared_j, pair_i, pair_j;
+
+    // per call: world segments, bounding boxes, candidate pairs as contiguous arrays
+    std::vector<double> p, q, box_lo, box_hi;
+    std::vector<unsigned int> cand;
+    std::vector<double> p1[3], d1[3], p2[3], d2[3], dist;
+    std::vector<double> pair_clearance;
+};
+
+#endif // CDPR_INTERFERENCE_H
@@ -0,0 +1,83 @@
+#ifndef CDPR_LOG_H
+#define CDPR_LOG_H
+
+#include <atomic>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+// asynchronous logging for the control loops
+// messages are formatted into a lock-free ring buffer and written to the terminal by a background thread
+// so that the control thread never waits on terminal I/O
+//
+// usage: CDPR_DEBUG("Pose error: " << err.t());
+//
+// levels are gated twice:
+//  - at compile time with CDPR_LOG_MIN_LEVEL (0 = debug ... 4 = nothing), statements below are removed
+//  - at runtime with cdpr_log::setLevel, a disabled statement only costs an atomic load and a comparison
+//    (its arguments are not evaluated)
+
+#ifndef CDPR_LOG_MIN_LEVEL
+#define CDPR_LOG_MIN_LEVEL 0
+#endif
+
+namespace cdpr_log
+{
+
+enum Level {DEBUG = 0, INFO = 1, WARN = 2, ERROR = 3, NONE = 4};
+
+// runtime level, default INFO
+extern std::atomic<int> runtime_level;
+
+inline bool enabled(Level level)
+{
+    return level >= runtime_level.load(std::memory_order_relaxed);
+}
+inline void setLevel(Level level) {runtime_level = level;}
+// from "debug", "info", "warn", "error" or "none", returns false if unknown
+bool setLevel(const std::string &level);
+
+// waits until all pending messages have been written
+void flush();
+
+// one message being formatted in a slot of the ring buffer
+// the slot is released to the writer thread when the message is destroyed
+class Message
+{
+public:
+    explicit Message(Level level);
+    ~Message();
+    inline std::ostream& stream() {return os;}
+
+protected:
+    // stream buffer writing directly into the slot, truncates long messages
+    struct SlotBuf : public std::streambuf
+    {
+        void reset(char *begin, size_t size) {setp(begin, begin + size);}
+        size_t length() const {return pptr() - pbase();}
+    protected:
+        int_type overflow(int_type c) {return traits_type::eof();}
+    };
+
+    void *slot;
+    SlotBuf buf;
+    std::ostream os;
+};
+
+}
+
+#define CDPR_LOG_STREAM(level, args)                                            \
+    do {                                                                        \
+        if(level >= CDPR_LOG_MIN_LEVEL && cdpr_log::enabled(level))            \
+        {                                                                       \
+            cdpr_log::Message cdpr_log_msg(level);                              \
+            cdpr_log_msg.stream() << args;                                      \
+        }                                                                       \
+    } while(0)
+
+#define CDPR_DEBUG(args) CDPR_LOG_STREAM(cdpr_log::DEBUG, args)
+#define CDPR_INFO(args) CDPR_LOG_STREAM(cdpr_log::INFO, args)
+#define CDPR_WARN(args) CDPR_LOG_STREAM(cdpr_log::WARN, args)
+#define CDPR_ERROR(args) CDPR_LOG_STREAM(cdpr_log::ERROR, args)
+
+#endif // CDPR_LOG_H
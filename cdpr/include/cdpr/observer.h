@@ -0,0 +1,106 @@
+#ifndef CDPR_OBSERVER_H
+#define CDPR_OBSERVER_H
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <vector>
+
+// error-state Kalman filter for the platform state
+// fuses the platform pose, the cable lengths and the cable rates through the cable directions (columns of W)
+//
+// nominal state: position p, orientation q, linear / angular velocity v, ω, linear / angular acceleration a, α
+// all in the world (frame) coordinates, with a constant acceleration model driven by white jerk
+// error state (18): δp, δθ, δv, δω, δa, δα, with R = exp(δθ).R_nominal
+//
+// measurements are processed as sequential scalar updates, no matrix is inverted
+// all storage is fixed-size: predict() and update*() do not allocate
+
+class StateObserver
+{
+public:
+    typedef Eigen::Vector3d Vector3d;
+    typedef Eigen::Matrix3d Matrix3d;
+    typedef Eigen::Quaterniond Quaterniond;
+    typedef Eigen::Matrix<double, 6, 1> Vector6d;
+    typedef Eigen::Matrix<double, 18, 1> Vector18d;
+    typedef Eigen::Matrix<double, 18, 18> Matrix18d;
+
+    // indices in the error state
+    enum {POS = 0, ROT = 3, VEL = 6, OMEGA = 9, ACC = 12, ALPHA = 15};
+
+    // standard deviations
+    struct Noise
+    {
+        Noise() : jerk(2), angular_jerk(2), position(1e-3), orientation(2e-3),
+            velocity(1e-2), angular_velocity(1e-2), length(2e-4), length_rate(5e-3) {}
+        // process: white jerk spectral density [m/s^3/sqrt(Hz)], [rad/s^3/sqrt(Hz)]
+        double jerk, angular_jerk;
+        // pose measurement [m], [rad]
+        double position, orientation;
+        // twist measurement [m/s], [rad/s]
+        double velocity, angular_velocity;
+        // cable encoders [m], [m/s]
+        double length, length_rate;
+    };
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    // cable attach points on the frame (world) and on the platform (platform frame)
+    StateObserver(const std::vector<Vector3d> &frame_points, const std::vector<Vector3d> &platform_points,
+                  const Noise &noise = Noise());
+
+    // initial pose at rest, with the given position / orientation uncertainty
+    void reset(const Vector3d &position, const Quaterniond &orientation, double sigma_p = 1e-2, double sigma_r = 1e-2);
+
+    // propagates the state over dt
+    void predict(double dt);
+
+    // measurements
+    void updatePose(const Vector3d &position, const Quaterniond &orientation);
+    // linear and angular velocity in world frame
+    void updateTwist(const Vector6d &twist);
+    // lengths of all cables, and their rates if dL is not null
+    void updateCables(const double *L, const double *dL = nullptr);
+
+    // estimates
+    inline const Vector3d& position() const {return p;}
+    inline const Quaterniond& orientation() const {return q;}
+    inline Matrix3d rotation() const {return q.toRotationMatrix();}
+    inline Vector6d twist() const
+    {
+        Vector6d t;
+        t << v, w;
+        return t;
+    }
+    inline Vector6d acceleration() const
+    {
+        Vector6d acc;
+        acc << a, alpha;
+        return acc;
+    }
+    inline const Matrix18d& covariance() const {return P;}
+    inline unsigned int cables() const {return Pf.size();}
+
+protected:
+    std::vector<Vector3d> Pf, Pp;
+    Noise noise;
+
+    // nominal state
+    Vector3d p, v, w, a, alpha;
+    Quaterniond q;
+
+    // error state and its covariance
+    Vector18d dx;
+    Matrix18d P, F, Q;
+    double Q_dt;
+
+    // scalar measurement y = h0.δx[i0..i0+2] (+ h1.δx[i1..i1+2]), with variance r
+    // residual is z - h(x_nominal)
+    void scalarUpdate(int i0, const Vector3d &h0, double residual, double r);
+    void scalarUpdate(int i0, const Vector3d &h0, int i1, const Vector3d &h1, double residual, double r);
+
+    // moves the error state into the nominal state
+    void inject();
+};
+
+#endif // CDPR_OBSERVER_H
@@ -0,0 +1,83 @@
+#ifndef CDPR_OBSTACLES_H
+#define CDPR_OBSTACLES_H
+
+#include <ros/ros.h>
+#include <visp/vpHomogeneousMatrix.h>
+#include <vector>
+#include <string>
+
+// clearances between the cables and static triangle meshes of the cell (fixtures, walls...)
+// cables are segments of radius r from the frame points to the platform points
+//
+// the meshes are loaded once (STL, ascii or binary) into a bounding volume hierarchy of axis-aligned boxes
+// a query only visits the boxes that the segment crosses once inflated by the best distance found so far,
+// and stops looking farther than range: far obstacles cost a few box tests
+//
+// queries are const, one instance can be shared between threads
+
+class Obstacles
+{
+public:
+    struct Result
+    {
+        double clearance;               // smallest clearance between a cable and an obstacle [m], range if none is closer
+        int cable;                      // that cable, -1 if none
+        int triangle;                   // that triangle, in loading order
+        unsigned int tests;             // boxes and triangles tested
+        std::vector<double> cables;     // clearance of each cable
+
+        inline bool ok() const {return clearance > 0;}
+    };
+
+    // cables given by their attach points in frame / platform frames
+    Obstacles(const std::vector<vpTranslationVector> &Pf, const std::vector<vpTranslationVector> &Pp,
+              double radius, double range = 0.1);
+    // from the model on the parameter server: points, cable/radius and obstacles, a list of
+    // {mesh: package://pkg/file.stl or path, xyz: [x, y, z], rpy: [r, p, y], scale: s}, as given to gen_cdpr.py
+    explicit Obstacles(ros::NodeHandle &nh, double range = 0.1);
+
+    // adds the triangles of a STL file, transformed by M after scaling, false if it cannot be read
+    // build() has to be called again
+    bool load(const std::string &file, const vpHomogeneousMatrix &M = vpHomogeneousMatrix(), double scale = 1);
+    void add(const double a[3], const double b[3], const double c[3]);
+    // hierarchy with at most leaf_size triangles per leaf
+    void build(unsigned int leaf_size = 4);
+
+    inline size_t triangles() const {return tri.size()/9;}
+    inline unsigned int n_cables() const {return n;}
+    inline bool empty() const {return tri.empty();}
+
+    // distance from the segment [p, q] to the closest triangle, range if none is closer
+    // triangle is set to its index or -1, tests is incremented by the boxes and triangles tested
+    double distance(const double p[3], const double q[3], double range, int *triangle = nullptr, unsigned int *tests = nullptr) const;
+    // same without the hierarchy, for reference
+    double bruteForce(const double p[3], const double q[3], double range) const;
+
+    // platform pose in world frame
+    void compute(const vpHomogeneousMatrix &M, Result &result) const;
+    // whole trajectory, split between threads
+    void compute(const std::vector<vpHomogeneousMatrix> &poses, std::vector<Result> &results, unsigned int threads = 1) const;
+
+protected:
+    // nodes deeper than this are leaves whatever their size, bounds the traversal stack
+    // the median split gives about log2(triangles) levels, far below
+    static const unsigned int MAX_DEPTH = 64;
+
+    struct Node
+    {
+        double lo[3], hi[3];
+        unsigned int first, count;  // triangles of a leaf, or right child if count is 0 (left child follows the node)
+    };
+
+    unsigned int buildNode(unsigned int first, unsigned int count, unsigned int leaf_size,
+                           std::vector<double> &centroid, unsigned int level);
+
+    unsigned int n;
+    double radius, range;
+    std::vector<double> frame, platform;    // attach points, 3 per cable
+    std::vector<double> tri;                // 9 per triangle, in leaf order once built
+    std::vector<unsigned int> index;        // loading order of each triangle
+    std::vector<Node> nodes;
+};
+
+#endif // CDPR_OBSTACLES_H
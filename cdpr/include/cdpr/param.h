@@ -0,0 +1,21 @@
+#ifndef CDPR_PARAM_H
+#define CDPR_PARAM_H
+
+#include <ros/ros.h>
+
+// reading numbers from XmlRpc lists and structs of the parameter server
+// YAML numbers without a decimal point are integers, XmlRpc throws if they are read as double
+
+namespace cdpr_param
+{
+
+inline double toDouble(XmlRpc::XmlRpcValue &value)
+{
+    if(value.getType() == XmlRpc::XmlRpcValue::TypeInt)
+        return int(value);
+    return value;
+}
+
+}
+
+#endif // CDPR_PARAM_H
@@ -0,0 +1,74 @@
+#ifndef CDPR_WORKSPACE_MAP_H
+#define CDPR_WORKSPACE_MAP_H
+
+#include <cdpr/grid_map.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+// wrench-feasible workspace computed offline by workspace_determination, memory-mapped at startup
+// fields per cell: feasible (1 or 0) and optionally the tension margin [N] of the required wrench set
+// all queries are constant time and do not allocate, they can be used from any thread
+
+class WorkspaceMap
+{
+public:
+    explicit WorkspaceMap(const std::string &file) : grid(file)
+    {
+        feasible_ = grid.field("feasible");
+        margin_ = grid.field("margin");
+        valid = grid.ok() && feasible_ >= 0;
+    }
+
+    inline bool ok() const {return valid;}
+    inline bool hasMargin() const {return margin_ >= 0;}
+
+    // feasibility of the nearest cell, false outside the map
+    inline bool inside(double x, double y, double z) const
+    {
+        if(!valid)
+            return false;
+        const double pos[3] = {x, y, z};
+        unsigned int idx[3];
+        for(unsigned int a = 0; a < 3; ++a)
+        {
+            const double u = std::round((pos[a] - grid.origin(a)) / grid.step(a));
+            if(u < 0 || u > grid.size(a) - 1)
+                return false;
+            idx[a] = u;
+        }
+        return grid.cell(idx[0], idx[1], idx[2])[feasible_] > 0.5;
+    }
+
+    // trilinear interpolation of the margin, clamped to the map
+    // returns false if the position is outside the map or the map has no margin
+    inline bool margin(double x, double y, double z, double &m) const
+    {
+        m = 0;
+        if(!valid || margin_ < 0)
+            return false;
+        return grid.interpolate(x, y, z, margin_, m);
+    }
+
+    // index of the first of n setpoints outside the workspace, n if all are inside
+    // position(k, p) writes the position of setpoint k in p[3]
+    template <class Position>
+    inline unsigned int firstOutside(unsigned int n, const Position &position) const
+    {
+        double p[3];
+        for(unsigned int k = 0; k < n; ++k)
+        {
+            position(k, p);
+            if(!inside(p[0], p[1], p[2]))
+                return k;
+        }
+        return n;
+    }
+
+protected:
+    GridMap grid;
+    int feasible_, margin_;
+    bool valid;
+};
+
+#endif // CDPR_WORKSPACE_MAP_H
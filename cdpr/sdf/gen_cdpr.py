@@ -89,6 +89,15 @@ if __name__ == '__main__':
                     CreateVisualCollision(base_link,'%s/geometry/cylinder/radius' % ident, config.frame.radius, color=config.frame.color, pose='%f %f %f %f %f %f' % tuple(pose), collision=True)
                     CreateNested(base_link, 'visual%s/geometry/cylinder/length' % ident, str(np.linalg.norm(dp)))
         
+    # static obstacles, same meshes as the cable checks (cdpr/obstacles.h)
+    if 'obstacles' in d_config:
+        for i,obs in enumerate(d_config['obstacles']):
+            pose = obs.get('xyz', [0,0,0]) + obs.get('rpy', [0,0,0])
+            ident = 'obstacle%i' % i
+            CreateVisualCollision(base_link,'%s/geometry/mesh/uri' % ident, obs['mesh'], color=obs.get('color', 'Orange'), pose='%f %f %f %f %f %f' % tuple(pose), collision=True)
+            for tag in ['visual', 'collision']:
+                CreateNested(base_link, '%s%s/geometry/mesh/scale' % (tag, ident), ' '.join([str(obs.get('scale', 1))]*3))
+
     # create platform
     model.insert(2, etree.Comment('Definition of the robot platform'))
     link = etree.SubElement(model, 'link', name= 'platform')
@@ -0,0 +1,113 @@
+#include <cdpr/dynamics.h>
+#include <visp/vpHomogeneousMatrix.h>
+#include <visp/vpColVector.h>
+#include <chrono>
+#include <iostream>
+#include <cstdlib>
+
+// compares the computed-torque wrench w = M.a + C.v - g
+// as assembled in CTC with vpMatrix and with PlatformDynamics
+// usage: bench_dynamics [iterations]
+
+using namespace std;
+
+namespace
+{
+double rnd(double a = 1) {return a*(2.*rand()/RAND_MAX - 1);}
+}
+
+int main(int argc, char ** argv)
+{
+    const unsigned int N = argc > 1 ? atoi(argv[1]) : 100000;
+    const unsigned int samples = 100;
+
+    // Caroca platform
+    const double mass = 150;
+    vpMatrix inertia(3,3);
+    inertia[0][0] = 6.5; inertia[1][1] = 20; inertia[2][2] = 22.5;
+    PlatformDynamics::Matrix3d I_e;
+    for(unsigned int i=0;i<3;++i)
+        for(unsigned int j=0;j<3;++j)
+            I_e(i,j) = inertia[i][j];
+
+    // random states
+    vector<vpRotationMatrix> R(samples);
+    vector<vpColVector> v(samples, vpColVector(6)), a(samples, vpColVector(6));
+    for(unsigned int k=0;k<samples;++k)
+    {
+        R[k].buildFrom(vpThetaUVector(rnd(M_PI), rnd(M_PI), rnd(M_PI)));
+        for(unsigned int i=0;i<6;++i)
+        {
+            v[k][i] = rnd();
+            a[k][i] = rnd();
+        }
+    }
+
+    // ViSP, as in CTC
+    vpMatrix M_inertia(6,6), omega(3,3), c(3,3), Co(6,6);
+    vpColVector g(6), w(6);
+    g[2] = - mass * 9.81;
+    M_inertia[0][0]=M_inertia[1][1]=M_inertia[2][2]=mass;
+    double check_visp = 0;
+    auto start = chrono::steady_clock::now();
+    for(unsigned int n=0;n<N;++n)
+    {
+        const unsigned int k = n % samples;
+        M_inertia.insert((R[k]*inertia*R[k].t()),3,3);
+        omega[1][0]= v[k][5];omega[0][1]=-v[k][5];
+        omega[2][0]=-v[k][4];omega[0][2]=v[k][4];
+        omega[2][1]= v[k][3];omega[1][2]=-v[k][3];
+        c = omega*(R[k]*inertia*R[k].t());
+        Co.insert( c ,3,3);
+        w = M_inertia*a[k] + Co*v[k] - g;
+        check_visp += w[5];
+    }
+    const double t_visp = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // fixed-size
+    PlatformDynamics dynamics(mass, I_e);
+    PlatformDynamics::Matrix3d R_e;
+    PlatformDynamics::Vector6d w_e;
+    typedef Eigen::Map<const PlatformDynamics::Vector6d> Map6d;
+    double check_eigen = 0;
+    start = chrono::steady_clock::now();
+    for(unsigned int n=0;n<N;++n)
+    {
+        const unsigned int k = n % samples;
+        for(unsigned int i=0;i<3;++i)
+            for(unsigned int j=0;j<3;++j)
+                R_e(i,j) = R[k][i][j];
+        dynamics.update(R_e, Map6d(v[k].data));
+        w_e = dynamics.wrench(Map6d(a[k].data));
+        check_eigen += w_e(5);
+    }
+    const double t_eigen = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // same results
+    double err = 0;
+    for(unsigned int k=0;k<samples;++k)
+    {
+        M_inertia.insert((R[k]*inertia*R[k].t()),3,3);
+        omega[1][0]= v[k][5];omega[0][1]=-v[k][5];
+        omega[2][0]=-v[k][4];omega[0][2]=v[k][4];
+        omega[2][1]= v[k][3];omega[1][2]=-v[k][3];
+        c = omega*(R[k]*inertia*R[k].t());
+        Co.insert( c ,3,3);
+        w = M_inertia*a[k] + Co*v[k] - g;
+
+        for(unsigned int i=0;i<3;++i)
+            for(unsigned int j=0;j<3;++j)
+                R_e(i,j) = R[k][i][j];
+        dynamics.update(R_e, Map6d(v[k].data));
+        w_e = dynamics.wrench(Map6d(a[k].data));
+        for(unsigned int i=0;i<6;++i)
+            err = max(err, fabs(w[i] - w_e(i)));
+    }
+
+    cout << N << " iterations" << endl;
+    cout << "  vpMatrix:         " << 1e9*t_visp/N << " ns / tick" << endl;
+    cout << "  PlatformDynamics: " << 1e9*t_eigen/N << " ns / tick" << endl;
+    cout << "  speedup: " << t_visp/t_eigen << ", max wrench difference: " << err
+         << " (" << check_visp - check_eigen << ")" << endl;
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <cdpr/interference.h>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+
+// cable-cable and cable-platform clearances on random Caroca poses
+// checks the segment distances against a sampled reference and prints the time per pose
+// usage: bench_interference [poses] [range]
+
+using namespace std;
+
+namespace
+{
+// distance between two segments by sampling the first one
+double sampledDistance(const double *a0, const double *a1, const double *b0, const double *b1, unsigned int samples = 2000)
+{
+    double best = 1e9;
+    for(unsigned int i = 0; i <= samples; ++i)
+    {
+        const double s = double(i)/samples;
+        double d[3], r[3], dd = 0, rd = 0;
+        for(unsigned int k = 0; k < 3; ++k)
+        {
+            d[k] = b1[k] - b0[k];
+            r[k] = a0[k] + s*(a1[k] - a0[k]) - b0[k];
+            dd += d[k]*d[k];
+            rd += r[k]*d[k];
+        }
+        const double t = min(max(rd/dd, 0.), 1.);
+        double e = 0;
+        for(unsigned int k = 0; k < 3; ++k)
+            e += (r[k] - t*d[k])*(r[k] - t*d[k]);
+        best = min(best, sqrt(e));
+    }
+    return best;
+}
+}
+
+int main(int argc, char ** argv)
+{
+    const unsigned int N = argc > 1 ? atoi(argv[1]) : 100000;
+    const double range = argc > 2 ? atof(argv[2]) : 0.1;
+    const unsigned int samples = 1000;
+
+    // Caroca
+    const double frame[8][3] = {{-3.5,-3.5,3.5},{-3.5,-3.5,3.5},{3.5,-3.5,3.5},{3.5,-3.5,3.5},
+                                {-3.5,3.5,3.5},{-3.5,3.5,3.5},{3.5,3.5,3.5},{3.5,3.5,3.5}};
+    const double platform[8][3] = {{0.3,-0.3,-0.3},{-0.3,0.3,0.3},{-0.3,-0.3,0.3},{0.3,0.3,-0.3},
+                                   {-0.3,-0.3,-0.3},{0.3,0.3,0.3},{0.3,-0.3,0.3},{-0.3,0.3,-0.3}};
+    const double size[3] = {0.6, 0.6, 0.6}, radius = 0.005;
+    vector<vpTranslationVector> Pf, Pp;
+    for(unsigned int i = 0; i < 8; ++i)
+    {
+        Pf.push_back(vpTranslationVector(frame[i][0], frame[i][1], frame[i][2]));
+        Pp.push_back(vpTranslationVector(platform[i][0], platform[i][1], platform[i][2]));
+    }
+
+    // random poses in the frame, tilted up to 0.5 rad
+    mt19937 gen(1);
+    uniform_real_distribution<double> rnd(-1, 1);
+    vector<vpHomogeneousMatrix> M(samples);
+    for(auto &Mk: M)
+        Mk = vpHomogeneousMatrix(2.5*rnd(gen), 2.5*rnd(gen), 1.7 + 1.2*rnd(gen), 0.5*rnd(gen), 0.5*rnd(gen), M_PI*rnd(gen));
+
+    Interference interference(Pf, Pp, size, radius, range);
+    Interference::Result result;
+    double check = 0;
+    unsigned int candidates = 0, collisions = 0;
+    const auto start = chrono::steady_clock::now();
+    for(unsigned int n = 0; n < N; ++n)
+    {
+        interference.compute(M[n % samples], result);
+        check += result.cable + result.platform;
+        candidates += result.candidates;
+        collisions += !result.ok();
+    }
+    const double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // clearances of the pairs kept by the broadphase against sampled distances
+    double err = 0;
+    for(unsigned int k = 0; k < 100; ++k)
+    {
+        interference.compute(M[k], result);
+        double q[8][3];
+        for(unsigned int i = 0; i < 8; ++i)
+            for(unsigned int a = 0; a < 3; ++a)
+                q[i][a] = M[k][a][0]*platform[i][0] + M[k][a][1]*platform[i][1] + M[k][a][2]*platform[i][2] + M[k][a][3];
+        for(unsigned int i = 0; i < 8; ++i)
+            for(unsigned int j = i+1; j < 8; ++j)
+            {
+                const double c = interference.clearance(i, j);
+                if(c < range)
+                    err = max(err, fabs(c + 2*radius - sampledDistance(frame[i], q[i], frame[j], q[j])));
+            }
+    }
+
+    cout << N << " poses, " << interference.n_cables() << " cables, range " << range << " m" << endl;
+    cout << "  " << 1e6*elapsed/N << " us / pose, " << double(candidates)/N << " pairs after the broadphase" << endl;
+    cout << "  " << 100.*collisions/N << " % of the poses with interference" << endl;
+    cout << "  max difference to sampled distances: " << err << " m (" << check << ")" << endl;
+    return 0;
+}
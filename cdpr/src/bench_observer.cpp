@@ -0,0 +1,145 @@
+#include <cdpr/observer.h>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+
+// runs the state observer on a simulated Caroca trajectory
+// cable lengths and rates at the control rate, noisy pose at a lower rate
+// prints the time per tick and the estimation errors
+// usage: bench_observer [ticks] [control rate] [pose rate]
+
+using namespace std;
+typedef StateObserver::Vector3d Vector3d;
+typedef StateObserver::Matrix3d Matrix3d;
+typedef StateObserver::Vector6d Vector6d;
+typedef StateObserver::Quaterniond Quaterniond;
+
+namespace
+{
+// reference motion around the home pose, with analytic derivatives
+struct Motion
+{
+    Vector3d p, v, a, w, alpha;
+    Matrix3d R;
+    void at(double t)
+    {
+        const Vector3d amp(0.5, 0.3, 0.2), freq(0.7, 1.1, 0.5);
+        for(int k = 0; k < 3; ++k)
+        {
+            const double s = sin(freq(k)*t), c = cos(freq(k)*t);
+            p(k) = amp(k)*s;
+            v(k) = amp(k)*freq(k)*c;
+            a(k) = -amp(k)*freq(k)*freq(k)*s;
+        }
+        p(2) += 0.6;
+        // rotation about a fixed axis, so that ω = dθ/dt exactly
+        const Vector3d axis = Vector3d(1, 2, 3).normalized();
+        const double angle = 0.2*sin(0.8*t), dangle = 0.16*cos(0.8*t), ddangle = -0.128*sin(0.8*t);
+        w = dangle*axis;
+        alpha = ddangle*axis;
+        R = Eigen::AngleAxisd(angle, axis).toRotationMatrix();
+    }
+};
+}
+
+int main(int argc, char ** argv)
+{
+    const unsigned int N = argc > 1 ? atoi(argv[1]) : 20000;
+    const double rate = argc > 2 ? atof(argv[2]) : 1000;
+    const double pose_rate = argc > 3 ? atof(argv[3]) : 100;
+    const double dt = 1./rate;
+    const unsigned int pose_every = max(1, int(rate/pose_rate));
+
+    // Caroca attach points
+    const double frame[8][3] = {{-3.5,-3.5,3.5},{-3.5,-3.5,3.5},{3.5,-3.5,3.5},{3.5,-3.5,3.5},
+                                {-3.5,3.5,3.5},{-3.5,3.5,3.5},{3.5,3.5,3.5},{3.5,3.5,3.5}};
+    const double platform[8][3] = {{0.3,-0.3,-0.3},{-0.3,0.3,0.3},{-0.3,-0.3,0.3},{0.3,0.3,-0.3},
+                                   {-0.3,-0.3,-0.3},{0.3,0.3,0.3},{0.3,-0.3,0.3},{-0.3,0.3,-0.3}};
+    vector<Vector3d> Pf, Pp;
+    for(unsigned int i = 0; i < 8; ++i)
+    {
+        Pf.push_back(Vector3d(frame[i][0], frame[i][1], frame[i][2]));
+        Pp.push_back(Vector3d(platform[i][0], platform[i][1], platform[i][2]));
+    }
+
+    StateObserver::Noise noise;
+    StateObserver observer(Pf, Pp, noise);
+    Motion truth;
+    truth.at(0);
+    observer.reset(truth.p, Quaterniond(truth.R));
+
+    mt19937 gen(42);
+    normal_distribution<double> n01;
+    double L[8], dL[8];
+    vector<double> ticks(N);
+
+    // errors after a settling time
+    const unsigned int settle = min(N/5, (unsigned int)(rate));
+    double e_p = 0, e_r = 0, e_v = 0, e_w = 0, e_a = 0, e_pm = 0;
+    unsigned int count = 0;
+
+    for(unsigned int n = 1; n <= N; ++n)
+    {
+        const double t = n*dt;
+        truth.at(t);
+
+        // encoders
+        for(unsigned int i = 0; i < 8; ++i)
+        {
+            const Vector3d Rb = truth.R*Pp[i];
+            Vector3d u = Pf[i] - truth.p - Rb;
+            L[i] = u.norm();
+            u /= L[i];
+            dL[i] = -u.dot(truth.v + truth.w.cross(Rb)) + noise.length_rate*n01(gen);
+            L[i] += noise.length*n01(gen);
+        }
+        // pose
+        const bool with_pose = n % pose_every == 0;
+        Vector3d pm = truth.p;
+        Quaterniond qm(truth.R);
+        if(with_pose)
+        {
+            pm += noise.position*Vector3d(n01(gen), n01(gen), n01(gen));
+            const Vector3d dth = noise.orientation*Vector3d(n01(gen), n01(gen), n01(gen));
+            qm = Quaterniond(Eigen::AngleAxisd(dth.norm(), dth.normalized()))*qm;
+            if(n > settle)
+                e_pm += (pm - truth.p).squaredNorm();
+        }
+
+        const auto start = chrono::steady_clock::now();
+        observer.predict(dt);
+        observer.updateCables(L, dL);
+        if(with_pose)
+            observer.updatePose(pm, qm);
+        ticks[n-1] = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        if(n > settle)
+        {
+            const Vector6d tw = observer.twist(), acc = observer.acceleration();
+            e_p += (observer.position() - truth.p).squaredNorm();
+            const double angle = Eigen::AngleAxisd(observer.rotation()*truth.R.transpose()).angle();
+            e_r += angle*angle;
+            e_v += (tw.head<3>() - truth.v).squaredNorm();
+            e_w += (tw.tail<3>() - truth.w).squaredNorm();
+            e_a += (acc.head<3>() - truth.a).squaredNorm();
+            count++;
+        }
+    }
+
+    sort(ticks.begin(), ticks.end());
+    double mean = 0;
+    for(auto t: ticks)
+        mean += t;
+    mean /= N;
+
+    cout << N << " ticks at " << rate << " Hz, pose at " << rate/pose_every << " Hz, 8 cables" << endl;
+    cout << "  predict + update: mean " << 1e6*mean << " us, p99 " << 1e6*ticks[N*99/100]
+         << " us, max " << 1e6*ticks.back() << " us" << endl;
+    cout << "  RMS errors: position " << sqrt(e_p/count) << " m (pose measurement "
+         << sqrt(e_pm/max(1u, count/pose_every)) << " m), orientation " << sqrt(e_r/count) << " rad" << endl;
+    cout << "              velocity " << sqrt(e_v/count) << " m/s, angular velocity " << sqrt(e_w/count)
+         << " rad/s, acceleration " << sqrt(e_a/count) << " m/s2" << endl;
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include <cdpr/obstacles.h>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+#include <thread>
+#include <array>
+
+// cable-obstacle clearances on random poses, against tens of thousands of triangles
+// the scene is made of spheres (subdivided icosahedra) in the Caroca frame, or of the given STL files
+// compares with the brute-force distance and prints the time per tick for 8 and 16 cables
+// usage: bench_obstacles [spheres] [subdivisions] [file.stl ...]
+
+using namespace std;
+
+namespace
+{
+// sphere of radius r centered on c, 20.4^levels triangles
+void addSphere(Obstacles &obstacles, const double c[3], double r, unsigned int levels)
+{
+    const double t = 0.5*(1 + sqrt(5.));
+    vector<array<double, 3>> v = {{-1,t,0},{1,t,0},{-1,-t,0},{1,-t,0},{0,-1,t},{0,1,t},{0,-1,-t},{0,1,-t},{t,0,-1},{t,0,1},{-t,0,-1},{-t,0,1}};
+    vector<array<unsigned int, 3>> f = {{0,11,5},{0,5,1},{0,1,7},{0,7,10},{0,10,11},{1,5,9},{5,11,4},{11,10,2},{10,7,6},{7,1,8},
+                                        {3,9,4},{3,4,2},{3,2,6},{3,6,8},{3,8,9},{4,9,5},{2,4,11},{6,2,10},{8,6,7},{9,8,1}};
+    auto middle = [&](unsigned int a, unsigned int b)
+    {
+        v.push_back({0.5*(v[a][0]+v[b][0]), 0.5*(v[a][1]+v[b][1]), 0.5*(v[a][2]+v[b][2])});
+        return (unsigned int) v.size()-1;
+    };
+    for(unsigned int l = 0; l < levels; ++l)
+    {
+        vector<array<unsigned int, 3>> split;
+        for(const auto &tri: f)
+        {
+            const unsigned int a = middle(tri[0], tri[1]), b = middle(tri[1], tri[2]), c = middle(tri[2], tri[0]);
+            split.push_back({tri[0], a, c});
+            split.push_back({tri[1], b, a});
+            split.push_back({tri[2], c, b});
+            split.push_back({a, b, c});
+        }
+        f.swap(split);
+    }
+    for(auto &p: v)
+    {
+        const double norm = sqrt(p[0]*p[0] + p[1]*p[1] + p[2]*p[2]);
+        for(unsigned int k = 0; k < 3; ++k)
+            p[k] = c[k] + r*p[k]/norm;
+    }
+    for(const auto &tri: f)
+        obstacles.add(v[tri[0]].data(), v[tri[1]].data(), v[tri[2]].data());
+}
+}
+
+int main(int argc, char ** argv)
+{
+    const unsigned int spheres = argc > 1 ? atoi(argv[1]) : 8;
+    const unsigned int levels = argc > 2 ? atoi(argv[2]) : 4;
+    const unsigned int samples = 1000, reference = 50;
+    const double radius = 0.005, range = 0.1;
+
+    // Caroca, then 8 more cables from the middle of the upper edges to the middle of the platform edges
+    const double frame[16][3] = {{-3.5,-3.5,3.5},{-3.5,-3.5,3.5},{3.5,-3.5,3.5},{3.5,-3.5,3.5},
+                                 {-3.5,3.5,3.5},{-3.5,3.5,3.5},{3.5,3.5,3.5},{3.5,3.5,3.5},
+                                 {0,-3.5,3.5},{0,-3.5,3.5},{3.5,0,3.5},{3.5,0,3.5},
+                                 {0,3.5,3.5},{0,3.5,3.5},{-3.5,0,3.5},{-3.5,0,3.5}};
+    const double platform[16][3] = {{0.3,-0.3,-0.3},{-0.3,0.3,0.3},{-0.3,-0.3,0.3},{0.3,0.3,-0.3},
+                                    {-0.3,-0.3,-0.3},{0.3,0.3,0.3},{0.3,-0.3,0.3},{-0.3,0.3,-0.3},
+                                    {0,-0.3,0.3},{0,-0.3,-0.3},{0.3,0,0.3},{0.3,0,-0.3},
+                                    {0,0.3,0.3},{0,0.3,-0.3},{-0.3,0,0.3},{-0.3,0,-0.3}};
+
+    mt19937 gen(1);
+    uniform_real_distribution<double> rnd(-1, 1);
+    vector<vpHomogeneousMatrix> M(samples);
+    for(auto &Mk: M)
+        Mk = vpHomogeneousMatrix(2.5*rnd(gen), 2.5*rnd(gen), 1.7 + 1.2*rnd(gen), 0.5*rnd(gen), 0.5*rnd(gen), M_PI*rnd(gen));
+    vector<array<double, 3>> centers;
+    for(unsigned int s = 0; s < spheres; ++s)
+        centers.push_back({3*rnd(gen), 3*rnd(gen), 1.7 + 1.5*rnd(gen)});
+
+    for(unsigned int n: {8u, 16u})
+    {
+        vector<vpTranslationVector> Pf, Pp;
+        for(unsigned int i = 0; i < n; ++i)
+        {
+            Pf.push_back(vpTranslationVector(frame[i][0], frame[i][1], frame[i][2]));
+            Pp.push_back(vpTranslationVector(platform[i][0], platform[i][1], platform[i][2]));
+        }
+        Obstacles obstacles(Pf, Pp, radius, range);
+        if(argc > 3)
+        {
+            for(int a = 3; a < argc; ++a)
+                if(!obstacles.load(argv[a]))
+                    cout << "cannot read " << argv[a] << endl;
+        }
+        else
+            for(const auto &c: centers)
+                addSphere(obstacles, c.data(), 0.3, levels);
+        auto start = chrono::steady_clock::now();
+        obstacles.build();
+        const double build = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        Obstacles::Result result;
+        unsigned int contacts = 0;
+        size_t tests = 0;
+        double check = 0;
+        start = chrono::steady_clock::now();
+        for(const auto &Mk: M)
+        {
+            obstacles.compute(Mk, result);
+            contacts += !result.ok();
+            tests += result.tests;
+            check += result.clearance;
+        }
+        const double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        // whole trajectory on all cores
+        vector<Obstacles::Result> results;
+        const unsigned int threads = max(1u, thread::hardware_concurrency());
+        start = chrono::steady_clock::now();
+        obstacles.compute(M, results, threads);
+        const double batch = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        // brute force on a few poses
+        double err = 0;
+        start = chrono::steady_clock::now();
+        for(unsigned int k = 0; k < reference; ++k)
+        {
+            obstacles.compute(M[k], result);
+            for(unsigned int i = 0; i < n; ++i)
+            {
+                double q[3];
+                for(unsigned int a = 0; a < 3; ++a)
+                    q[a] = M[k][a][0]*platform[i][0] + M[k][a][1]*platform[i][1] + M[k][a][2]*platform[i][2] + M[k][a][3];
+                const double d = obstacles.bruteForce(frame[i], q, range + radius) - radius;
+                err = max(err, fabs(min(d, range) - result.cables[i]));
+            }
+        }
+        const double brute = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        cout << n << " cables, " << obstacles.triangles() << " triangles, hierarchy built in " << 1e3*build << " ms" << endl;
+        cout << "  " << 1e6*elapsed/samples << " us / tick, " << 1e6*elapsed/(samples*n) << " us / cable, "
+             << double(tests)/(samples*n) << " boxes and triangles tested per cable" << endl;
+        cout << "  batch of " << samples << " poses on " << threads << " threads: " << 1e3*batch << " ms" << endl;
+        cout << "  brute force: " << 1e6*brute/reference << " us / tick, max difference " << err << " m" << endl;
+        cout << "  " << 100.*contacts/samples << " % of the poses with a cable closer than " << 1e3*radius
+             << " mm to an obstacle (" << check << ")" << endl;
+    }
+    return 0;
+}
@@ -1,15 +1,41 @@
  #include <cdpr/cdpr.h>
 #include <cmath>
+#include <cstdio>
 
 using std::endl;
 using std::cout;
 
+namespace
+{
+// quintic Hermite between (p0, v0, a0) and (p1, v1, a1) over h, at tau in [0, 1]
+// exact for the quintic segments of the generators
+inline void hermite5(double p0, double v0, double a0, double p1, double v1, double a1, double h, double tau,
+                     double &p, double &v, double &a)
+{
+    const double dp = p1 - p0;
+    const double c1 = v0*h, c2 = .5*a0*h*h;
+    const double c3 = 10*dp - (6*v0 + 4*v1)*h - (1.5*a0 - .5*a1)*h*h;
+    const double c4 = -15*dp + (8*v0 + 7*v1)*h + (1.5*a0 - a1)*h*h;
+    const double c5 = 6*dp - 3*(v0 + v1)*h - .5*(a0 - a1)*h*h;
+    p = p0 + tau*(c1 + tau*(c2 + tau*(c3 + tau*(c4 + tau*c5))));
+    v = (c1 + tau*(2*c2 + tau*(3*c3 + tau*(4*c4 + tau*5*c5))))/h;
+    a = (2*c2 + tau*(6*c3 + tau*(12*c4 + tau*20*c5)))/(h*h);
+}
+
+inline void toArray(const geometry_msgs::Twist &twist, double v[6])
+{
+    v[0] = twist.linear.x; v[1] = twist.linear.y; v[2] = twist.linear.z;
+    v[3] = twist.angular.x; v[4] = twist.angular.y; v[5] = twist.angular.z;
+}
+}
+
 CDPR::CDPR(ros::NodeHandle &_nh)
 {
 
     // init listener to platform state
     platform_sub = _nh.subscribe("pf_state", 1, &CDPR::PFState_cb, this);
     platform_ok = false;
+    pose_new = cables_new = false;
 
     // init listener to pose setpoint
     setpoint_sub = _nh.subscribe("pf_setpoint", 1, &CDPR::Setpoint_cb, this);
@@ -19,6 +45,9 @@ CDPR::CDPR(ros::NodeHandle &_nh)
 
     desiredAcc_sub = _nh.subscribe("desired_acc", 1, &CDPR::DesiredAcc_cb, this);
 
+    // trajectory preview, used instead of the three topics above when published
+    preview_sub = _nh.subscribe("trajectory_preview", 1, &CDPR::Preview_cb, this);
+
     // init listener to cable states
     cables_sub = _nh.subscribe("cable_states", 1, &CDPR::Cables_cb, this);
     cables_ok = false;
@@ -40,6 +69,9 @@ CDPR::CDPR(ros::NodeHandle &_nh)
     // cable min / max
     model.getParam("joints/actuated/effort", f_max);
     model.getParam("joints/actuated/min", f_min);
+    // axial stiffness EA, 0 if not given
+    stiffness_ = 0;
+    model.getParam("cable/stiffness", stiffness_);
 
     // cable attach points    
     model.getParam("points", element);
@@ -65,6 +97,10 @@ CDPR::CDPR(ros::NodeHandle &_nh)
     Md_.insert(vpRotationMatrix(r));
     Md_.insert(vpTranslationVector(xyz[0], xyz[1], xyz[2]));
 
+    // the cable joints are at 0 at the home pose
+    L0.resize(n_cable);
+    computeDesiredLength(L0);
+
 
     // publisher to cable tensions
     tensions_pub = _nh.advertise<sensor_msgs::JointState>("cable_command", 1);
@@ -77,64 +113,72 @@ CDPR::CDPR(ros::NodeHandle &_nh)
          //length_e.name.push_back(std::string(cable_name));
     }
     tensions_msg.effort.resize(n_cable);
+
+    // publisher to cable setpoints, when the inner loop runs in the plugin
+    setpoint_pub = _nh.advertise<sensor_msgs::JointState>("cable_setpoint", 1);
+    setpoint_msg.name = tensions_msg.name;
+    setpoint_msg.position.resize(n_cable);
+    setpoint_msg.velocity.resize(n_cable);
+    setpoint_msg.effort.resize(n_cable);
     //length_e.effort.resize(n_cable);
 }
 
 
 void CDPR::computeW(vpMatrix &W)
 {
-    
-    // build W matrix depending on current attach points
-    vpTranslationVector T;  M_.extract(T);
-    vpRotationMatrix R;     M_.extract(R);
-
-    vpTranslationVector f;
-    vpColVector w;  
-        for(unsigned int i=0;i<n_cable;++i)
-        {
-            // vector between platform point and frame point in platform frame
-            f = R.t() * (Pf[i] - T) - Pp[i];
-            f /= f.euclideanNorm();
-            // corresponding force in platform frame
-            w = Pp[i].skew() * f;
-            for(unsigned int k=0;k<3;++k)
-            {
-                 W[k][i] = f[k];
-                 W[k+3][i] = w[k];
-            }
-        }
+    vpHomogeneousMatrix M;
+    {
+        Lock lock(mtx);
+        M = pose();
+    }
+    computeW(M, W);
 }
 
 void CDPR::computeDesiredW(vpMatrix &Wd)
 {
-    
-    // build W matrix depending on current attach points
-    vpTranslationVector Td;  Md_.extract(Td);
-    vpRotationMatrix Rd;     Md_.extract(Rd);
+    vpHomogeneousMatrix Md;
+    {
+        Lock lock(mtx);
+        Md = Md_;
+    }
+    computeW(Md, Wd);
+}
 
-    vpTranslationVector fd, P_p;
-    vpColVector wd;  
-        for(unsigned int i=0;i<n_cable;++i)
+void CDPR::computeW(const vpHomogeneousMatrix &M, vpMatrix &W)
+{
+    // build W matrix depending on attach points at this pose
+    vpTranslationVector T;
+    vpRotationMatrix R;
+    M.extract(T);
+    M.extract(R);
+
+    vpTranslationVector f;
+    vpColVector w;
+    for(unsigned int i=0;i<n_cable;++i)
+    {
+        // vector between platform point and frame point in platform frame
+        f = R.t() * (Pf[i] - T) - Pp[i];
+        f /= f.euclideanNorm();
+        // corresponding force in platform frame
+        w = Pp[i].skew() * f;
+        for(unsigned int k=0;k<3;++k)
         {
-            // vector between platform point and frame point in platform frame
-            fd= Rd.t() * (Pf[i] - Td) - Pp[i];
-            fd /= fd.euclideanNorm();
-            //fd=Rd*fd;
-            //P_p = Rd*Pp[i];
-            // corresponding force in platform frame
-            wd = Pp[i].skew() * fd;
-            for(unsigned int k=0;k<3;++k)
-            {
-                 Wd[k][i] = fd[k];
-                 Wd[k+3][i] = wd[k];
-            }
+            W[k][i] = f[k];
+            W[k+3][i] = w[k];
         }
+    }
 }
+
 void CDPR::computeLength(vpColVector &L)
 {
        // build W matrix depending on current attach points
-    vpTranslationVector T;  M_.extract(T);
-    vpRotationMatrix R;     M_.extract(R);
+    vpTranslationVector T;
+    vpRotationMatrix R;
+    {
+        Lock lock(mtx);
+        pose().extract(T);
+        pose().extract(R);
+    }
 
     vpTranslationVector f;
     for(unsigned int i=0;i<n_cable;++i)
@@ -150,8 +194,13 @@ void CDPR::computeLength(vpColVector &L)
 void CDPR::computeDesiredLength(vpColVector &Ld)
 {
        // build W matrix depending on current attach points
-    vpTranslationVector Td;  Md_.extract(Td);
-    vpRotationMatrix Rd;     Md_.extract(Rd);
+    vpTranslationVector Td;
+    vpRotationMatrix Rd;
+    {
+        Lock lock(mtx);
+        Md_.extract(Td);
+        Md_.extract(Rd);
+    }
 
     vpTranslationVector fd;
     for(unsigned int i=0;i<n_cable;++i)
@@ -165,6 +214,201 @@ void CDPR::computeDesiredLength(vpColVector &Ld)
 }
 
 
+PlatformDynamics CDPR::dynamicsModel()
+{
+    PlatformDynamics::Matrix3d I;
+    for(unsigned int i=0;i<3;++i)
+        for(unsigned int j=0;j<3;++j)
+            I(i,j) = inertia_[i][j];
+    return PlatformDynamics(mass_, I);
+}
+
+void CDPR::computeDynamics(PlatformDynamics &dyn)
+{
+    PlatformDynamics::Matrix3d R;
+    PlatformDynamics::Vector6d v = PlatformDynamics::Vector6d::Zero();
+    {
+        Lock lock(mtx);
+        const vpColVector &twist = observer ? v_est : v_;
+        for(unsigned int i=0;i<3;++i)
+            for(unsigned int j=0;j<3;++j)
+                R(i,j) = pose()[i][j];
+        if(twist.size() == 6)
+            for(unsigned int i=0;i<6;++i)
+                v(i) = twist[i];
+    }
+    dyn.update(R, v);
+}
+
+
+void CDPR::updateDesired(const ros::Time &t)
+{
+    cdpr::TrajectoryPreviewConstPtr msg;
+    {
+        Lock lock(mtx);
+        msg = preview;
+    }
+    if(!msg || msg->pose.empty() || msg->velocity.size() != msg->pose.size()
+            || msg->acceleration.size() != msg->pose.size() || msg->dt <= 0)
+        return;
+
+    // interval and position in it, the last pose is held at rest after the horizon
+    const unsigned int N = msg->pose.size();
+    const double s = (t - msg->header.stamp).toSec() / msg->dt;
+    unsigned int i = 0;
+    double tau = 0;
+    bool hold = false;
+    if(N > 1 && s > 0)
+    {
+        if(s >= N-1)
+        {
+            i = N-2;
+            tau = 1;
+            hold = s > N-1;
+        }
+        else
+        {
+            i = std::floor(s);
+            tau = s - i;
+        }
+    }
+    const unsigned int j = N > 1 ? i+1 : i;
+
+    double v0[6], v1[6], a0[6], a1[6], v[6], a[6];
+    toArray(msg->velocity[i], v0);
+    toArray(msg->velocity[j], v1);
+    toArray(msg->acceleration[i], a0);
+    toArray(msg->acceleration[j], a1);
+
+    // position
+    const geometry_msgs::Point &p0 = msg->pose[i].position, &p1 = msg->pose[j].position;
+    const double P0[3] = {p0.x, p0.y, p0.z}, P1[3] = {p1.x, p1.y, p1.z};
+    double P[3];
+    for(unsigned int k=0;k<3;++k)
+        hermite5(P0[k], v0[k], a0[k], P1[k], v1[k], a1[k], msg->dt, tau, P[k], v[k], a[k]);
+
+    // orientation: rotation vector from q0 to q1 in world frame, R = exp(theta).R0
+    const geometry_msgs::Quaternion &q0 = msg->pose[i].orientation, &q1 = msg->pose[j].orientation;
+    const Eigen::Quaterniond Q0(q0.w, q0.x, q0.y, q0.z), Q1(q1.w, q1.x, q1.y, q1.z);
+    const Eigen::AngleAxisd dq(Q1.normalized() * Q0.normalized().conjugate());
+    const Eigen::Vector3d delta = dq.angle() * dq.axis();
+    Eigen::Vector3d theta;
+    for(unsigned int k=0;k<3;++k)
+        hermite5(0, v0[k+3], a0[k+3], delta(k), v1[k+3], a1[k+3], msg->dt, tau, theta(k), v[k+3], a[k+3]);
+    const Eigen::Matrix3d R = Eigen::AngleAxisd(theta.norm(), theta.norm() > 1e-12 ? theta.normalized() : Eigen::Vector3d::UnitX())
+            * Q0.normalized().toRotationMatrix();
+
+    Lock lock(mtx);
+    for(unsigned int k=0;k<3;++k)
+    {
+        Md_[k][3] = P[k];
+        for(unsigned int l=0;l<3;++l)
+            Md_[k][l] = R(k,l);
+    }
+    v_d.resize(6);
+    a_d.resize(6);
+    for(unsigned int k=0;k<6;++k)
+    {
+        v_d[k] = hold ? 0 : v[k];
+        a_d[k] = hold ? 0 : a[k];
+    }
+}
+
+void CDPR::enableObserver(const StateObserver::Noise &noise)
+{
+    std::vector<StateObserver::Vector3d> frame(n_cable), platform(n_cable);
+    for(unsigned int i=0;i<n_cable;++i)
+        for(unsigned int k=0;k<3;++k)
+        {
+            frame[i](k) = Pf[i][k];
+            platform[i](k) = Pp[i][k];
+        }
+
+    std::unique_ptr<StateObserver> obs(new StateObserver(frame, platform, noise));
+    Lock lock(mtx);
+    // starts from the last measured pose, or from home
+    const vpHomogeneousMatrix &M = platform_ok ? M_ : Md_;
+    StateObserver::Matrix3d R;
+    for(unsigned int i=0;i<3;++i)
+        for(unsigned int j=0;j<3;++j)
+            R(i,j) = M[i][j];
+    obs->reset(StateObserver::Vector3d(M[0][3], M[1][3], M[2][3]), StateObserver::Quaterniond(R));
+
+    M_est = M;
+    v_est.resize(6);
+    a_est.resize(6);
+    L_meas.resize(n_cable);
+    dL_meas.resize(n_cable);
+    pose_new = cables_new = false;
+    observer = std::move(obs);
+}
+
+void CDPR::updateObserver(double dt)
+{
+    if(!observer)
+        return;
+
+    // copy the new measurements, then run the filter outside the lock
+    bool use_pose, use_cables, use_rates = false;
+    StateObserver::Vector3d p;
+    StateObserver::Matrix3d R;
+    {
+        Lock lock(mtx);
+        use_pose = pose_new;
+        use_cables = cables_new;
+        pose_new = cables_new = false;
+        if(use_pose)
+        {
+            for(unsigned int i=0;i<3;++i)
+            {
+                p(i) = M_[i][3];
+                for(unsigned int j=0;j<3;++j)
+                    R(i,j) = M_[i][j];
+            }
+        }
+        if(use_cables)
+        {
+            // joints are named cable<i>, positions are L0 - L
+            unsigned int found = 0, idx;
+            use_rates = cable_states.velocity.size() == cable_states.position.size();
+            for(unsigned int k=0;k<cable_states.name.size() && k<cable_states.position.size();++k)
+            {
+                if(sscanf(cable_states.name[k].c_str(), "cable%u", &idx) == 1 && idx < n_cable)
+                {
+                    L_meas[idx] = L0[idx] - cable_states.position[k];
+                    if(use_rates)
+                        dL_meas[idx] = -cable_states.velocity[k];
+                    found++;
+                }
+            }
+            use_cables = found == n_cable;
+        }
+    }
+
+    observer->predict(dt);
+    if(use_cables)
+        observer->updateCables(L_meas.data(), use_rates ? dL_meas.data() : nullptr);
+    if(use_pose)
+        observer->updatePose(p, StateObserver::Quaterniond(R));
+
+    const StateObserver::Vector3d &t = observer->position();
+    const StateObserver::Matrix3d Re = observer->rotation();
+    const StateObserver::Vector6d v = observer->twist(), a = observer->acceleration();
+    Lock lock(mtx);
+    for(unsigned int i=0;i<3;++i)
+    {
+        M_est[i][3] = t(i);
+        for(unsigned int j=0;j<3;++j)
+            M_est[i][j] = Re(i,j);
+    }
+    for(unsigned int i=0;i<6;++i)
+    {
+        v_est[i] = v(i);
+        a_est[i] = a(i);
+    }
+}
+
+
 void CDPR::sendTensions(vpColVector &f)
 {
     // write effort to jointstate
@@ -175,3 +419,15 @@ void CDPR::sendTensions(vpColVector &f)
     tensions_pub.publish(tensions_msg);
 }
 
+void CDPR::sendCableSetpoint(const vpColVector &L, const vpColVector &dL, const vpColVector &f)
+{
+    for(unsigned int i=0;i<n_cable;++i)
+    {
+        setpoint_msg.position[i] = L[i];
+        setpoint_msg.velocity[i] = dL[i];
+        setpoint_msg.effort[i] = f[i];
+    }
+    setpoint_msg.header.stamp = ros::Time::now();
+
+    setpoint_pub.publish(setpoint_msg);
+}
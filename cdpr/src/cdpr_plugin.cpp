@@ -67,6 +67,45 @@ void CDPRPlugin::Load(physics::ModelPtr _model, sdf::ElementPtr _sdf)
         joint_states_.position.resize(joints_.size());
         joint_states_.velocity.resize(joints_.size());
         joint_states_.effort.resize(joints_.size());
+
+        // cable-space inner loop
+        rosnode_.param("/model/inner_loop/enabled", inner_loop_, false);
+        rosnode_.param("/model/inner_loop/Kp", inner_Kp_, 20000.);
+        rosnode_.param("/model/inner_loop/Kd", inner_Kd_, 2000.);
+        setpoint_received_ = false;
+        XmlRpc::XmlRpcValue p;
+        std::vector<double> xyz, rpy;
+        if(inner_loop_ && (!rosnode_.getParam("/model/points", p)
+                           || !rosnode_.getParam("/model/platform/position/xyz", xyz) || xyz.size() != 3
+                           || !rosnode_.getParam("/model/platform/position/rpy", rpy) || rpy.size() != 3))
+        {
+            ROS_ERROR("CDPR Plugin: inner loop needs /model/points and /model/platform/position/xyz and rpy, tension control only");
+            inner_loop_ = false;
+        }
+        if(inner_loop_)
+        {
+            // lengths at home pose, where the cables were generated
+            const ignition::math::Pose3d home(xyz[0], xyz[1], xyz[2], rpy[0], rpy[1], rpy[2]);
+            L0_.resize(joints_.size());
+            for(unsigned int i = 0; i < joints_.size(); ++i)
+            {
+                // joint cable<i> corresponds to point i
+                const int idx = atoi(joint_names[i].substr(5).c_str());
+                const ignition::math::Vector3d frame(p[idx]["frame"][0], p[idx]["frame"][1], p[idx]["frame"][2]);
+                const ignition::math::Vector3d platform(p[idx]["platform"][0], p[idx]["platform"][1], p[idx]["platform"][2]);
+                L0_[i] = (frame - home.Pos() - home.Rot().RotateVector(platform)).Length();
+            }
+            setpoint_L_ = L0_;
+            setpoint_dL_.resize(joints_.size(), 0);
+            setpoint_ff_.resize(joints_.size(), 0);
+
+            ros::SubscribeOptions ops = ros::SubscribeOptions::create<sensor_msgs::JointState>(
+                        "cable_setpoint", 1,
+                        boost::bind(&CDPRPlugin::CableSetpointCallBack, this, _1),
+                        ros::VoidPtr(), &callback_queue_);
+            setpoint_subscriber_ = rosnode_.subscribe(ops);
+            ROS_INFO("CDPR Plugin: cable inner loop with Kp = %f, Kd = %f", inner_Kp_, inner_Kd_);
+        }
     }
     else
     {
@@ -132,7 +171,23 @@ void CDPRPlugin::Update()
     callback_queue_.callAvailable();
 
     // deal with joint control
-    if(command_received_)
+    if(setpoint_received_)
+    {
+        // cable-space PD at the physics rate
+        for(unsigned int i=0;i<joints_.size();++i)
+        {
+#if GAZEBO_MAJOR_VERSION < 9
+            const double q = joints_[i]->GetAngle(0).Radian();
+#else
+            const double q = joints_[i]->Position();
+#endif
+            const double L = L0_[i] - q;
+            const double dL = -joints_[i]->GetVelocity(0);
+            const double tension = setpoint_ff_[i] + inner_Kp_*(L - setpoint_L_[i]) + inner_Kd_*(dL - setpoint_dL_[i]);
+            joints_[i]->SetForce(0, std::min(std::max(tension, 0.), f_max));
+        }
+    }
+    else if(command_received_)
     {
         if(sim_cables_)
         {
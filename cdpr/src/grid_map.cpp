@@ -0,0 +1,167 @@
+#include <cdpr/grid_map.h>
+#include <cdpr/log.h>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace grid_map;
+
+bool GridMap::write(const std::string &file, const unsigned int size[3], const double origin[3], const double step[3],
+                    const std::vector<std::string> &names, const std::vector<float> &data)
+{
+    Header h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    h.fields = names.size();
+    for(unsigned int i = 0; i < 3; ++i)
+    {
+        h.size[i] = size[i];
+        h.origin[i] = origin[i];
+        h.step[i] = step[i];
+    }
+    h.data_offset = sizeof(Header) + h.fields*FIELD_NAME;
+
+    if(data.size() != (size_t) size[0]*size[1]*size[2]*h.fields)
+    {
+        CDPR_WARN("GridMap: " << data.size() << " values for " << size[0] << " x " << size[1] << " x " << size[2] << " cells of " << h.fields << " fields");
+        return false;
+    }
+
+    std::ofstream out(file, std::ios::binary | std::ios::trunc);
+    out.write((const char*) &h, sizeof(h));
+    for(const auto &name: names)
+    {
+        char field[FIELD_NAME] = {};
+        strncpy(field, name.c_str(), FIELD_NAME-1);
+        out.write(field, FIELD_NAME);
+    }
+    out.write((const char*) data.data(), data.size()*sizeof(float));
+    if(!out)
+    {
+        CDPR_WARN("GridMap: cannot write " << file);
+        return false;
+    }
+    return true;
+}
+
+GridMap::GridMap(const std::string &file)
+    : data(nullptr), bytes(0), cells(nullptr)
+{
+    memset(&header, 0, sizeof(header));
+    const int fd = ::open(file.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        CDPR_WARN("GridMap: cannot open " << file << " (" << strerror(errno) << ")");
+        return;
+    }
+    struct stat st;
+    if(fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(Header))
+    {
+        bytes = st.st_size;
+        void *p = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+        if(p != MAP_FAILED)
+            data = (char*) p;
+    }
+    ::close(fd);
+    if(!data)
+    {
+        CDPR_WARN("GridMap: cannot map " << file);
+        return;
+    }
+
+    memcpy(&header, data, sizeof(header));
+    const size_t n = (size_t) header.size[0]*header.size[1]*header.size[2];
+    const bool valid = memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version == VERSION
+            && n && header.fields
+            && header.step[0] > 0 && header.step[1] > 0 && header.step[2] > 0
+            && header.data_offset == sizeof(Header) + header.fields*FIELD_NAME
+            && header.data_offset + n*header.fields*sizeof(float) <= bytes;
+    if(!valid)
+    {
+        CDPR_WARN("GridMap: " << file << " is not a grid file");
+        munmap(data, bytes);
+        data = nullptr;
+        return;
+    }
+
+    for(unsigned int i = 0; i < header.fields; ++i)
+    {
+        const char *name = data + sizeof(Header) + i*FIELD_NAME;
+        names_.push_back(std::string(name, strnlen(name, FIELD_NAME)));
+    }
+    cells = (const float*)(data + header.data_offset);
+    // lookups touch the whole table, keep it resident
+    madvise(data, bytes, MADV_WILLNEED);
+}
+
+GridMap::~GridMap()
+{
+    if(data)
+        munmap(data, bytes);
+}
+
+int GridMap::field(const std::string &name) const
+{
+    for(unsigned int i = 0; i < names_.size(); ++i)
+        if(names_[i] == name)
+            return i;
+    return -1;
+}
+
+bool GridMap::interpolate(double x, double y, double z, double *out) const
+{
+    return interpolate(x, y, z, 0, header.fields, out);
+}
+
+bool GridMap::interpolate(double x, double y, double z, unsigned int field, double &value) const
+{
+    return interpolate(x, y, z, field, 1, &value);
+}
+
+bool GridMap::interpolate(double x, double y, double z, unsigned int first, unsigned int count, double *out) const
+{
+    const double pos[3] = {x, y, z};
+    unsigned int idx[3];
+    double frac[3];
+    bool inside = true;
+    for(unsigned int a = 0; a < 3; ++a)
+    {
+        double u = (pos[a] - header.origin[a]) / header.step[a];
+        const double last = header.size[a] - 1;
+        if(u < 0 || u > last)
+        {
+            inside = false;
+            u = std::min(std::max(u, 0.), last);
+        }
+        // lower cell, so that the upper one is still in the grid
+        idx[a] = std::min<unsigned int>(std::floor(u), header.size[a] > 1 ? header.size[a]-2 : 0);
+        frac[a] = header.size[a] > 1 ? u - idx[a] : 0;
+    }
+
+    for(unsigned int f = 0; f < count; ++f)
+        out[f] = 0;
+    for(unsigned int c = 0; c < 8; ++c)
+    {
+        double w = 1;
+        unsigned int i[3];
+        for(unsigned int a = 0; a < 3; ++a)
+        {
+            const bool upper = c & (1 << a);
+            w *= upper ? frac[a] : 1-frac[a];
+            i[a] = idx[a] + (upper && header.size[a] > 1);
+        }
+        if(w == 0)
+            continue;
+        const float *value = cell(i[0], i[1], i[2]) + first;
+        for(unsigned int f = 0; f < count; ++f)
+            out[f] += w*value[f];
+    }
+    return inside;
+}
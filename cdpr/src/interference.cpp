@@ -0,0 +1,271 @@
+#include <cdpr/interference.h>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+// signed distance from x to the box [-half, half], negative inside
+inline double boxDistance(const double x[3], const double half[3])
+{
+    double out = 0, in = -1e9;
+    for(unsigned int k = 0; k < 3; ++k)
+    {
+        const double d = std::abs(x[k]) - half[k];
+        out += d > 0 ? d*d : 0;
+        in = std::max(in, d);
+    }
+    return in > 0 ? std::sqrt(out) : in;
+}
+
+inline double clamp01(double x) {return std::min(std::max(x, 0.), 1.);}
+
+}
+
+Interference::Interference(const std::vector<vpTranslationVector> &Pf, const std::vector<vpTranslationVector> &Pp,
+                           const double platform_size[3], double radius, double range, double anchor_offset)
+    : radius(radius), range(range), anchor_offset(anchor_offset)
+{
+    init(Pf, Pp, platform_size);
+}
+
+Interference::Interference(ros::NodeHandle &nh, double range, double anchor_offset)
+    : radius(0), range(range), anchor_offset(anchor_offset)
+{
+    ros::NodeHandle model(nh, "model");
+    model.getParam("cable/radius", radius);
+
+    XmlRpc::XmlRpcValue element;
+    double size[3] = {0, 0, 0};
+    if(model.getParam("platform/size", element))
+        for(unsigned int i=0;i<3;++i)
+            size[i] = element[i];
+
+    std::vector<vpTranslationVector> Pf, Pp;
+    model.getParam("points", element);
+    double x, y, z;
+    for(int i=0;i<element.size();++i)
+    {
+        x = element[i]["frame"][0];
+        y = element[i]["frame"][1];
+        z = element[i]["frame"][2];
+        Pf.push_back(vpTranslationVector(x, y, z));
+        x = element[i]["platform"][0];
+        y = element[i]["platform"][1];
+        z = element[i]["platform"][2];
+        Pp.push_back(vpTranslationVector(x, y, z));
+    }
+    init(Pf, Pp, size);
+}
+
+void Interference::init(const std::vector<vpTranslationVector> &Pf, const std::vector<vpTranslationVector> &Pp,
+                        const double platform_size[3])
+{
+    n = Pf.size();
+    for(unsigned int k = 0; k < 3; ++k)
+        half[k] = 0.5*platform_size[k];
+    for(unsigned int i = 0; i < n; ++i)
+        for(unsigned int k = 0; k < 3; ++k)
+        {
+            frame.push_back(Pf[i][k]);
+            platform.push_back(Pp[i][k]);
+        }
+
+    auto same = [](const double *a, const double *b)
+    {
+        return std::abs(a[0]-b[0]) + std::abs(a[1]-b[1]) + std::abs(a[2]-b[2]) < 1e-9;
+    };
+    for(unsigned int i = 0; i < n; ++i)
+        for(unsigned int j = i+1; j < n; ++j)
+        {
+            if(same(&frame[3*i], &frame[3*j]) || same(&platform[3*i], &platform[3*j]))
+            {
+                shared_i.push_back(i);
+                shared_j.push_back(j);
+            }
+            else
+            {
+                pair_i.push_back(i);
+                pair_j.push_back(j);
+            }
+        }
+
+    p.resize(3*n);
+    q.resize(3*n);
+    box_lo.resize(3*n);
+    box_hi.resize(3*n);
+    cand.reserve(pair_i.size());
+    for(unsigned int k = 0; k < 3; ++k)
+    {
+        p1[k].resize(pair_i.size());
+        d1[k].resize(pair_i.size());
+        p2[k].resize(pair_i.size());
+        d2[k].resize(pair_i.size());
+    }
+    dist.resize(pair_i.size());
+    pair_clearance.resize(n*n, range);
+}
+
+void Interference::compute(const vpHomogeneousMatrix &M, Result &result)
+{
+    double R[9], t[3];
+    for(unsigned int i = 0; i < 3; ++i)
+    {
+        for(unsigned int j = 0; j < 3; ++j)
+            R[3*i+j] = M[i][j];
+        t[i] = M[i][3];
+    }
+    compute(R, t, result);
+}
+
+void Interference::compute(const double R[9], const double t[3], Result &result)
+{
+    // world segments from the frame points p to the platform points q, and their inflated bounding boxes
+    const double inflate = radius + 0.5*range;
+    for(unsigned int i = 0; i < n; ++i)
+    {
+        const double *b = &platform[3*i];
+        for(unsigned int k = 0; k < 3; ++k)
+        {
+            p[3*i+k] = frame[3*i+k];
+            q[3*i+k] = R[3*k]*b[0] + R[3*k+1]*b[1] + R[3*k+2]*b[2] + t[k];
+            box_lo[3*i+k] = std::min(p[3*i+k], q[3*i+k]) - inflate;
+            box_hi[3*i+k] = std::max(p[3*i+k], q[3*i+k]) + inflate;
+        }
+    }
+
+    // broadphase
+    cand.clear();
+    for(unsigned int c = 0; c < pair_i.size(); ++c)
+    {
+        const unsigned int i = pair_i[c], j = pair_j[c];
+        pair_clearance[i*n+j] = range;
+        bool overlap = true;
+        for(unsigned int k = 0; k < 3; ++k)
+            overlap &= box_lo[3*i+k] <= box_hi[3*j+k] && box_lo[3*j+k] <= box_hi[3*i+k];
+        if(!overlap)
+            continue;
+        const unsigned int m = cand.size();
+        cand.push_back(c);
+        for(unsigned int k = 0; k < 3; ++k)
+        {
+            p1[k][m] = p[3*i+k];
+            d1[k][m] = q[3*i+k] - p[3*i+k];
+            p2[k][m] = p[3*j+k];
+            d2[k][m] = q[3*j+k] - p[3*j+k];
+        }
+    }
+
+    // narrowphase, closest points of two segments (Ericson, Real-Time Collision Detection, 5.1.9)
+    // the parameter on the first segment is computed again from the clamped one on the second, without branches
+    const unsigned int m = cand.size();
+    const double *p1x = p1[0].data(), *p1y = p1[1].data(), *p1z = p1[2].data();
+    const double *d1x = d1[0].data(), *d1y = d1[1].data(), *d1z = d1[2].data();
+    const double *p2x = p2[0].data(), *p2y = p2[1].data(), *p2z = p2[2].data();
+    const double *d2x = d2[0].data(), *d2y = d2[1].data(), *d2z = d2[2].data();
+    double *d = dist.data();
+    for(unsigned int c = 0; c < m; ++c)
+    {
+        const double rx = p1x[c] - p2x[c], ry = p1y[c] - p2y[c], rz = p1z[c] - p2z[c];
+        const double a = d1x[c]*d1x[c] + d1y[c]*d1y[c] + d1z[c]*d1z[c];
+        const double e = d2x[c]*d2x[c] + d2y[c]*d2y[c] + d2z[c]*d2z[c];
+        const double b = d1x[c]*d2x[c] + d1y[c]*d2y[c] + d1z[c]*d2z[c];
+        const double cc = d1x[c]*rx + d1y[c]*ry + d1z[c]*rz;
+        const double f = d2x[c]*rx + d2y[c]*ry + d2z[c]*rz;
+        const double denom = a*e - b*b;
+        // parallel segments: any s, take 0
+        const double s0 = denom > 1e-12*a*e ? clamp01((b*f - cc*e)/denom) : 0;
+        const double tt = clamp01((b*s0 + f)/e);
+        const double s = clamp01((b*tt - cc)/a);
+        const double x = rx + s*d1x[c] - tt*d2x[c], y = ry + s*d1y[c] - tt*d2y[c], z = rz + s*d1z[c] - tt*d2z[c];
+        d[c] = std::sqrt(x*x + y*y + z*z);
+    }
+
+    result.cable = range;
+    result.pair[0] = result.pair[1] = -1;
+    result.candidates = m;
+    for(unsigned int c = 0; c < m; ++c)
+    {
+        const unsigned int i = pair_i[cand[c]], j = pair_j[cand[c]];
+        const double clearance = std::min(d[c] - 2*radius, range);
+        pair_clearance[i*n+j] = clearance;
+        if(clearance < result.cable)
+        {
+            result.cable = clearance;
+            result.pair[0] = i;
+            result.pair[1] = j;
+        }
+    }
+
+    // cables sharing an anchor: angle between them at that anchor
+    result.anchor_angle = M_PI;
+    result.anchor_pair[0] = result.anchor_pair[1] = -1;
+    for(unsigned int c = 0; c < shared_i.size(); ++c)
+    {
+        const unsigned int i = shared_i[c], j = shared_j[c];
+        const bool at_frame = std::abs(p[3*i]-p[3*j]) + std::abs(p[3*i+1]-p[3*j+1]) + std::abs(p[3*i+2]-p[3*j+2]) < 1e-9;
+        double u[3], v[3], nu = 0, nv = 0, dot = 0;
+        for(unsigned int k = 0; k < 3; ++k)
+        {
+            u[k] = at_frame ? q[3*i+k] - p[3*i+k] : p[3*i+k] - q[3*i+k];
+            v[k] = at_frame ? q[3*j+k] - p[3*j+k] : p[3*j+k] - q[3*j+k];
+            nu += u[k]*u[k];
+            nv += v[k]*v[k];
+            dot += u[k]*v[k];
+        }
+        const double angle = std::acos(std::min(std::max(dot/std::sqrt(nu*nv), -1.), 1.));
+        if(angle < result.anchor_angle)
+        {
+            result.anchor_angle = angle;
+            result.anchor_pair[0] = i;
+            result.anchor_pair[1] = j;
+        }
+    }
+
+    // cable - platform, in platform frame: the signed distance to the box is convex along the cable
+    result.platform = INFINITY;
+    result.cable_platform = -1;
+    for(unsigned int i = 0; i < n; ++i)
+    {
+        // direction toward the frame point
+        const double w[3] = {p[3*i] - q[3*i], p[3*i+1] - q[3*i+1], p[3*i+2] - q[3*i+2]};
+        double v[3], L = 0;
+        for(unsigned int k = 0; k < 3; ++k)
+        {
+            v[k] = R[k]*w[0] + R[3+k]*w[1] + R[6+k]*w[2];
+            L += v[k]*v[k];
+        }
+        L = std::sqrt(L);
+        if(L <= anchor_offset)
+            continue;
+        const double *c = &platform[3*i];
+        auto distance = [&](double s)
+        {
+            const double x[3] = {c[0] + s*v[0]/L, c[1] + s*v[1]/L, c[2] + s*v[2]/L};
+            return boxDistance(x, half);
+        };
+        // golden section on [anchor_offset, L]
+        const double g = 0.5*(std::sqrt(5.) - 1);
+        double lo = anchor_offset, hi = L;
+        double s1 = hi - g*(hi-lo), s2 = lo + g*(hi-lo), f1 = distance(s1), f2 = distance(s2);
+        for(unsigned int it = 0; it < 40 && hi - lo > 1e-4; ++it)
+        {
+            if(f1 < f2)
+            {
+                hi = s2; s2 = s1; f2 = f1;
+                s1 = hi - g*(hi-lo); f1 = distance(s1);
+            }
+            else
+            {
+                lo = s1; s1 = s2; f1 = f2;
+                s2 = lo + g*(hi-lo); f2 = distance(s2);
+            }
+        }
+        const double clearance = std::min(std::min(f1, f2), std::min(distance(anchor_offset), distance(L))) - radius;
+        if(clearance < result.platform)
+        {
+            result.platform = clearance;
+            result.cable_platform = i;
+        }
+    }
+}
@@ -0,0 +1,184 @@
+#include <cdpr/log.h>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+
+namespace cdpr_log
+{
+
+std::atomic<int> runtime_level(INFO);
+
+namespace
+{
+
+const size_t CAPACITY = 1024;     // power of 2
+const size_t TEXT_SIZE = 500;
+
+struct Slot
+{
+    std::atomic<size_t> seq;
+    Level level;
+    size_t length;
+    char text[TEXT_SIZE];
+};
+
+// bounded multi-producer / single-consumer ring (Vyukov), producers never block:
+// when the ring is full the message is dropped and counted
+class Writer
+{
+public:
+    Writer() : enqueue_pos(0), dequeue_pos(0), dropped(0), running(true)
+    {
+        for(size_t i = 0; i < CAPACITY; ++i)
+            slots[i].seq.store(i, std::memory_order_relaxed);
+        thread = std::thread(&Writer::drainLoop, this);
+    }
+
+    ~Writer()
+    {
+        running = false;
+        thread.join();
+    }
+
+    Slot* acquire()
+    {
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        while(true)
+        {
+            Slot &slot = slots[pos & (CAPACITY-1)];
+            const size_t seq = slot.seq.load(std::memory_order_acquire);
+            const intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+            if(dif == 0)
+            {
+                if(enqueue_pos.compare_exchange_weak(pos, pos+1, std::memory_order_relaxed))
+                {
+                    slot.length = 0;
+                    return &slot;
+                }
+            }
+            else if(dif < 0)
+            {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            else
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    void commit(Slot *slot)
+    {
+        const size_t pos = slot->seq.load(std::memory_order_relaxed);
+        slot->seq.store(pos+1, std::memory_order_release);
+    }
+
+    void flush()
+    {
+        while(dequeue_pos.load(std::memory_order_acquire) != enqueue_pos.load(std::memory_order_acquire))
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        fflush(stdout);
+    }
+
+protected:
+    Slot slots[CAPACITY];
+    std::atomic<size_t> enqueue_pos, dequeue_pos;
+    std::atomic<unsigned long> dropped;
+    std::atomic<bool> running;
+    std::thread thread;
+
+    // returns false if nothing was pending
+    bool drain()
+    {
+        bool written = false;
+        while(true)
+        {
+            const size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+            Slot &slot = slots[pos & (CAPACITY-1)];
+            if(slot.seq.load(std::memory_order_acquire) != pos+1)
+                break;
+
+            FILE *out = slot.level >= WARN ? stderr : stdout;
+            if(slot.level == WARN)
+                fputs("[WARN] ", out);
+            else if(slot.level == ERROR)
+                fputs("[ERROR] ", out);
+            fwrite(slot.text, 1, slot.length, out);
+            fputc('\n', out);
+
+            slot.seq.store(pos + CAPACITY, std::memory_order_release);
+            dequeue_pos.store(pos+1, std::memory_order_release);
+            written = true;
+        }
+
+        const unsigned long lost = dropped.exchange(0, std::memory_order_relaxed);
+        if(lost)
+            fprintf(stderr, "[WARN] log buffer full, %lu messages dropped\n", lost);
+        if(written)
+            fflush(stdout);
+        return written;
+    }
+
+    void drainLoop()
+    {
+        while(running)
+        {
+            if(!drain())
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        drain();
+    }
+};
+
+Writer& writer()
+{
+    static Writer w;
+    return w;
+}
+
+}
+
+bool setLevel(const std::string &level)
+{
+    static const char* names[] = {"debug", "info", "warn", "error", "none"};
+    for(int i = 0; i <= NONE; ++i)
+    {
+        if(level == names[i])
+        {
+            runtime_level = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void flush()
+{
+    writer().flush();
+}
+
+Message::Message(Level level) : os(&buf)
+{
+    Slot *s = writer().acquire();
+    slot = s;
+    if(s)
+    {
+        s->level = level;
+        buf.reset(s->text, TEXT_SIZE);
+    }
+    else
+        os.setstate(std::ios::badbit);
+    os.precision(3);
+}
+
+Message::~Message()
+{
+    if(slot)
+    {
+        Slot *s = static_cast<Slot*>(slot);
+        s->length = buf.length();
+        writer().commit(s);
+    }
+}
+
+}
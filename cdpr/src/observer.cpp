@@ -0,0 +1,171 @@
+#include <cdpr/observer.h>
+
+namespace
+{
+typedef Eigen::Vector3d Vector3d;
+typedef Eigen::Quaterniond Quaterniond;
+
+// rotation vector to quaternion
+inline Quaterniond expq(const Vector3d &theta)
+{
+    const double angle = theta.norm();
+    if(angle < 1e-12)
+        return Quaterniond(1, .5*theta(0), .5*theta(1), .5*theta(2)).normalized();
+    return Quaterniond(Eigen::AngleAxisd(angle, theta/angle));
+}
+
+// quaternion to rotation vector, angle in [0, pi]
+inline Vector3d logq(const Quaterniond &q)
+{
+    const Eigen::AngleAxisd aa(q);
+    return aa.angle()*aa.axis();
+}
+}
+
+StateObserver::StateObserver(const std::vector<Vector3d> &frame_points, const std::vector<Vector3d> &platform_points,
+                             const Noise &noise)
+    : Pf(frame_points), Pp(platform_points), noise(noise), Q_dt(-1)
+{
+    reset(Vector3d::Zero(), Quaterniond::Identity());
+}
+
+void StateObserver::reset(const Vector3d &position, const Quaterniond &orientation, double sigma_p, double sigma_r)
+{
+    p = position;
+    q = orientation.normalized();
+    v.setZero();
+    w.setZero();
+    a.setZero();
+    alpha.setZero();
+    dx.setZero();
+
+    // at rest with some uncertainty on the derivatives
+    P.setZero();
+    P.diagonal().segment<3>(POS).setConstant(sigma_p*sigma_p);
+    P.diagonal().segment<3>(ROT).setConstant(sigma_r*sigma_r);
+    P.diagonal().segment<6>(VEL).setConstant(1e-2);
+    P.diagonal().segment<6>(ACC).setConstant(1.);
+}
+
+void StateObserver::predict(double dt)
+{
+    // nominal state, constant acceleration
+    p += dt*v + .5*dt*dt*a;
+    v += dt*a;
+    q = (expq(dt*w + .5*dt*dt*alpha) * q).normalized();
+    w += dt*alpha;
+
+    // transition and process noise only depend on dt
+    if(dt != Q_dt)
+    {
+        Q_dt = dt;
+        F.setIdentity();
+        Q.setZero();
+        const double dt2 = dt*dt, dt3 = dt2*dt, dt4 = dt3*dt, dt5 = dt4*dt;
+        for(int block = 0; block < 2; ++block)
+        {
+            // (p, v, a) then (θ, ω, α)
+            const int x = block ? ROT : POS, dxdt = block ? OMEGA : VEL, ddx = block ? ALPHA : ACC;
+            const double s = block ? noise.angular_jerk*noise.angular_jerk : noise.jerk*noise.jerk;
+            F.block<3,3>(x, dxdt).diagonal().setConstant(dt);
+            F.block<3,3>(x, ddx).diagonal().setConstant(.5*dt2);
+            F.block<3,3>(dxdt, ddx).diagonal().setConstant(dt);
+
+            // discrete white jerk
+            Q.block<3,3>(x, x).diagonal().setConstant(s*dt5/20);
+            Q.block<3,3>(x, dxdt).diagonal().setConstant(s*dt4/8);
+            Q.block<3,3>(x, ddx).diagonal().setConstant(s*dt3/6);
+            Q.block<3,3>(dxdt, dxdt).diagonal().setConstant(s*dt3/3);
+            Q.block<3,3>(dxdt, ddx).diagonal().setConstant(s*dt2/2);
+            Q.block<3,3>(ddx, ddx).diagonal().setConstant(s*dt);
+            Q.block<3,3>(dxdt, x) = Q.block<3,3>(x, dxdt);
+            Q.block<3,3>(ddx, x) = Q.block<3,3>(x, ddx);
+            Q.block<3,3>(ddx, dxdt) = Q.block<3,3>(dxdt, ddx);
+        }
+    }
+
+    const Matrix18d FP = F*P;
+    P.noalias() = FP*F.transpose();
+    P += Q;
+}
+
+void StateObserver::scalarUpdate(int i0, const Vector3d &h0, double residual, double r)
+{
+    const Vector18d PHt = P.middleCols<3>(i0)*h0;
+    const double S = h0.dot(PHt.segment<3>(i0)) + r;
+    const double y = residual - h0.dot(dx.segment<3>(i0));
+    const Vector18d K = PHt / S;
+    dx += K*y;
+    P.noalias() -= K*PHt.transpose();
+}
+
+void StateObserver::scalarUpdate(int i0, const Vector3d &h0, int i1, const Vector3d &h1, double residual, double r)
+{
+    const Vector18d PHt = P.middleCols<3>(i0)*h0 + P.middleCols<3>(i1)*h1;
+    const double S = h0.dot(PHt.segment<3>(i0)) + h1.dot(PHt.segment<3>(i1)) + r;
+    const double y = residual - h0.dot(dx.segment<3>(i0)) - h1.dot(dx.segment<3>(i1));
+    const Vector18d K = PHt / S;
+    dx += K*y;
+    P.noalias() -= K*PHt.transpose();
+}
+
+void StateObserver::inject()
+{
+    p += dx.segment<3>(POS);
+    q = (expq(dx.segment<3>(ROT)) * q).normalized();
+    v += dx.segment<3>(VEL);
+    w += dx.segment<3>(OMEGA);
+    a += dx.segment<3>(ACC);
+    alpha += dx.segment<3>(ALPHA);
+    dx.setZero();
+    // keep P symmetric
+    P = .5*(P + P.transpose()).eval();
+}
+
+void StateObserver::updatePose(const Vector3d &position, const Quaterniond &orientation)
+{
+    const double rp = noise.position*noise.position, rr = noise.orientation*noise.orientation;
+    const Vector3d dp = position - p;
+    // world frame rotation error
+    const Vector3d dtheta = logq(orientation * q.conjugate());
+    for(int k = 0; k < 3; ++k)
+    {
+        scalarUpdate(POS, Vector3d::Unit(k), dp(k), rp);
+        scalarUpdate(ROT, Vector3d::Unit(k), dtheta(k), rr);
+    }
+    inject();
+}
+
+void StateObserver::updateTwist(const Vector6d &twist)
+{
+    const double rv = noise.velocity*noise.velocity, rw = noise.angular_velocity*noise.angular_velocity;
+    for(int k = 0; k < 3; ++k)
+    {
+        scalarUpdate(VEL, Vector3d::Unit(k), twist(k) - v(k), rv);
+        scalarUpdate(OMEGA, Vector3d::Unit(k), twist(k+3) - w(k), rw);
+    }
+    inject();
+}
+
+void StateObserver::updateCables(const double *L, const double *dL)
+{
+    const double rl = noise.length*noise.length, rd = noise.length_rate*noise.length_rate;
+    const Matrix3d R = q.toRotationMatrix();
+    for(unsigned int i = 0; i < Pf.size(); ++i)
+    {
+        // unit vector from platform point to frame point
+        const Vector3d Rb = R*Pp[i];
+        Vector3d u = Pf[i] - p - Rb;
+        const double length = u.norm();
+        u /= length;
+        // moment arm, so that (u, Rb x u) is the column of W in world frame
+        const Vector3d c = Rb.cross(u);
+
+        // L = |Pf - p - R.b| -> dL = -u.dp - (Rb x u).dθ
+        scalarUpdate(POS, -u, ROT, -c, L[i] - length, rl);
+        // dL/dt = -u.v - (Rb x u).ω
+        if(dL)
+            scalarUpdate(VEL, -u, OMEGA, -c, dL[i] + u.dot(v) + c.dot(w), rd);
+    }
+    inject();
+}
@@ -0,0 +1,504 @@
+#include <cdpr/obstacles.h>
+#include <cdpr/log.h>
+#include <cdpr/param.h>
+#include <ros/package.h>
+#include <visp/vpRxyzVector.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <numeric>
+#include <thread>
+#include <cstring>
+#include <cmath>
+
+namespace
+{
+
+inline double dot(const double *u, const double *v) {return u[0]*v[0] + u[1]*v[1] + u[2]*v[2];}
+inline void sub(const double *u, const double *v, double *w) {w[0] = u[0]-v[0]; w[1] = u[1]-v[1]; w[2] = u[2]-v[2];}
+inline void cross(const double *u, const double *v, double *w)
+{
+    w[0] = u[1]*v[2] - u[2]*v[1];
+    w[1] = u[2]*v[0] - u[0]*v[2];
+    w[2] = u[0]*v[1] - u[1]*v[0];
+}
+inline double clamp01(double x) {return std::min(std::max(x, 0.), 1.);}
+
+// squared distance between segments [p1, q1] and [p2, q2] (Ericson, Real-Time Collision Detection, 5.1.9)
+double segmentSegment2(const double *p1, const double *q1, const double *p2, const double *q2)
+{
+    double d1[3], d2[3], r[3];
+    sub(q1, p1, d1);
+    sub(q2, p2, d2);
+    sub(p1, p2, r);
+    const double a = dot(d1, d1), e = dot(d2, d2), f = dot(d2, r);
+    double s, t;
+    if(a <= 1e-18 && e <= 1e-18)
+        s = t = 0;
+    else if(a <= 1e-18)
+    {
+        s = 0;
+        t = clamp01(f/e);
+    }
+    else
+    {
+        const double c = dot(d1, r);
+        if(e <= 1e-18)
+        {
+            t = 0;
+            s = clamp01(-c/a);
+        }
+        else
+        {
+            const double b = dot(d1, d2), denom = a*e - b*b;
+            s = denom > 1e-12*a*e ? clamp01((b*f - c*e)/denom) : 0;
+            t = (b*s + f)/e;
+            if(t < 0)
+            {
+                t = 0;
+                s = clamp01(-c/a);
+            }
+            else if(t > 1)
+            {
+                t = 1;
+                s = clamp01((b - c)/a);
+            }
+        }
+    }
+    double w[3];
+    for(unsigned int k = 0; k < 3; ++k)
+        w[k] = r[k] + s*d1[k] - t*d2[k];
+    return dot(w, w);
+}
+
+// squared distance from p to the triangle abc (Ericson, 5.1.5)
+double pointTriangle2(const double *p, const double *a, const double *b, const double *c)
+{
+    double ab[3], ac[3], ap[3], x[3];
+    sub(b, a, ab);
+    sub(c, a, ac);
+    sub(p, a, ap);
+    auto closest = [&](const double *o, const double *u, double s, const double *v, double t)
+    {
+        for(unsigned int k = 0; k < 3; ++k)
+            x[k] = o[k] + s*u[k] + t*v[k];
+        double w[3];
+        sub(p, x, w);
+        return dot(w, w);
+    };
+    const double d1 = dot(ab, ap), d2 = dot(ac, ap);
+    if(d1 <= 0 && d2 <= 0)
+        return dot(ap, ap);
+    double bp[3];
+    sub(p, b, bp);
+    const double d3 = dot(ab, bp), d4 = dot(ac, bp);
+    if(d3 >= 0 && d4 <= d3)
+        return dot(bp, bp);
+    const double vc = d1*d4 - d3*d2;
+    if(vc <= 0 && d1 >= 0 && d3 <= 0)
+        return closest(a, ab, d1/(d1 - d3), ac, 0);
+    double cp[3];
+    sub(p, c, cp);
+    const double d5 = dot(ab, cp), d6 = dot(ac, cp);
+    if(d6 >= 0 && d5 <= d6)
+        return dot(cp, cp);
+    const double vb = d5*d2 - d1*d6;
+    if(vb <= 0 && d2 >= 0 && d6 <= 0)
+        return closest(a, ab, 0, ac, d2/(d2 - d6));
+    const double va = d3*d6 - d5*d4;
+    if(va <= 0 && d4 - d3 >= 0 && d5 - d6 >= 0)
+    {
+        double bc[3];
+        sub(c, b, bc);
+        return closest(b, bc, (d4 - d3)/((d4 - d3) + (d5 - d6)), ab, 0);
+    }
+    const double denom = 1/(va + vb + vc);
+    return closest(a, ab, vb*denom, ac, vc*denom);
+}
+
+// distance between the segment [p, q] and the triangle abc
+// 0 if the segment crosses the triangle, otherwise reached at an end of the segment or on an edge of the triangle
+double segmentTriangle(const double *p, const double *q, const double *a, const double *b, const double *c)
+{
+    double d[3], e1[3], e2[3], h[3], s[3], qv[3];
+    sub(q, p, d);
+    sub(b, a, e1);
+    sub(c, a, e2);
+    cross(d, e2, h);
+    const double det = dot(e1, h);
+    if(std::abs(det) > 1e-14)
+    {
+        // Moller-Trumbore on t in [0, 1]
+        const double inv = 1/det;
+        sub(p, a, s);
+        const double u = inv*dot(s, h);
+        cross(s, e1, qv);
+        const double v = inv*dot(d, qv), t = inv*dot(e2, qv);
+        if(u >= 0 && v >= 0 && u + v <= 1 && t >= 0 && t <= 1)
+            return 0;
+    }
+    double best = std::min(pointTriangle2(p, a, b, c), pointTriangle2(q, a, b, c));
+    best = std::min(best, segmentSegment2(p, q, a, b));
+    best = std::min(best, segmentSegment2(p, q, b, c));
+    best = std::min(best, segmentSegment2(p, q, c, a));
+    return std::sqrt(best);
+}
+
+// whether the segment [p, q] crosses the box [lo - d, hi + d] (slabs)
+inline bool segmentBox(const double *p, const double *q, const double *lo, const double *hi, double d)
+{
+    double t0 = 0, t1 = 1;
+    for(unsigned int k = 0; k < 3; ++k)
+    {
+        const double dir = q[k] - p[k], l = lo[k] - d, h = hi[k] + d;
+        if(std::abs(dir) < 1e-15)
+        {
+            if(p[k] < l || p[k] > h)
+                return false;
+            continue;
+        }
+        double ta = (l - p[k])/dir, tb = (h - p[k])/dir;
+        if(ta > tb)
+            std::swap(ta, tb);
+        t0 = std::max(t0, ta);
+        t1 = std::min(t1, tb);
+        if(t0 > t1)
+            return false;
+    }
+    return true;
+}
+
+// empty if the URI has no file part
+std::string resolve(const std::string &uri)
+{
+    for(const std::string prefix: {"package://", "model://"})
+        if(uri.compare(0, prefix.size(), prefix) == 0)
+        {
+            const std::string rest = uri.substr(prefix.size());
+            const size_t slash = rest.find('/');
+            if(slash == std::string::npos)
+                return "";
+            return ros::package::getPath(rest.substr(0, slash)) + rest.substr(slash);
+        }
+    if(uri.compare(0, 7, "file://") == 0)
+        return uri.substr(7);
+    return uri;
+}
+
+}
+
+Obstacles::Obstacles(const std::vector<vpTranslationVector> &Pf, const std::vector<vpTranslationVector> &Pp,
+                     double radius, double range)
+    : n(Pf.size()), radius(radius), range(range)
+{
+    for(unsigned int i = 0; i < n; ++i)
+        for(unsigned int k = 0; k < 3; ++k)
+        {
+            frame.push_back(Pf[i][k]);
+            platform.push_back(Pp[i][k]);
+        }
+}
+
+Obstacles::Obstacles(ros::NodeHandle &nh, double range)
+    : n(0), radius(0), range(range)
+{
+    ros::NodeHandle model(nh, "model");
+    model.getParam("cable/radius", radius);
+
+    XmlRpc::XmlRpcValue element;
+    model.getParam("points", element);
+    for(int i=0;i<element.size();++i)
+    {
+        for(unsigned int k=0;k<3;++k)
+        {
+            frame.push_back(cdpr_param::toDouble(element[i]["frame"][k]));
+            platform.push_back(cdpr_param::toDouble(element[i]["platform"][k]));
+        }
+        n++;
+    }
+
+    if(!model.getParam("obstacles", element))
+        return;
+    for(int i=0;i<element.size();++i)
+    {
+        double xyz[3] = {0, 0, 0}, rpy[3] = {0, 0, 0}, scale = 1;
+        for(unsigned int k=0;k<3;++k)
+        {
+            if(element[i].hasMember("xyz"))
+                xyz[k] = cdpr_param::toDouble(element[i]["xyz"][k]);
+            if(element[i].hasMember("rpy"))
+                rpy[k] = cdpr_param::toDouble(element[i]["rpy"][k]);
+        }
+        if(element[i].hasMember("scale"))
+            scale = cdpr_param::toDouble(element[i]["scale"]);
+        const std::string uri = element[i]["mesh"], mesh = resolve(uri);
+        if(mesh.empty())
+        {
+            CDPR_WARN("obstacles: no file in " << uri << ", skipped");
+            continue;
+        }
+        const vpHomogeneousMatrix M(vpTranslationVector(xyz[0], xyz[1], xyz[2]),
+                                    vpRotationMatrix(vpRxyzVector(rpy[0], rpy[1], rpy[2])));
+        if(!load(mesh, M, scale))
+            CDPR_WARN("obstacles: cannot read " << mesh);
+    }
+    build();
+    CDPR_INFO("obstacles: " << triangles() << " triangles, " << nodes.size() << " boxes");
+}
+
+bool Obstacles::load(const std::string &file, const vpHomogeneousMatrix &M, double scale)
+{
+    std::ifstream in(file, std::ios::binary);
+    if(!in)
+        return false;
+    const std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    const size_t before = tri.size();
+    double v[3][3];
+    auto vertex = [&](const double x[3], double out[3])
+    {
+        for(unsigned int k = 0; k < 3; ++k)
+            out[k] = M[k][0]*scale*x[0] + M[k][1]*scale*x[1] + M[k][2]*scale*x[2] + M[k][3];
+    };
+
+    // binary: 80-byte header, count, then 50 bytes per triangle (normal, 3 vertices as float, attribute)
+    // some binary files also start with "solid", the size tells them apart
+    uint32_t count = 0;
+    if(content.size() >= 84)
+        memcpy(&count, content.data() + 80, 4);
+    if(content.size() >= 84 && content.size() == 84 + 50*size_t(count))
+    {
+        for(uint32_t t = 0; t < count; ++t)
+        {
+            const char *record = content.data() + 84 + 50*size_t(t) + 12;
+            for(unsigned int j = 0; j < 3; ++j)
+            {
+                float f[3];
+                memcpy(f, record + 12*j, 12);
+                const double x[3] = {f[0], f[1], f[2]};
+                vertex(x, v[j]);
+            }
+            add(v[0], v[1], v[2]);
+        }
+        return true;
+    }
+
+    // ascii: only the vertices matter, 3 per facet
+    std::istringstream ss(content);
+    std::string word;
+    unsigned int j = 0;
+    while(ss >> word)
+    {
+        if(word != "vertex")
+            continue;
+        double x[3];
+        if(!(ss >> x[0] >> x[1] >> x[2]))
+            break;
+        vertex(x, v[j]);
+        if(++j == 3)
+        {
+            add(v[0], v[1], v[2]);
+            j = 0;
+        }
+    }
+    return tri.size() > before;
+}
+
+void Obstacles::add(const double a[3], const double b[3], const double c[3])
+{
+    index.push_back(index.size());
+    tri.insert(tri.end(), a, a+3);
+    tri.insert(tri.end(), b, b+3);
+    tri.insert(tri.end(), c, c+3);
+    nodes.clear();
+}
+
+void Obstacles::build(unsigned int leaf_size)
+{
+    nodes.clear();
+    const unsigned int count = triangles();
+    if(!count)
+        return;
+    std::vector<double> centroid(3*count);
+    for(unsigned int t = 0; t < count; ++t)
+        for(unsigned int k = 0; k < 3; ++k)
+            centroid[3*t+k] = (tri[9*t+k] + tri[9*t+3+k] + tri[9*t+6+k])/3;
+    nodes.reserve(2*count/std::max(leaf_size, 1u) + 1);
+    buildNode(0, count, std::max(leaf_size, 1u), centroid, 1);
+}
+
+unsigned int Obstacles::buildNode(unsigned int first, unsigned int count, unsigned int leaf_size,
+                                  std::vector<double> &centroid, unsigned int level)
+{
+    const unsigned int id = nodes.size();
+    nodes.emplace_back();
+    Node node;
+    double c_lo[3], c_hi[3];
+    for(unsigned int k = 0; k < 3; ++k)
+    {
+        node.lo[k] = c_lo[k] = INFINITY;
+        node.hi[k] = c_hi[k] = -INFINITY;
+    }
+    for(unsigned int t = first; t < first + count; ++t)
+        for(unsigned int k = 0; k < 3; ++k)
+        {
+            for(unsigned int j = 0; j < 3; ++j)
+            {
+                node.lo[k] = std::min(node.lo[k], tri[9*t+3*j+k]);
+                node.hi[k] = std::max(node.hi[k], tri[9*t+3*j+k]);
+            }
+            c_lo[k] = std::min(c_lo[k], centroid[3*t+k]);
+            c_hi[k] = std::max(c_hi[k], centroid[3*t+k]);
+        }
+
+    if(count <= leaf_size || level >= MAX_DEPTH)
+    {
+        node.first = first;
+        node.count = count;
+        nodes[id] = node;
+        return id;
+    }
+
+    // median split of the centroids along the largest side, keeps the tree balanced
+    unsigned int axis = 0;
+    for(unsigned int k = 1; k < 3; ++k)
+        if(c_hi[k] - c_lo[k] > c_hi[axis] - c_lo[axis])
+            axis = k;
+    std::vector<unsigned int> order(count);
+    std::iota(order.begin(), order.end(), first);
+    const unsigned int half = count/2;
+    std::nth_element(order.begin(), order.begin() + half, order.end(), [&](unsigned int a, unsigned int b)
+    {
+        return centroid[3*a+axis] < centroid[3*b+axis];
+    });
+    std::vector<double> t_sorted(9*count), c_sorted(3*count);
+    std::vector<unsigned int> i_sorted(count);
+    for(unsigned int m = 0; m < count; ++m)
+    {
+        std::copy(tri.begin() + 9*order[m], tri.begin() + 9*order[m] + 9, t_sorted.begin() + 9*m);
+        std::copy(centroid.begin() + 3*order[m], centroid.begin() + 3*order[m] + 3, c_sorted.begin() + 3*m);
+        i_sorted[m] = index[order[m]];
+    }
+    std::copy(t_sorted.begin(), t_sorted.end(), tri.begin() + 9*first);
+    std::copy(c_sorted.begin(), c_sorted.end(), centroid.begin() + 3*first);
+    std::copy(i_sorted.begin(), i_sorted.end(), index.begin() + first);
+
+    buildNode(first, half, leaf_size, centroid, level+1);
+    node.first = buildNode(first + half, count - half, leaf_size, centroid, level+1);
+    node.count = 0;
+    nodes[id] = node;
+    return id;
+}
+
+double Obstacles::distance(const double p[3], const double q[3], double range, int *triangle, unsigned int *tests) const
+{
+    double best = range;
+    int found = -1;
+    unsigned int tested = 0;
+    if(nodes.empty())
+    {
+        for(unsigned int t = 0; t < triangles(); ++t)
+        {
+            const double d = segmentTriangle(p, q, &tri[9*t], &tri[9*t+3], &tri[9*t+6]);
+            if(d < best)
+            {
+                best = d;
+                found = index[t];
+            }
+        }
+        tested = triangles();
+    }
+    else
+    {
+        // depth-first, the child closer to the middle of the segment first
+        const double mid[3] = {0.5*(p[0]+q[0]), 0.5*(p[1]+q[1]), 0.5*(p[2]+q[2])};
+        // each level pushes two nodes and pops one
+        unsigned int stack[MAX_DEPTH+1], top = 0;
+        stack[top++] = 0;
+        while(top && best > 0)
+        {
+            const Node &node = nodes[stack[--top]];
+            tested++;
+            if(!segmentBox(p, q, node.lo, node.hi, best))
+                continue;
+            if(node.count)
+            {
+                for(unsigned int t = node.first; t < node.first + node.count; ++t)
+                {
+                    const double d = segmentTriangle(p, q, &tri[9*t], &tri[9*t+3], &tri[9*t+6]);
+                    if(d < best)
+                    {
+                        best = d;
+                        found = index[t];
+                    }
+                }
+                tested += node.count;
+                continue;
+            }
+            const unsigned int left = &node - nodes.data() + 1, right = node.first;
+            double dl = 0, dr = 0;
+            for(unsigned int k = 0; k < 3; ++k)
+            {
+                const double cl = 0.5*(nodes[left].lo[k] + nodes[left].hi[k]) - mid[k];
+                const double cr = 0.5*(nodes[right].lo[k] + nodes[right].hi[k]) - mid[k];
+                dl += cl*cl;
+                dr += cr*cr;
+            }
+            stack[top++] = dl < dr ? right : left;
+            stack[top++] = dl < dr ? left : right;
+        }
+    }
+    if(triangle)
+        *triangle = found;
+    if(tests)
+        *tests += tested;
+    return best;
+}
+
+double Obstacles::bruteForce(const double p[3], const double q[3], double range) const
+{
+    double best = range;
+    for(unsigned int t = 0; t < triangles(); ++t)
+        best = std::min(best, segmentTriangle(p, q, &tri[9*t], &tri[9*t+3], &tri[9*t+6]));
+    return best;
+}
+
+void Obstacles::compute(const vpHomogeneousMatrix &M, Result &result) const
+{
+    result.clearance = range;
+    result.cable = result.triangle = -1;
+    result.tests = 0;
+    result.cables.resize(n);
+    for(unsigned int i = 0; i < n; ++i)
+    {
+        const double *b = &platform[3*i];
+        double q[3];
+        for(unsigned int k = 0; k < 3; ++k)
+            q[k] = M[k][0]*b[0] + M[k][1]*b[1] + M[k][2]*b[2] + M[k][3];
+        int triangle;
+        const double clearance = distance(&frame[3*i], q, range + radius, &triangle, &result.tests) - radius;
+        result.cables[i] = std::min(clearance, range);
+        if(clearance < result.clearance)
+        {
+            result.clearance = clearance;
+            result.cable = i;
+            result.triangle = triangle;
+        }
+    }
+}
+
+void Obstacles::compute(const std::vector<vpHomogeneousMatrix> &poses, std::vector<Result> &results, unsigned int threads) const
+{
+    results.resize(poses.size());
+    threads = std::max(1u, std::min<unsigned int>(threads, poses.size()));
+    const size_t chunk = (poses.size() + threads - 1)/std::max(threads, 1u);
+    std::vector<std::thread> pool;
+    for(unsigned int th = 0; th < threads; ++th)
+        pool.emplace_back([&, th]()
+        {
+            for(size_t k = th*chunk; k < std::min(poses.size(), (th+1)*chunk); ++k)
+                compute(poses[k], results[k]);
+        });
+    for(auto &th: pool)
+        th.join();
+}
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <math.h>
+#include <Eigen/Core>
 
 // this class implements a 2nd-order Butterworth low-pass filter
 
@@ -82,4 +83,110 @@ protected:
 
 
 
+// bank of N low-pass Butterworth filters of order 2*Sections, one per channel
+// the state is stored as structure of arrays (one Eigen array per coefficient / state over all channels)
+// so that all channels are filtered with SIMD instructions, without allocation
+// each section is a biquad in transposed direct form II, the cutoff may differ between channels
+// N = Eigen::Dynamic gives the number of channels at construction
+
+template <int N, int Sections = 1>
+class ButterworthBank
+{
+public:
+    typedef Eigen::Array<double, N, 1> Array;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    // same cutoff frequency for all channels
+    ButterworthBank(double frequency, double dt, int channels = N)
+    {
+        init(Array::Constant(channels, frequency), dt);
+    }
+
+    // one cutoff frequency per channel
+    ButterworthBank(const std::vector<double> &frequencies, double dt)
+    {
+        init(Eigen::Map<const Eigen::ArrayXd>(frequencies.data(), frequencies.size()), dt);
+    }
+
+    inline int channels() const {return cutoff.size();}
+
+    // changes the cutoff of a channel, its state is kept
+    void setCutoff(int channel, double frequency)
+    {
+        cutoff(channel) = frequency;
+        const double K = tan(M_PI*frequency*dt);
+        for(int k = 0; k < Sections; ++k)
+        {
+            // poles of the analog prototype
+            const double q = 2*cos(M_PI*(2*k+1)/(4.*Sections));
+            const double norm = 1./(1. + q*K + K*K);
+            sections[k].b0(channel) = K*K*norm;
+            sections[k].a1(channel) = 2*(K*K - 1)*norm;
+            sections[k].a2(channel) = (1 - q*K + K*K)*norm;
+        }
+    }
+
+    // steady state for a constant input
+    void reset(const Array &value)
+    {
+        for(auto &s: sections)
+        {
+            s.s2 = (s.b0 - s.a2)*value;
+            s.s1 = (1 - s.b0)*value;
+        }
+    }
+    void reset() {reset(Array::Zero(channels()));}
+
+    // filters one sample of all channels in place
+    inline void Filter(Array &v)
+    {
+        for(auto &s: sections)
+        {
+            // b1 = 2.b0, b2 = b0 for a low-pass
+            // input of the section, preallocated so that dynamic banks do not allocate either
+            Array &x = input;
+            x = v;
+            v = s.b0*x + s.s1;
+            s.s1 = 2*s.b0*x - s.a1*v + s.s2;
+            s.s2 = s.b0*x - s.a2*v;
+        }
+    }
+
+    // any vector with size() and operator[] (vpColVector, std::vector...)
+    template <class T>
+    inline void Filter(T &var)
+    {
+        for(int i=0;i<channels();++i)
+            buffer(i) = var[i];
+        Filter(buffer);
+        for(int i=0;i<channels();++i)
+            var[i] = buffer(i);
+    }
+
+protected:
+    struct Section
+    {
+        Array b0, a1, a2;   // coefficients
+        Array s1, s2;       // state
+    };
+    Section sections[Sections];
+    Array cutoff, buffer, input;
+    double dt;
+
+    template <class Frequencies>
+    void init(const Frequencies &frequencies, double _dt)
+    {
+        dt = _dt;
+        cutoff = frequencies;
+        buffer.setZero(cutoff.size());
+        input.setZero(cutoff.size());
+        for(auto &s: sections)
+            s.b0 = s.a1 = s.a2 = Array::Zero(cutoff.size());
+        for(int i = 0; i < cutoff.size(); ++i)
+            setCutoff(i, cutoff(i));
+        reset();
+    }
+};
+
 #endif // BUTTERWORTH_H
@@ -0,0 +1,106 @@
+#ifndef CAPACITY_H
+#define CAPACITY_H
+
+#include <visp/vpMatrix.h>
+#include <visp/vpColVector.h>
+#include <Eigen/Core>
+#include <Eigen/QR>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+// capacity margin: how far the required wrenches are from the boundary of the available wrench set
+// the available set is the zonotope {W.tau, tau_min <= tau <= tau_max}, its facets are found with hyperplane shifting:
+//  - each set of 5 cables whose directions span a hyperplane gives a normal e, orthogonal to their columns
+//  - the facet of normal e is at the support h(e) = e.W.(tau_min + tau_max)/2 + (tau_max - tau_min)/2.sum |e.W_i|
+//  - the margin of w is min over the facets of h(e) - e.w, negative if w is outside
+// moments are divided by a characteristic length to be compared with forces, the margin is then in N
+//
+// per pose: the normals are stacked in E, then all the projections E.W come from one matrix product
+// keeps its buffers, use one instance per thread
+
+class CapacityMargin
+{
+public:
+    typedef Eigen::Matrix<double, 6, Eigen::Dynamic> Matrix6Xd;
+    typedef Eigen::Matrix<double, Eigen::Dynamic, 6> MatrixX6d;
+
+    CapacityMargin(unsigned int n, double tau_min, double tau_max, double length = 1)
+        : n(n), tau_mid(0.5*(tau_min + tau_max)), tau_half(0.5*(tau_max - tau_min)), length(length)
+    {
+        // sets of 5 cables
+        if(n >= 6)
+        {
+            std::vector<bool> pick(n, false);
+            std::fill(pick.begin(), pick.begin() + 5, true);
+            do
+            {
+                std::array<unsigned int, 5> set;
+                unsigned int k = 0;
+                for(unsigned int i = 0; i < n; ++i)
+                    if(pick[i])
+                        set[k++] = i;
+                sets.push_back(set);
+            } while(std::prev_permutation(pick.begin(), pick.end()));
+        }
+        E.resize(sets.size(), 6);
+        Ws.resize(6, n);
+    }
+
+    inline unsigned int facets() const {return 2*sets.size();}
+
+    // smallest margin over the required wrenches, -inf if the cables cannot span the wrench space
+    double compute(const vpMatrix &W, const std::vector<vpColVector> &wrenches)
+    {
+        if(sets.empty())
+            return -INFINITY;
+        for(unsigned int i = 0; i < n; ++i)
+            for(unsigned int k = 0; k < 6; ++k)
+                Ws(k, i) = k < 3 ? W[k][i] : W[k][i]/length;
+
+        // normal: last column of Q in the QR decomposition of the 6x5 columns of the set
+        unsigned int m = 0;
+        Eigen::Matrix<double, 6, 5> A;
+        Eigen::Matrix<double, 6, 1> last = Eigen::Matrix<double, 6, 1>::Unit(5);
+        for(const auto &set: sets)
+        {
+            for(unsigned int j = 0; j < 5; ++j)
+                A.col(j) = Ws.col(set[j]);
+            qr.compute(A);
+            // columns not spanning a hyperplane
+            if(qr.matrixQR().diagonal().cwiseAbs().minCoeff() <= 1e-9*A.colwise().norm().maxCoeff())
+                continue;
+            E.row(m++) = (qr.householderQ()*last).transpose();
+        }
+        if(!m)
+            return -INFINITY;
+
+        // support of the zonotope along +/- each normal
+        const auto Em = E.topRows(m);
+        P.noalias() = Em*Ws;
+        const Eigen::VectorXd center = tau_mid*P.rowwise().sum(), spread = tau_half*P.cwiseAbs().rowwise().sum();
+        double margin = INFINITY;
+        Eigen::Matrix<double, 6, 1> w;
+        for(const auto &wr: wrenches)
+        {
+            for(unsigned int k = 0; k < 6; ++k)
+                w(k) = k < 3 ? wr[k] : wr[k]/length;
+            const Eigen::VectorXd proj = Em*w;
+            // h(e) - e.w and h(-e) + e.w
+            margin = std::min(margin, (spread - (proj - center).cwiseAbs()).minCoeff());
+        }
+        return margin;
+    }
+
+protected:
+    unsigned int n;
+    double tau_mid, tau_half, length;
+    std::vector<std::array<unsigned int, 5>> sets;
+    MatrixX6d E;
+    Matrix6Xd Ws;
+    Eigen::MatrixXd P;
+    Eigen::HouseholderQR<Eigen::Matrix<double, 6, 5>> qr;
+};
+
+#endif // CAPACITY_H
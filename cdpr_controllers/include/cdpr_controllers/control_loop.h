@@ -0,0 +1,55 @@
+#ifndef CONTROL_LOOP_H
+#define CONTROL_LOOP_H
+
+#include <ros/ros.h>
+#include <atomic>
+#include <functional>
+#include <string>
+
+// this class runs the control tick of a controller at a fixed rate
+// the tick runs on a dedicated thread, with optional real-time priority and CPU affinity
+// sleeps are done on absolute deadlines (CLOCK_MONOTONIC) so that the period does not drift
+// ROS callbacks are processed by a separate spinner thread: the tick never calls spinOnce()
+
+class ControlLoop
+{
+public:
+    struct Stats
+    {
+        unsigned long ticks = 0;
+        // ticks that ended after the next deadline
+        unsigned long overruns = 0;
+        // wake-up latency wrt. the deadline [s]
+        double jitter_min = 0, jitter_max = 0, jitter_mean = 0, jitter_rms = 0;
+        // execution time of the tick [s]
+        double exec_mean = 0, exec_max = 0;
+    };
+
+    // reads the settings from the private node handle:
+    //  ~rate      loop frequency [Hz], default 1/default_dt
+    //  ~priority  SCHED_FIFO priority of the control thread, 0 keeps the default scheduler
+    //  ~cpu       CPU the control thread is pinned to, -1 lets the kernel choose
+    ControlLoop(ros::NodeHandle &nh_priv, double default_dt);
+
+    inline double period() const {return dt;}
+
+    // calls tick() every period until ros::ok() is false or stop() is called
+    // returns when the control thread has finished
+    void run(std::function<void()> tick);
+    inline void stop() {running = false;}
+
+    // only consistent once run() has returned
+    inline const Stats& stats() const {return stats_;}
+    void printStats() const;
+
+protected:
+    double dt;
+    int priority, cpu;
+    std::atomic<bool> running;
+    Stats stats_;
+
+    void configureThread();
+    void loop(std::function<void()> &tick);
+};
+
+#endif // CONTROL_LOOP_H
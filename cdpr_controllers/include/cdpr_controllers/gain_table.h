@@ -0,0 +1,51 @@
+#ifndef GAIN_TABLE_H
+#define GAIN_TABLE_H
+
+#include <cdpr/grid_map.h>
+#include <visp/vpColVector.h>
+#include <string>
+#include <vector>
+
+// Cartesian gains scheduled over the platform position, at the home orientation
+// the table is computed offline by the gain_table tool and memory-mapped by the controller
+// fields per cell: Kp and Kd on the 6 axes of the world frame, then the tension margin [N] of the static wrench
+
+class GainTable
+{
+public:
+    enum {KP = 0, KD = 6, MARGIN = 12, FIELDS = 13};
+
+    static std::vector<std::string> fieldNames()
+    {
+        return {"Kp_x", "Kp_y", "Kp_z", "Kp_rx", "Kp_ry", "Kp_rz",
+                "Kd_x", "Kd_y", "Kd_z", "Kd_rx", "Kd_ry", "Kd_rz", "margin"};
+    }
+
+    explicit GainTable(const std::string &file) : grid(file)
+    {
+        valid = grid.ok() && grid.names() == fieldNames();
+    }
+
+    inline bool ok() const {return valid;}
+
+    // gains at this position, clamped to the table, does not allocate
+    // returns false if the position is outside the table
+    inline bool lookup(double x, double y, double z, vpColVector &Kp, vpColVector &Kd, double &margin)
+    {
+        const bool inside = grid.interpolate(x, y, z, values);
+        for(unsigned int i = 0; i < 6; ++i)
+        {
+            Kp[i] = values[KP+i];
+            Kd[i] = values[KD+i];
+        }
+        margin = values[MARGIN];
+        return inside;
+    }
+
+protected:
+    GridMap grid;
+    bool valid;
+    double values[FIELDS];
+};
+
+#endif // GAIN_TABLE_H
@@ -0,0 +1,48 @@
+#ifndef LIVE_PARAMS_H
+#define LIVE_PARAMS_H
+
+#include <atomic>
+
+// value written by a ROS callback and read by the control thread
+// triple buffering: neither side ever waits for the other
+//  - set() writes in a back buffer and publishes it
+//  - update() is called by the control thread between two ticks and picks the latest published value
+// the value seen by the control thread does not change during a tick
+
+template <class T>
+class LiveParam
+{
+public:
+    explicit LiveParam(const T &init = T()) : front(0), back(2), middle(1)
+    {
+        for(auto &value: buf)
+            value = init;
+    }
+
+    // writer side
+    void set(const T &value)
+    {
+        buf[back] = value;
+        back = middle.exchange(back | DIRTY, std::memory_order_acq_rel) & INDEX;
+    }
+
+    // reader side, returns true if a new value has been published since the last call
+    bool update()
+    {
+        if(!(middle.load(std::memory_order_relaxed) & DIRTY))
+            return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    inline const T& get() const {return buf[front];}
+    inline const T* operator->() const {return &buf[front];}
+
+protected:
+    static const unsigned char INDEX = 3, DIRTY = 4;
+    T buf[3];
+    unsigned char front, back;
+    std::atomic<unsigned char> middle;
+};
+
+#endif // LIVE_PARAMS_H
@@ -0,0 +1,318 @@
+#ifndef LP_H
+#define LP_H
+
+#include <visp/vpMatrix.h>
+#include <visp/vpColVector.h>
+#include <cmath>
+#include <vector>
+
+namespace solve_lp
+{
+
+using std::vector;
+
+/* Solves a linear program with a dense two-phase simplex (Bland's rule against cycling)
+ * max_x c.x
+ * st. C.x <= d
+ * st. x >= 0
+ * returns false if the problem is infeasible or unbounded, value is then -inf or +inf
+ * also false (value -inf) if the iteration cap is reached
+ */
+inline bool solveLP(const vpColVector &c, const vpMatrix &C, const vpColVector &d, vpColVector &x, double &value)
+{
+    const double eps = 1e-9;
+    const int m = C.getRows(), n = c.getRows();
+
+    // tableau, last column is the right-hand side, row m is the objective, row m+1 the phase-1 objective
+    vpMatrix D(m+2, n+2);
+    vector<int> B(m), N(n+1);
+    for(int i = 0; i < m; ++i)
+    {
+        for(int j = 0; j < n; ++j)
+            D[i][j] = C[i][j];
+        B[i] = n+i;
+        D[i][n] = -1;
+        D[i][n+1] = d[i];
+    }
+    for(int j = 0; j < n; ++j)
+    {
+        N[j] = j;
+        D[m][j] = -c[j];
+    }
+    N[n] = -1;
+    D[m+1][n] = 1;
+
+    auto pivot = [&](int r, int s)
+    {
+        const double inv = 1./D[r][s];
+        for(int i = 0; i < m+2; ++i)
+            if(i != r && D[i][s] != 0)
+                for(int j = 0; j < n+2; ++j)
+                    if(j != s)
+                        D[i][j] -= D[r][j]*D[i][s]*inv;
+        for(int j = 0; j < n+2; ++j)
+            if(j != s)
+                D[r][j] *= inv;
+        for(int i = 0; i < m+2; ++i)
+            if(i != r)
+                D[i][s] *= -inv;
+        D[r][s] = inv;
+        std::swap(B[r], N[s]);
+    };
+
+    // the equality constraints make the problems degenerate, Bland's rule guarantees termination
+    // the iteration cap only guards against numerical trouble
+    const int max_iterations = 50*(m+n) + 1000;
+    int iterations = 0;
+    bool stalled = false;
+    auto simplex = [&](int phase)
+    {
+        const int obj = phase == 1 ? m+1 : m;
+        while(true)
+        {
+            // entering: lowest index with a negative reduced cost
+            int s = -1;
+            for(int j = 0; j <= n; ++j)
+            {
+                if(phase == 2 && N[j] == -1)
+                    continue;
+                if(D[obj][j] < -eps && (s == -1 || N[j] < N[s]))
+                    s = j;
+            }
+            if(s == -1)
+                return true;
+            if(++iterations > max_iterations)
+            {
+                stalled = true;
+                return false;
+            }
+            // leaving: smallest ratio, lowest index on ties
+            int r = -1;
+            for(int i = 0; i < m; ++i)
+            {
+                if(D[i][s] < eps)
+                    continue;
+                if(r == -1)
+                    r = i;
+                else
+                {
+                    const double ri = D[i][n+1]/D[i][s], rr = D[r][n+1]/D[r][s];
+                    if(ri < rr || (ri == rr && B[i] < B[r]))
+                        r = i;
+                }
+            }
+            if(r == -1)
+                return false;
+            pivot(r, s);
+        }
+    };
+
+    x.resize(n);
+    // phase 1 if the origin is not feasible
+    int r = 0;
+    for(int i = 1; i < m; ++i)
+        if(D[i][n+1] < D[r][n+1])
+            r = i;
+    if(m && D[r][n+1] < -eps)
+    {
+        pivot(r, n);
+        if(!simplex(1) || D[m+1][n+1] < -eps)
+        {
+            value = -INFINITY;
+            return false;
+        }
+        for(int i = 0; i < m; ++i)
+            if(B[i] == -1)
+            {
+                int s = -1;
+                for(int j = 0; j <= n; ++j)
+                    if(s == -1 || D[i][j] < D[i][s] || (D[i][j] == D[i][s] && N[j] < N[s]))
+                        s = j;
+                pivot(i, s);
+            }
+    }
+    if(!simplex(2))
+    {
+        value = stalled ? -INFINITY : INFINITY;
+        return false;
+    }
+    for(int i = 0; i < m; ++i)
+        if(B[i] < n)
+            x[B[i]] = D[i][n+1];
+    value = D[m][n+1];
+    return true;
+}
+
+/* Same with equality constraints
+ * max_x c.x
+ * st. A.x = b
+ * st. C.x <= d
+ * st. x >= 0
+ */
+inline bool solveLP(const vpColVector &c, const vpMatrix &A, const vpColVector &b, const vpMatrix &C, const vpColVector &d,
+                    vpColVector &x, double &value)
+{
+    // A.x = b as A.x <= b and -A.x <= -b
+    const unsigned int n = c.getRows(), me = A.getRows(), mi = C.getRows();
+    vpMatrix Ci(2*me+mi, n);
+    vpColVector di(2*me+mi);
+    for(unsigned int i = 0; i < me; ++i)
+    {
+        for(unsigned int j = 0; j < n; ++j)
+        {
+            Ci[i][j] = A[i][j];
+            Ci[i+me][j] = -A[i][j];
+        }
+        di[i] = b[i];
+        di[i+me] = -b[i];
+    }
+    for(unsigned int i = 0; i < mi; ++i)
+    {
+        for(unsigned int j = 0; j < n; ++j)
+            Ci[2*me+i][j] = C[i][j];
+        di[2*me+i] = d[i];
+    }
+    return solveLP(c, Ci, di, x, value);
+}
+
+/* Tension margin of a wrench: largest t such that some tau gives W.tau = w with tau_min + t <= tau <= tau_max - t
+ * negative if w cannot be generated within the bounds, tau is then not changed
+ */
+inline double tensionMargin(const vpMatrix &W, const vpColVector &w, double tau_min, double tau_max, vpColVector &tau)
+{
+    // tau = tau_min + t + y, y >= 0, t >= 0
+    const unsigned int n = W.getCols();
+    vpMatrix A(6, n+1), C(n, n+1);
+    vpColVector b(6), d(n), c(n+1), x;
+    for(unsigned int i = 0; i < 6; ++i)
+    {
+        double sum = 0;
+        for(unsigned int j = 0; j < n; ++j)
+        {
+            A[i][j] = W[i][j];
+            sum += W[i][j];
+        }
+        A[i][n] = sum;
+        b[i] = w[i] - tau_min*sum;
+    }
+    for(unsigned int j = 0; j < n; ++j)
+    {
+        C[j][j] = 1;
+        C[j][n] = 2;
+        d[j] = tau_max - tau_min;
+    }
+    c[n] = 1;
+    double t;
+    if(!solveLP(c, A, b, C, d, x, t))
+        return -1;
+    tau.resize(n, false);
+    for(unsigned int j = 0; j < n; ++j)
+        tau[j] = tau_min + t + x[j];
+    return t;
+}
+
+inline double tensionMargin(const vpMatrix &W, const vpColVector &w, double tau_min, double tau_max)
+{
+    vpColVector tau;
+    return tensionMargin(W, w, tau_min, tau_max, tau);
+}
+
+/* Wrench capacity along a direction: largest s >= 0 such that some tau gives W.tau = w + s.dir with tau_min <= tau <= tau_max
+ * negative if there is none, check that w is feasible with tensionMargin
+ */
+inline double wrenchCapacity(const vpMatrix &W, const vpColVector &w, const vpColVector &dir, double tau_min, double tau_max)
+{
+    // tau = tau_min + y, y >= 0, s >= 0
+    const unsigned int n = W.getCols();
+    vpMatrix A(6, n+1), C(n, n+1);
+    vpColVector b(6), d(n), c(n+1), x;
+    for(unsigned int i = 0; i < 6; ++i)
+    {
+        double sum = 0;
+        for(unsigned int j = 0; j < n; ++j)
+        {
+            A[i][j] = W[i][j];
+            sum += W[i][j];
+        }
+        A[i][n] = -dir[i];
+        b[i] = w[i] - tau_min*sum;
+    }
+    for(unsigned int j = 0; j < n; ++j)
+    {
+        C[j][j] = 1;
+        d[j] = tau_max - tau_min;
+    }
+    c[n] = 1;
+    double s;
+    if(solveLP(c, A, b, C, d, x, s))
+        return s;
+    return -1;
+}
+
+/* Tension factor of a wrench: largest min(tau)/max(tau) such that W.tau = w with tau_min <= tau <= tau_max
+ * 1 for evenly loaded cables, close to 0 when a cable is almost slack compared to the others
+ * negative if w cannot be generated within the bounds
+ * fractional program solved with Dinkelbach iterations: max t - r.s st. t <= tau <= s, then r = min(tau)/max(tau)
+ */
+inline double tensionFactor(const vpMatrix &W, const vpColVector &w, double tau_min, double tau_max, vpColVector &tau)
+{
+    // tau = tau_min + y, y >= 0, then t and s
+    const unsigned int n = W.getCols();
+    vpMatrix A(6, n+2), C(3*n, n+2);
+    vpColVector b(6), d(3*n), c(n+2), x;
+    for(unsigned int i = 0; i < 6; ++i)
+    {
+        double sum = 0;
+        for(unsigned int j = 0; j < n; ++j)
+        {
+            A[i][j] = W[i][j];
+            sum += W[i][j];
+        }
+        b[i] = w[i] - tau_min*sum;
+    }
+    for(unsigned int j = 0; j < n; ++j)
+    {
+        C[j][j] = 1;
+        d[j] = tau_max - tau_min;
+        // t - y_j <= tau_min
+        C[n+j][n] = 1;
+        C[n+j][j] = -1;
+        d[n+j] = tau_min;
+        // y_j - s <= -tau_min
+        C[2*n+j][j] = 1;
+        C[2*n+j][n+1] = -1;
+        d[2*n+j] = -tau_min;
+    }
+    double r = 0, value;
+    for(unsigned int it = 0; it < 20; ++it)
+    {
+        c[n] = 1;
+        c[n+1] = -r;
+        if(!solveLP(c, A, b, C, d, x, value))
+            return -1;
+        double lo = INFINITY, hi = 0;
+        for(unsigned int j = 0; j < n; ++j)
+        {
+            lo = std::min(lo, tau_min + x[j]);
+            hi = std::max(hi, tau_min + x[j]);
+        }
+        const double r_new = hi > 0 ? lo/hi : 0;
+        tau.resize(n, false);
+        for(unsigned int j = 0; j < n; ++j)
+            tau[j] = tau_min + x[j];
+        if(value <= 1e-9*tau_max || r_new <= r + 1e-9)
+            return std::max(r, r_new);
+        r = r_new;
+    }
+    return r;
+}
+
+inline double tensionFactor(const vpMatrix &W, const vpColVector &w, double tau_min, double tau_max)
+{
+    vpColVector tau;
+    return tensionFactor(W, w, tau_min, tau_max, tau);
+}
+
+}
+
+#endif
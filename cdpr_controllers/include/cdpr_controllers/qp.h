@@ -4,6 +4,7 @@
 #include <visp/vpSubColVector.h>
 #include <visp/vpSubMatrix.h>
 #include <algorithm>
+#include <cdpr/log.h>
 
 namespace solve_qp
 {
@@ -16,7 +17,7 @@ using std::vector;
  * min_x ||Q.x - r||^2
  * st. A.x = b
  */
-void solveQPe ( const vpMatrix &_Q, const vpColVector _r, const vpMatrix &_A, const vpColVector &_b, vpColVector &_x)
+inline void solveQPe ( const vpMatrix &_Q, const vpColVector _r, const vpMatrix &_A, const vpColVector &_b, vpColVector &_x)
 {
     vpMatrix _Ap = _A.pseudoInverse();
     vpColVector x1 = _Ap * _b;
@@ -32,7 +33,7 @@ void solveQPe ( const vpMatrix &_Q, const vpColVector _r, const vpMatrix &_A, co
  * st. A.x = b
  * st. C.x <= d
  */
-void solveQP ( const vpMatrix &_Q, const vpColVector _r, vpMatrix _A, vpColVector _b, const vpMatrix &_C, const vpColVector &_d, vpColVector &_x, std::vector<bool> &active)
+inline void solveQP ( const vpMatrix &_Q, const vpColVector _r, vpMatrix _A, vpColVector _b, const vpMatrix &_C, const vpColVector &_d, vpColVector &_x, std::vector<bool> &active)
 {
     // check data coherence
     const unsigned int n = _Q.getCols();
@@ -42,10 +43,10 @@ void solveQP ( const vpMatrix &_Q, const vpColVector _r, vpMatrix _A, vpColVecto
             _C.getRows() != _d.getRows() ||
             _Q.getRows() != _r.getRows())
     {
-        cout << "solveQP: wrong dimension" << endl <<
-                "Q: " << _Q.getRows() << "x" << _Q.getCols() << " - r: " << _r.getRows() << endl <<
-                "A: " << _A.getRows() << "x" << _A.getCols() << " - b: " << _b.getRows() << endl <<
-                "C: " << _C.getRows() << "x" << _C.getCols() << " - d: " << _d.getRows() << endl;
+        CDPR_ERROR("solveQP: wrong dimension" <<
+                   " - Q: " << _Q.getRows() << "x" << _Q.getCols() << " - r: " << _r.getRows() <<
+                   " - A: " << _A.getRows() << "x" << _A.getCols() << " - b: " << _b.getRows() <<
+                   " - C: " << _C.getRows() << "x" << _C.getCols() << " - d: " << _d.getRows());
         return;
     }
 
@@ -137,7 +138,7 @@ void solveQP ( const vpMatrix &_Q, const vpColVector _r, vpMatrix _A, vpColVecto
                 //cout<< "the difference in QP:"<<"    "<< cons << endl;
                 if(cons.getMaxValue() - cons.getMinValue() > 1e-6)
                 {
-                    cout << "--------------------------------------------------QP seems infeasible----------------------------------------------------\n";
+                    CDPR_WARN("solveQP: QP seems infeasible");
                     x.resize(0);
                     return;
                 }
@@ -235,7 +236,7 @@ void solveQP ( const vpMatrix &_Q, const vpColVector _r, vpMatrix _A, vpColVecto
  * min_x ||Q.x - r||^2
  * st. C.x <= d
  */
-void solveQPi ( const vpMatrix &Q, const vpColVector r, vpMatrix C, const vpColVector &d, vpColVector &x, std::vector<bool> &active)
+inline void solveQPi ( const vpMatrix &Q, const vpColVector r, vpMatrix C, const vpColVector &d, vpColVector &x, std::vector<bool> &active)
 {
     vpMatrix A ( 0,Q.getCols() );
     vpColVector b ( 0 );
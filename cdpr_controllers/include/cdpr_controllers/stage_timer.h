@@ -0,0 +1,93 @@
+#ifndef STAGE_TIMER_H
+#define STAGE_TIMER_H
+
+#include <ros/ros.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// timing of the stages of a control tick
+// the tick calls start() then stage(i) at the end of each stage, durations are measured with steady_clock
+// each stage keeps a log2 histogram of its durations, updated without locks from the control thread
+// a summary is published on /diagnostics (diagnostic_msgs/DiagnosticArray) by a timer of the ROS spinner
+
+class StageTimer
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    // budget: expected duration of a whole tick [s], the diagnostic is WARN when the p99 of the tick is above
+    StageTimer(ros::NodeHandle &nh, const std::string &name, const std::vector<std::string> &stages,
+               double budget, double publish_period = 1.);
+
+    inline void start()
+    {
+        tick_start = stage_start = Clock::now();
+    }
+
+    // end of stage i, the next stage starts now
+    inline void stage(unsigned int i)
+    {
+        const Clock::time_point now = Clock::now();
+        record(stats[i], now - stage_start);
+        stage_start = now;
+    }
+
+    // end of the tick, records the total duration
+    inline void end()
+    {
+        record(stats.back(), Clock::now() - tick_start);
+    }
+
+    // last duration of stage i [s]
+    inline double last(unsigned int i) const
+    {
+        return 1e-9*stats[i].last.load(std::memory_order_relaxed);
+    }
+
+    // prints the summary of all stages
+    void print() const;
+
+protected:
+    // bin b counts durations in [2^(b-1), 2^b) ns
+    static const unsigned int BINS = 40;
+
+    struct Stats
+    {
+        std::string name;
+        std::atomic<unsigned long> bins[BINS];
+        std::atomic<unsigned long> count, sum, max, window_max, last;
+    };
+
+    std::string name;
+    double budget;
+    // one per stage, then the whole tick
+    std::vector<Stats> stats;
+    Clock::time_point tick_start, stage_start;
+
+    ros::Publisher pub;
+    ros::WallTimer timer;
+
+    static inline void record(Stats &s, Clock::duration d)
+    {
+        const unsigned long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+        const unsigned int bin = ns ? std::min<unsigned int>(64 - __builtin_clzl(ns), BINS-1) : 0;
+        s.bins[bin].fetch_add(1, std::memory_order_relaxed);
+        s.count.fetch_add(1, std::memory_order_relaxed);
+        s.sum.fetch_add(ns, std::memory_order_relaxed);
+        s.last.store(ns, std::memory_order_relaxed);
+        if(ns > s.max.load(std::memory_order_relaxed))
+            s.max.store(ns, std::memory_order_relaxed);
+        unsigned long wmax = s.window_max.load(std::memory_order_relaxed);
+        while(ns > wmax && !s.window_max.compare_exchange_weak(wmax, ns, std::memory_order_relaxed)) {}
+    }
+
+    // upper bound of the q-quantile [ns] from the histogram
+    static double quantile(const Stats &s, double q);
+
+    void publish(const ros::WallTimerEvent &);
+};
+
+#endif // STAGE_TIMER_H
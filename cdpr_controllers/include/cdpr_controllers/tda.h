@@ -25,6 +25,9 @@ public:
    
     TDA(CDPR &robot, ros::NodeHandle &_nh, minType _control, bool warm_start = false);
 
+    // type from its name in the "control" parameter, returns false if unknown
+    static bool FromName(const std::string &name, minType &type);
+
     // will look for a solution in [tau +- dTau_max]
     void ForceContinuity(double _dTau_max) {dTau_max = _dTau_max;}
      void Weighing(double lambda){ _lambda = lambda;}
@@ -0,0 +1,130 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <visp/vpColVector.h>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+// binary telemetry recorder for the control loops
+// same usage as log2plot::Logger: register a time variable and some vectors, call start() before the control loop,
+// then update() at each tick
+//
+// update() only copies the registered vectors into a preallocated ring buffer, it never blocks nor allocates
+// a background thread appends the records to a memory-mapped file that grows by chunks
+//
+// file layout (native endianness):
+//  - header: TelemetryHeader followed by the channel descriptors, padded to a page
+//  - records: time followed by all channels, as doubles
+// the files are read with TelemetryReader, see telemetry_to_yaml and telemetry_stats
+
+namespace telemetry
+{
+
+const char MAGIC[8] = {'C','D','P','R','T','L','M','\0'};
+const uint32_t VERSION = 1;
+
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t channels;
+    uint32_t record_size;   // bytes
+    uint32_t header_size;   // bytes, offset of the first record
+    uint64_t records;       // records written so far
+    uint64_t dropped;       // records lost because the buffer was full
+};
+
+struct Channel
+{
+    std::string name, legend, ylabel;
+    unsigned int dim;       // number of values
+    unsigned int offset;    // position in the record, in doubles (time is at 0)
+};
+
+}
+
+class Telemetry
+{
+public:
+    // records are kept in memory until the writer thread stores them, buffer_size records at most
+    explicit Telemetry(const std::string &file, unsigned int buffer_size = 4096);
+    ~Telemetry();
+
+    inline void setTime(double &t) {time = &t;}
+
+    // registers a vector, its dimension is fixed by start()
+    // legend and ylabel follow log2plot conventions
+    void save(vpArray2D<double> &v, const std::string &name, const std::string &legend, const std::string &ylabel);
+
+    // creates the file and starts the writer thread, false if the file cannot be created
+    bool start();
+
+    // copies the current values of all vectors, called from the control thread
+    // does nothing before start() or if it failed
+    void update();
+
+    // writes the pending records and closes the file
+    void close();
+
+    inline const std::string& file() const {return filename;}
+    inline unsigned long dropped() const {return n_dropped;}
+
+protected:
+    std::string filename;
+    double *time;
+    std::vector<vpArray2D<double>*> vectors;
+    std::vector<telemetry::Channel> channels;
+
+    // ring buffer, single producer (update) and single consumer (writer thread)
+    unsigned int capacity, record_doubles;
+    std::vector<double> buffer;
+    std::atomic<unsigned long> head, tail;
+    std::atomic<unsigned long> n_dropped;
+
+    // file
+    int fd;
+    telemetry::Header* header;
+    size_t header_size, chunk_size;
+    char* chunk;
+    unsigned long chunk_index, chunk_records, written;
+
+    bool started;
+    std::atomic<bool> running;
+    std::thread writer;
+
+    bool open();
+    bool mapChunk();
+    bool drain();
+    void writerLoop();
+};
+
+// read-only access to a telemetry file
+class TelemetryReader
+{
+public:
+    explicit TelemetryReader(const std::string &file);
+    ~TelemetryReader();
+
+    inline bool ok() const {return data != nullptr;}
+    inline const std::vector<telemetry::Channel>& channels() const {return channels_;}
+    // index of a channel, -1 if not found
+    int channel(const std::string &name) const;
+
+    inline unsigned long records() const {return n_records;}
+    inline unsigned long dropped() const {return n_dropped;}
+    // time followed by all channels
+    inline const double* record(unsigned long i) const {return first + i*record_doubles;}
+
+protected:
+    std::vector<telemetry::Channel> channels_;
+    char* data;
+    size_t size;
+    const double* first;
+    unsigned long n_records, n_dropped;
+    unsigned int record_doubles;
+};
+
+#endif // TELEMETRY_H
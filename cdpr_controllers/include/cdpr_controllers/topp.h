@@ -0,0 +1,147 @@
+#ifndef TOPP_H
+#define TOPP_H
+
+#include <cdpr_controllers/lp.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// time-optimal parameterization of a path with feasible cable tensions, by reachability analysis (TOPP-RA)
+// the path q(s) is sampled at stages s_0 < ... < s_N, with x = sdot^2 and u = sddot the wrench along the path is
+//      w = a.u + b.x + c       (a = M.q', b = M.q'' + Coriolis term of q', c = -g)
+// and must be generated by the cables: W.tau = w with tau_min <= tau <= tau_max
+// u is constant between two stages, hence x_{i+1} = x_i + 2.(s_{i+1}-s_i).u_i
+
+namespace topp
+{
+
+using std::vector;
+
+struct Stage
+{
+    vpMatrix W;             // structure matrix in world frame
+    vpColVector a, b, c;
+    double x_max;           // from the velocity limits, 0 to stop at this stage
+};
+
+enum Objective {MAX_X, MIN_X, MAX_U};
+
+/* One stage: feasible (x, u) with x + 2.ds.u in [lo, hi]
+ * maximizes or minimizes x, or maximizes u for the given x
+ */
+inline bool solveStage(const Stage &stage, double ds, double lo, double hi, double tau_min, double tau_max,
+                       Objective objective, double &x, double &u)
+{
+    // z = (x, u+, u-, y) >= 0 with u = u+ - u- and tau = tau_min + y
+    const unsigned int n = stage.W.getCols(), m = n+3;
+    const bool fixed = objective == MAX_U;
+    vpMatrix A(fixed ? 7 : 6, m), C(n+3, m);
+    vpColVector b(A.getRows()), d(n+3), c(m), z;
+    for(unsigned int i = 0; i < 6; ++i)
+    {
+        double sum = 0;
+        A[i][0] = -stage.b[i];
+        A[i][1] = -stage.a[i];
+        A[i][2] = stage.a[i];
+        for(unsigned int j = 0; j < n; ++j)
+        {
+            A[i][3+j] = stage.W[i][j];
+            sum += stage.W[i][j];
+        }
+        b[i] = stage.c[i] - tau_min*sum;
+    }
+    if(fixed)
+    {
+        A[6][0] = 1;
+        b[6] = x;
+    }
+    for(unsigned int j = 0; j < n; ++j)
+    {
+        C[j][3+j] = 1;
+        d[j] = tau_max - tau_min;
+    }
+    // lo <= x + 2.ds.u <= hi
+    C[n][0] = 1; C[n][1] = 2*ds; C[n][2] = -2*ds;
+    d[n] = hi;
+    C[n+1][0] = -1; C[n+1][1] = -2*ds; C[n+1][2] = 2*ds;
+    d[n+1] = -lo;
+    C[n+2][0] = 1;
+    d[n+2] = stage.x_max;
+
+    switch(objective)
+    {
+    case MAX_X: c[0] = 1; break;
+    case MIN_X: c[0] = -1; break;
+    case MAX_U: c[1] = 1; c[2] = -1; break;
+    }
+    double value;
+    if(!solve_lp::solveLP(c, A, b, C, d, z, value))
+        return false;
+    x = z[0];
+    u = z[1] - z[2];
+    return true;
+}
+
+/* Fastest timing law along the stages, from rest to rest
+ * x and u are given at each stage, u_N = 0
+ * returns false if the path cannot be followed with feasible tensions
+ */
+inline bool parameterize(const vector<Stage> &stages, const vector<double> &s, double tau_min, double tau_max,
+                         vector<double> &x, vector<double> &u)
+{
+    const double eps = 1e-9;
+    const int N = stages.size() - 1;
+    x.assign(N+1, 0);
+    u.assign(N+1, 0);
+    if(N < 1)
+        return false;
+
+    // backward pass: controllable sets [lo, hi], ends at rest
+    vector<double> lo(N+1, 0), hi(N+1, 0);
+    double v;
+    for(int i = N-1; i >= 0; --i)
+    {
+        const double ds = s[i+1] - s[i];
+        if(!solveStage(stages[i], ds, lo[i+1], hi[i+1], tau_min, tau_max, MAX_X, hi[i], v)
+                || !solveStage(stages[i], ds, lo[i+1], hi[i+1], tau_min, tau_max, MIN_X, lo[i], v))
+            return false;
+        // round-off of the simplex
+        lo[i] = std::max(lo[i], 0.);
+        hi[i] = std::max(hi[i], lo[i]);
+    }
+    if(lo[0] > eps)
+        return false;
+
+    // forward pass: largest acceleration that stays controllable
+    for(int i = 0; i < N; ++i)
+    {
+        const double ds = s[i+1] - s[i];
+        x[i] = std::min(std::max(x[i], lo[i]), hi[i]);
+        double xi = x[i];
+        if(!solveStage(stages[i], ds, lo[i+1], hi[i+1], tau_min, tau_max, MAX_U, xi, u[i]))
+            return false;
+        x[i+1] = std::min(std::max(x[i] + 2*ds*u[i], lo[i+1]), hi[i+1]);
+        u[i] = (x[i+1] - x[i])/(2*ds);
+    }
+    return true;
+}
+
+/* Time stamps of the stages, sdot is linear in time between two stages
+ * returns false if the path stalls (x = 0 at two consecutive stages)
+ */
+inline bool timeStamps(const vector<double> &s, const vector<double> &x, vector<double> &t)
+{
+    t.assign(s.size(), 0);
+    for(unsigned int i = 0; i+1 < s.size(); ++i)
+    {
+        const double v = std::sqrt(x[i]) + std::sqrt(x[i+1]);
+        if(v <= 0)
+            return false;
+        t[i+1] = t[i] + 2*(s[i+1] - s[i])/v;
+    }
+    return true;
+}
+
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef TUNING_H
+#define TUNING_H
+
+#include <cdpr_controllers/live_params.h>
+#include <cdpr_controllers/tda.h>
+#include <cdpr_controllers/ControllerConfig.h>
+#include <dynamic_reconfigure/server.h>
+#include <memory>
+
+// gains and TDA of a running controller
+struct Tuning
+{
+    double Kp = 0, Ki = 0, Kd = 0, threshold = 0;
+    TDA::minType control = TDA::minT;
+    // null if the controller does not use a TDA
+    std::shared_ptr<TDA> tda;
+};
+
+// receives the Controller.cfg parameters from dynamic_reconfigure
+// a new TDA is built in the callback thread when its type or threshold changes,
+// the control thread picks the latest tuning with update() at the beginning of a tick and never waits
+// initial values are the private parameters Kp, Ki, Kd, control and threshold
+
+class TuningServer
+{
+public:
+    TuningServer(ros::NodeHandle &nh_priv, ros::NodeHandle &nh, CDPR &robot, bool with_tda = true);
+
+    inline bool update() {return live.update();}
+    inline const Tuning& get() const {return live.get();}
+    inline const Tuning* operator->() const {return live.operator->();}
+
+protected:
+    ros::NodeHandle nh;
+    CDPR &robot;
+    bool with_tda;
+    // last tuning given to the control thread
+    Tuning current;
+    LiveParam<Tuning> live;
+    dynamic_reconfigure::Server<cdpr_controllers::ControllerConfig> server;
+
+    void callback(cdpr_controllers::ControllerConfig &config, uint32_t level);
+};
+
+#endif // TUNING_H
@@ -1,11 +1,17 @@
 
 #include <cdpr/cdpr.h>
 #include <cdpr_controllers/qp.h>
-#include <log2plot/logger.h>
-#include <chrono>
 #include <cdpr_controllers/butterworth.h>
-#include <cdpr_controllers/tda.h>
+#include <cdpr_controllers/tuning.h>
+#include <cdpr_controllers/control_loop.h>
+#include <cdpr_controllers/telemetry.h>
+#include <cdpr_controllers/stage_timer.h>
+#include <cdpr_controllers/gain_table.h>
+#include <cdpr/workspace_map.h>
+#include <cdpr/interference.h>
+#include <cdpr/obstacles.h>
 #include <visp/vpIoTools.h>
+#include <cdpr/log.h>
 
 using namespace std;
 
@@ -20,7 +26,8 @@ using namespace std;
  * minT satisfies equality condition with feasible tensions
  */
 
-void Param(ros::NodeHandle &nh, const string &key, double &val)
+template <class T>
+void Param(ros::NodeHandle &nh, const string &key, T &val)
 {
     if(nh.hasParam(key))
         nh.getParam(key, val);
@@ -31,10 +38,10 @@ void Param(ros::NodeHandle &nh, const string &key, double &val)
 int main(int argc, char ** argv)
 {
 
-    cout.precision(3);
     // init ROS node
     ros::init(argc, argv, "cdpr_control");
     ros::NodeHandle nh, nh_priv("~");;
+    cdpr_log::setLevel(ros::param::param<std::string>("~log_level", "info"));
 
     // init CDPR class from parameter server
     CDPR robot(nh);
@@ -48,49 +55,34 @@ int main(int argc, char ** argv)
     double dTau_max = 0.5;
     bool warm_start = false;
 
-    if(nh_priv.hasParam("control"))
-        nh_priv.getParam("control", control_type);
-    if(nh_priv.hasParam("threshold"))
-        nh_priv.getParam("threshold", dTau_max);
-
-
-    TDA::minType control = TDA::minT;
-
-    if(control_type == "noMin")
-        control = TDA::noMin;
-    else if(control_type == "minT")
-        control = TDA::minT;
-    else if(control_type == "minW")
-        control = TDA::minW;
-    else if(control_type == "closed_form")
-        control = TDA::closed_form;
-    else if(control_type == "Barycenter")
-        control = TDA::Barycenter;
-    else if(control_type == "adaptive_gains")
-        control = TDA::adaptive_gains;
-    else if(control_type == "slack_v")
-        control = TDA::slack_v;
-    else if(control_type == "cvxgen_slack")
-        control = TDA::cvxgen_slack;
-    else if(control_type == "cvxgen_minT")
-        control = TDA::cvxgen_minT;
+    Param(nh_priv, "control", control_type);
+    Param(nh_priv, "threshold", dTau_max);
 
     
     // get space type
     std::string space_type="Cartesian_space";
     if (nh_priv.hasParam("s_type"))
          nh_priv.getParam("s_type", space_type);
+
+    // in joint space, the length PD may run in the Gazebo plugin: only setpoints and feedforward tensions are sent
+    bool inner_loop = false;
+    Param(nh_priv, "inner_loop", inner_loop);
+    inner_loop = inner_loop && space_type == "Joint_space";
+
+    // platform state from the observer fusing cable encoders and pose, instead of the raw pf_state
+    bool observer = false;
+    Param(nh_priv, "observer", observer);
     
     // initialization of parameters in CTC 
-    vpMatrix W(6, n), Wd(6,n), J(n,6), R_R(6,6), RR_d(6,6),  M_inertia(6,6), Kp(6,6), Kd(6,6), omega(3,3),c(3,3),Co(6,6);
-    vpColVector g(6), tau(n), err(6),  w(6), tau0(n), tau_diff(n), pd(6),residual_p(3), residual_o(3);
-    vpColVector L(n), Ld(n), Le(n),  Le_d(n), Lp(n);
-    g[2] = - robot.mass() * 9.81;
+    vpMatrix W(6, n), Wd(6,n), J(n,6), R_R(6,6), RR_d(6,6), Kp(6,6), Kd(6,6);
+    vpColVector tau(n), err(6),  w(6), tau0(n), tau_diff(n), pd(6),residual_p(3), residual_o(3);
+    vpColVector L(n), Ld(n), Le(n),  Le_d(n), Lp(n), dLd(n);
     //vpPoseVector Pd;
     vpRxyzVector rxyz;
     // set frequency of loop
-    double dt = 0.01;
-    ros::Rate loop(1/dt);
+    // control loop, rate / priority / cpu from private parameters
+    ControlLoop loop(nh_priv, 0.01);
+    const double dt = loop.period();
 
     // declare the homogeneous matrix
     vpHomogeneousMatrix M, Md;
@@ -98,21 +90,25 @@ int main(int argc, char ** argv)
     vpTranslationVector T;
 
     // set proportional and derivative gain
-    //double Kp, Kd;  // tuned for Caroca
-   if (space_type == "Cartesian_space")
-        for (int i = 0; i < 3; ++i)
+    double kp = 20, kd = 10;  // tuned for Caroca
+    if ( space_type == "Joint_space")
+        kp = kd = 1000;
+    else if (space_type != "Cartesian_space")
+        CDPR_ERROR("Gain error");
+    Param(nh_priv, "Kp", kp);
+    Param(nh_priv, "Kd", kd);
+    auto setGains = [&](double kp, double kd)
+    {
+        if ( space_type == "Joint_space")
         {
-            Kp[i][i] = 20; Kd[i][i] = 10;
-            Kp[i+3][i+3] = 20; Kd[i+3][i+3]=10;
+            Kp = kp; Kd = kd;
         }
-
-    else if ( space_type == "Joint_space")
-        Kp=Kd=1000;
-    else 
-        cout << "Gain error" << endl;
-
-    //Param(nh, "Kp", Kp);
-    //Param(nh, "Kd", Kd);
+        else
+            for (int i = 0; i < 6; ++i)
+            {
+                Kp[i][i] = kp; Kd[i][i] = kd;
+            }
+    };
     
     // declare desired parameter
     vpColVector a_d, v_d, v, v_e;
@@ -121,65 +117,149 @@ int main(int argc, char ** argv)
     v.resize(6);
     v_e.resize(6);
 
-    M_inertia[0][0]=M_inertia[1][1]=M_inertia[2][2]=robot.mass();
+    // platform dynamics in world frame, Eigen views on the 6-dim ViSP vectors
+    PlatformDynamics dynamics = robot.dynamicsModel();
+    PlatformDynamics::Matrix3d R_e;
+    typedef Eigen::Map<PlatformDynamics::Vector6d> Map6d;
     std::vector<bool> active;
 
      // variables to log
-    log2plot::Logger logger(path);
+    vpIoTools::makeDirectory(path);
+    Telemetry logger(path + "telemetry.tlm");
     double t, sumE;
     logger.setTime(t);
     vpPoseVector pose_err;
     vpThetaUVector orientation_err;
     vpTranslationVector position_err;
-    // logger.saveTimed(pose_err, "pose_err", "[x,y,z,\\theta_x,\\theta_y,\\theta_z]", "Pose error");
-    logger.saveTimed(orientation_err, "Orientation_err", "[\\theta_x,\\theta_y, \\theta_z]", "orientation error [deg]" );
-    logger.saveTimed(position_err, "Position_err", "[x, y, z]", "position error [m]");
-    logger.saveTimed(tau, "tau", "\\tau_", "cable tensions [N]");
-    logger.saveTimed(residual_p, "residualP", "residual P_", "force residual [N]");
-    logger.saveTimed(residual_o, "residualO", "residual O_", "moment residual [Nm]");
-    logger.saveTimed(tau_diff, "diff", "\\tau_d", "tensions difference [N]");
-    logger.saveTimed(v_e, "velocity_error", "Vel_", "velocity error [m/s]");
+    // logger.save(pose_err, "pose_err", "[x,y,z,\\theta_x,\\theta_y,\\theta_z]", "Pose error");
+    logger.save(orientation_err, "Orientation_err", "[\\theta_x,\\theta_y, \\theta_z]", "orientation error [deg]" );
+    logger.save(position_err, "Position_err", "[x, y, z]", "position error [m]");
+    logger.save(tau, "tau", "\\tau_", "cable tensions [N]");
+    logger.save(residual_p, "residualP", "residual P_", "force residual [N]");
+    logger.save(residual_o, "residualO", "residual O_", "moment residual [Nm]");
+    logger.save(tau_diff, "diff", "\\tau_d", "tensions difference [N]");
+    logger.save(v_e, "velocity_error", "Vel_", "velocity error [m/s]");
     if (space_type == "Joint_space" )
-        logger.saveTimed(Le, "Le", "Le_", "length error [m]");
+        logger.save(Le, "Le", "Le_", "length error [m]");
 
     // chrono
     vpColVector comp_time(1),energy(1), gains(4);
-    logger.saveTimed(comp_time, "dt", "[slack_v]", "solve time [s]");
-    logger.saveTimed(energy, "energy", "[slack_v]", "energy consumption [J]");
+    logger.save(comp_time, "dt", "[slack_v]", "solve time [s]");
+    logger.save(energy, "energy", "[slack_v]", "energy consumption [J]");
     if (control_type == "adaptive_gains")
-        logger.saveTimed(gains, "gains", "[Kp_p, Kd_p,Kp_o, Kd_o]", "adaptive gains");
+        logger.save(gains, "gains", "[Kp_p, Kd_p,Kp_o, Kd_o]", "adaptive gains");
     
-    // initialize the timekeeper 
-    std::chrono::time_point<std::chrono::system_clock> start, end;
-    std::chrono::duration<double> elapsed_seconds;
-
-    // filter for d_error (dim. 6)
-    Butterworth_nD filterP(6, 1, dt);
-    Butterworth_nD filterL(8, 1, dt);
+    // timing of the tick stages, summary published on /diagnostics
+    enum {READ, DYNAMICS, FILTER, LAW, DISTRIBUTION, PUBLISH, LOG};
+    StageTimer timer(nh, ros::this_node::getName() + ": control tick",
+                     {"read state", "dynamics", "filter", "control law", "TDA", "publish", "log"}, dt);
+
+    // filters for pose error (dim. 6) and length error (one per cable)
+    ButterworthBank<6> filterP(1, dt);
+    ButterworthBank<Eigen::Dynamic> filterL(1, dt, n);
     vpPoseVector err_;
 
-    // deliver the settings to the TDA
-    TDA tda(robot, nh, control);
-    tda.ForceContinuity(dTau_max);
+    // gains and TDA, updated through dynamic_reconfigure
+    TuningServer tuning(nh_priv, nh, robot);
+    bool adaptive = false;
+
+    // Cartesian gains scheduled over the workspace, computed offline by gain_table
+    // they override Kp / Kd when the table is given
+    std::string gain_file;
+    nh_priv.getParam("gain_table", gain_file);
+    std::unique_ptr<GainTable> schedule;
+    vpColVector kp_s(6), kd_s(6);
+    double margin = 0;
+    if(!gain_file.empty() && space_type == "Cartesian_space")
+    {
+        schedule.reset(new GainTable(gain_file));
+        if(schedule->ok())
+            CDPR_INFO("gains scheduled from " << gain_file);
+        else
+        {
+            CDPR_WARN(gain_file << " is not a gain table, using constant gains");
+            schedule.reset();
+        }
+    }
+
+    // workspace computed offline by workspace_determination, warns when the setpoint leaves it
+    std::string workspace_file;
+    nh_priv.getParam("workspace_map", workspace_file);
+    std::unique_ptr<WorkspaceMap> workspace;
+    bool setpoint_inside = true;
+    if(!workspace_file.empty())
+    {
+        workspace.reset(new WorkspaceMap(workspace_file));
+        if(workspace->ok())
+            CDPR_INFO("setpoints checked against " << workspace_file);
+        else
+        {
+            CDPR_WARN(workspace_file << " is not a workspace map");
+            workspace.reset();
+        }
+    }
+
+    // cable-cable and cable-platform clearances at the current pose, warns when the cables interfere
+    bool check_interference = false;
+    double interference_range = 0.1;
+    Param(nh_priv, "interference", check_interference);
+    Param(nh_priv, "interference_range", interference_range);
+    std::unique_ptr<Interference> interference;
+    Interference::Result contact;
+    bool clear = true;
+    vpColVector clearance(2);
+    if(check_interference)
+    {
+        interference.reset(new Interference(nh, interference_range));
+        logger.save(clearance, "clearance", "[cable, platform]", "interference clearance [m]");
+    }
+
+    // cables against the static meshes of the model, warns when one gets closer than its radius
+    bool check_obstacles = false;
+    Param(nh_priv, "obstacles", check_obstacles);
+    std::unique_ptr<Obstacles> obstacles;
+    Obstacles::Result hit;
+    bool cables_free = true;
+    vpColVector obstacle_clearance(1);
+    if(check_obstacles)
+    {
+        obstacles.reset(new Obstacles(nh));
+        if(obstacles->empty())
+        {
+            CDPR_WARN("no obstacles in the model");
+            obstacles.reset();
+        }
+        else
+            logger.save(obstacle_clearance, "obstacle_clearance", "[cable]", "obstacle clearance [m]");
+    }
 
     robot.computeLength(L);
     Lp=L;
 
-    cout << "CDPR control ready ----------------" << fixed << endl; 
-    while(ros::ok())
+    if(observer)
+        robot.enableObserver();
+
+    CDPR_INFO("CDPR control ready ----------------");
+    logger.start();
+    loop.run([&]()
     {
         //cout << "------------------" << endl;
-        //nh.getParam("Kp", Kp);
-        //nh.getParam("Kd", Kd);
+        if(tuning.update())
+        {
+            setGains(tuning->Kp, tuning->Kd);
+            adaptive = tuning->control == TDA::adaptive_gains;
+        }
+        timer.start();
         t = ros::Time::now().toSec();
+        if(observer)
+            robot.updateObserver(dt);
+        robot.updateDesired();
         robot.getPose(M);
         M.extract(T);
 
-        //start = std::chrono::system_clock::now();
-
         if(robot.ok())  // messages have been received
         {
-            cout << "messages have been received" << endl;
+            CDPR_DEBUG("messages have been received");
 
             // current poses
             robot.getPose(M);
@@ -189,14 +269,45 @@ int main(int argc, char ** argv)
             robot.getDesiredPose(Md);
             Md.extract(Rd);
             pd=vpPoseVector(Md);
+            if(workspace)
+            {
+                const bool inside = workspace->inside(Md[0][3], Md[1][3], Md[2][3]);
+                if(setpoint_inside && !inside)
+                    CDPR_WARN("desired position " << pd[0] << ", " << pd[1] << ", " << pd[2] << " is outside the workspace map");
+                setpoint_inside = inside;
+            }
+            if(interference)
+            {
+                interference->compute(M, contact);
+                clearance[0] = contact.cable;
+                clearance[1] = contact.platform;
+                if(clear && !contact.ok())
+                {
+                    if(contact.cable <= 0)
+                        CDPR_WARN("cables " << contact.pair[0] << " and " << contact.pair[1] << " interfere");
+                    if(contact.platform <= 0)
+                        CDPR_WARN("cable " << contact.cable_platform << " interferes with the platform");
+                    if(!(contact.anchor_angle > 0.01))
+                        CDPR_WARN("cables " << contact.anchor_pair[0] << " and " << contact.anchor_pair[1] << " are aligned at their anchor");
+                }
+                clear = contact.ok();
+            }
+            if(obstacles)
+            {
+                obstacles->compute(M, hit);
+                obstacle_clearance[0] = hit.clearance;
+                if(cables_free && !hit.ok())
+                    CDPR_WARN("cable " << hit.cable << " hits an obstacle (triangle " << hit.triangle << ")");
+                cables_free = hit.ok();
+            }
             vpQuaternionVector Qd,Q;
             vpThetaUVector Theta_c;
             Md.extract(Qd);
             M.extract(Theta_c);
-            cout<<" the  angle-axis angle"<< "  "<< Theta_c.t()<< endl;
+            CDPR_DEBUG(" the  angle-axis angle"<< "  "<< Theta_c.t());
             //cout<<"the desired quaternion angle"<< "  "<< Qd.t()<< endl;
             M.extract(Q);
-            cout<<" the  quaternion angle"<< "  "<< Q.t()<< endl;
+            CDPR_DEBUG(" the  quaternion angle"<< "  "<< Q.t());
 
 
             // get the desired parameters from trajectory generator
@@ -215,7 +326,7 @@ int main(int argc, char ** argv)
             err=R_R*err;
             rxyz= -1*rxyz;
             err.insert(3, rxyz);
-            cout << " Pose error:" <<"  "<<err.t() << endl;
+            CDPR_DEBUG(" Pose error:" <<"  "<<err.t());
 
             // create transformation matrix
             for(unsigned int i=0;i<3;++i)
@@ -223,87 +334,110 @@ int main(int argc, char ** argv)
                     RR_d[i][j] = RR_d[i+3][j+3] = Rd[i][j];
 
 
-            cout << " Current position:" <<"  "<<T.t() << endl;
-            cout << " Current velocity: " << "  "<<v.t()<< endl;
+            CDPR_DEBUG(" Current position:" <<"  "<<T.t());
+            CDPR_DEBUG(" Current velocity: " << "  "<<v.t());
+            timer.stage(READ);
 
-             // transform the inertia matrix to reference frame
-             M_inertia.insert((R*robot.inertia()*R.t()),3,3);
+             // mass matrix and Coriolis wrench in reference frame
+             for(unsigned int i=0;i<3;++i)
+                 for(unsigned int j=0;j<3;++j)
+                     R_e(i,j) = R[i][j];
+             dynamics.update(R_e, Map6d(v.data));
 
              // build W matrix depending on current attach points
              robot.computeW(W);
              W=R_R*W;
 
-             //construct the skew matrix
-             omega[1][0]= v[5];omega[0][1]=-v[5];
-             omega[2][0]=-v[4];omega[0][2]=v[4];
-             omega[2][1]= v[3];omega[1][2]=-v[3];
-             // Coriolis vector
-             c = omega*(R*robot.inertia()*R.t());
-             Co.insert( c ,3,3);
-
-             cout << " the Coriolis part:" <<"  "<<(Co*v).t()<< endl;
-             if ( space_type == "Cartesian_space")
-             {             
-                // compute the velocity error
-                 v_e= v_d - v;
-                 // add Butterworth filter for pose error
-                 filterP.Filter(err);
-
-                 if ( control_type == "adaptive_gains") 
-                        w = M_inertia*a_d + Co*v - g;            
-                else
-                    // establish the external wrench 
-                    w = M_inertia*(a_d+Kp*err+Kd*v_e) - g + Co*v;  
+             CDPR_DEBUG(" the Coriolis part:" <<"  "<<dynamics.coriolis().transpose());
 
-                cout << "controller in task space" << endl;              
-             }
-            else if ( space_type == "Joint_space")
-            {
+             if ( space_type == "Joint_space")
+             {
                 J=  -W.t();
                 // computation of cables length
                 robot.computeLength(L);
                 robot.computeDesiredLength(Ld);
 
-                w = M_inertia*a_d - g;
-
                 //  the desired structure matrix
                 robot.computeDesiredW(Wd);
                 // transform the structure matrix to platform space
                 Wd=RR_d*Wd;
                 //robot.sendError(err);
 
-                Le_d=  - Wd.t() *v_d- J*v;
+                dLd = - Wd.t() *v_d;
+                Le_d=  dLd - J*v;
                 Le= Ld-L;
-                filterL.Filter(Le);
+             }
+             timer.stage(DYNAMICS);
 
-                cout << "length error:" << Le.t() << endl;
+             // add Butterworth filter for pose or length error
+             if ( space_type == "Cartesian_space")
+                 filterP.Filter(err);
+             else if ( space_type == "Joint_space")
+                 filterL.Filter(Le);
+             timer.stage(FILTER);
+
+             if ( space_type == "Cartesian_space")
+             {             
+                // compute the velocity error
+                 v_e= v_d - v;
+
+                 if(schedule && !adaptive)
+                 {
+                     if(!schedule->lookup(T[0], T[1], T[2], kp_s, kd_s, margin))
+                         CDPR_DEBUG("platform outside the gain table");
+                     for (int i = 0; i < 6; ++i)
+                     {
+                         Kp[i][i] = kp_s[i]; Kd[i][i] = kd_s[i];
+                     }
+                 }
+
+                 if (adaptive)
+                        Map6d(w.data) = dynamics.wrench(Map6d(a_d.data));
+                else
+                    // establish the external wrench 
+                {
+                    vpColVector a = a_d+Kp*err+Kd*v_e;
+                    Map6d(w.data) = dynamics.wrench(Map6d(a.data));
+                }
 
-                tau=Kp*Le+Kd*Le_d;
-                w += - Wd* tau;
+                CDPR_DEBUG("controller in task space");
+             }
+            else if ( space_type == "Joint_space")
+            {
+                CDPR_DEBUG("length error:" << Le.t());
+
+                Map6d(w.data) = dynamics.inertiaWrench(Map6d(a_d.data)) - dynamics.gravity();
+                if(!inner_loop)
+                {
+                    tau=Kp*Le+Kd*Le_d;
+                    w += - Wd* tau;
+                }
                 //cout << " b: " << b.t()<< endl;
-                cout << "controller in Joint space" << endl;
+                CDPR_DEBUG("controller in Joint space");
             }
             else
-                cout << " Error: Please select the controller space type" << endl;
+                CDPR_ERROR("Please select the controller space type");
+            timer.stage(LAW);
 
-            // extract the current time
-            start = std::chrono::system_clock::now();
             // call cable tension distribution
-            if ( control_type == "adaptive_gains")
+            if (adaptive)
             {
-                v_e = M_inertia*v_e;
-                err = M_inertia*err;
-                tau = tda.ComputeDistributionG(W, v_e, err, w);
+                Map6d(v_e.data) = dynamics.inertiaWrench(Map6d(v_e.data));
+                Map6d(err.data) = dynamics.inertiaWrench(Map6d(err.data));
+                tau = tuning->tda->ComputeDistributionG(W, v_e, err, w);
             }
             else
-                tau = tda.ComputeDistribution(W, w) ;
-
-            end = std::chrono::system_clock::now();
+                tau = tuning->tda->ComputeDistribution(W, w) ;
+            timer.stage(DISTRIBUTION);
 
-            cout << "external wrench:" << "   "<< w.t() << endl;
+            CDPR_DEBUG("external wrench:" << "   "<< w.t());
 
-             // send tensions
-            robot.sendTensions(tau);
+             // send tensions, or setpoints with feedforward tensions to the plugin inner loop
+            if(inner_loop)
+                robot.sendCableSetpoint(Ld, dLd, tau);
+            else
+                robot.sendTensions(tau);
+            timer.stage(PUBLISH);
 
             if ( t < 0.06)
             {
@@ -320,14 +454,12 @@ int main(int argc, char ** argv)
                 energy[0] = -tau.t()*(L-Lp);
                 sumE+=tau.t()*(L-Lp);
                 Lp=L;
-                cout << "the total consumption energy J" << sumE<<endl;
+                CDPR_DEBUG("the total consumption energy J" << sumE);
            }
 
-            if(control_type == "adaptive_gains")
-                tda.GetGains(gains);
+            if(adaptive)
+                tuning->tda->GetGains(gains);
 
-            // calculate the computation period
-            elapsed_seconds = end-start;
             // log
             M.buildFrom( robot.getPoseError());
             pose_err.buildFrom(M.inverse());
@@ -338,9 +470,9 @@ int main(int argc, char ** argv)
                 orientation_err[i]=(pose_err[i+3]*(180/M_PI));
             }
             // computation time
-            comp_time[0] = elapsed_seconds.count();
-            if ( control_type== "adaptive_gains")
-                tda.Getresidual(residual_p,residual_o);
+            comp_time[0] = timer.last(DISTRIBUTION);
+            if (adaptive)
+                tuning->tda->Getresidual(residual_p,residual_o);
             else
             {
                 // record the wrench difference
@@ -350,10 +482,14 @@ int main(int argc, char ** argv)
          
             // update plotting vector
             logger.update();
+            timer.stage(LOG);
+            // ticks without messages would bias the tick statistics
+            timer.end();
         }
 
-        ros::spinOnce();
-        loop.sleep();
-    }
-     logger.plot();
+    });
+    loop.printStats();
+    timer.print();
+    logger.close();
+    CDPR_INFO("telemetry saved to " << logger.file() << ", convert with telemetry_to_yaml");
 }
@@ -0,0 +1,88 @@
+#include <cdpr_controllers/butterworth.h>
+#include <visp/vpColVector.h>
+#include <chrono>
+#include <iostream>
+#include <cstdlib>
+
+// compares the filtering of the cable length errors in CTC (8 cables, 1 Hz at 1 kHz)
+// with the former Butterworth_nD and with ButterworthBank, on the same noisy signal
+// usage: bench_butterworth [iterations]
+
+using namespace std;
+
+namespace
+{
+double rnd(double a = 1) {return a*(2.*rand()/RAND_MAX - 1);}
+}
+
+int main(int argc, char ** argv)
+{
+    const unsigned int N = argc > 1 ? atoi(argv[1]) : 1000000;
+    const unsigned int n = 8, samples = 1000;
+    const double frequency = 1, dt = 0.001;
+
+    // slow sine plus noise, one phase per cable
+    vector<vpColVector> signal(samples, vpColVector(n));
+    for(unsigned int k=0;k<samples;++k)
+        for(unsigned int i=0;i<n;++i)
+            signal[k][i] = 0.01*sin(2*M_PI*0.5*k*dt + i) + rnd(0.001);
+
+    // same results: outputs on the first samples, all states start from 0
+    Butterworth_nD filter_nD(n, frequency, dt);
+    ButterworthBank<8> bank(frequency, dt);
+    ButterworthBank<Eigen::Dynamic> bank_dynamic(frequency, dt, n);
+    vpColVector v_nD(n), v_bank(n), v_dynamic(n);
+    double err = 0, err_dynamic = 0;
+    for(unsigned int k=0;k<samples;++k)
+    {
+        v_nD = v_bank = v_dynamic = signal[k];
+        filter_nD.Filter(v_nD);
+        bank.Filter(v_bank);
+        bank_dynamic.Filter(v_dynamic);
+        for(unsigned int i=0;i<n;++i)
+        {
+            err = max(err, fabs(v_nD[i] - v_bank[i]));
+            err_dynamic = max(err_dynamic, fabs(v_nD[i] - v_dynamic[i]));
+        }
+    }
+
+    // time per sample, the input is copied as CTC filters in place
+    vpColVector v(n);
+    double check_nD = 0;
+    auto start = chrono::steady_clock::now();
+    for(unsigned int k=0;k<N;++k)
+    {
+        v = signal[k % samples];
+        filter_nD.Filter(v);
+        check_nD += v[0];
+    }
+    const double t_nD = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    double check_bank = 0;
+    start = chrono::steady_clock::now();
+    for(unsigned int k=0;k<N;++k)
+    {
+        v = signal[k % samples];
+        bank.Filter(v);
+        check_bank += v[0];
+    }
+    const double t_bank = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    double check_dynamic = 0;
+    start = chrono::steady_clock::now();
+    for(unsigned int k=0;k<N;++k)
+    {
+        v = signal[k % samples];
+        bank_dynamic.Filter(v);
+        check_dynamic += v[0];
+    }
+    const double t_dynamic = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << N << " samples of " << n << " channels" << endl;
+    cout << "  Butterworth_nD:              " << 1e9*t_nD/N << " ns / sample" << endl;
+    cout << "  ButterworthBank<8>:          " << 1e9*t_bank/N << " ns / sample" << endl;
+    cout << "  ButterworthBank<Dynamic>:    " << 1e9*t_dynamic/N << " ns / sample" << endl;
+    cout << "  speedup: " << t_nD/t_bank << ", max output difference: " << err << " / " << err_dynamic
+         << " (" << check_nD - check_bank << ", " << check_nD - check_dynamic << ")" << endl;
+    return 0;
+}
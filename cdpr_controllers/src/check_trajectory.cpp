@@ -0,0 +1,351 @@
+#include <cdpr/cdpr.h>
+#include <cdpr/log.h>
+#include <cdpr/workspace_map.h>
+#include <cdpr/grid_map.h>
+#include <cdpr/obstacles.h>
+#include <cdpr_controllers/lp.h>
+#include <cdpr_controllers/capacity.h>
+#include <cdpr_controllers/tda.h>
+#include <trajectory_generator/spline.h>
+#include <trajectory_generator/trajectory_file.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <thread>
+
+using namespace std;
+
+/*
+ * Feasibility pre-check of a whole trajectory before sending it to the robot
+ *
+ * The trajectory is sampled at the control rate, for each sample in parallel:
+ *  - W in world frame and the wrench w = M.a + c - g from the platform dynamics
+ *  - tension margin: how far some tension distribution for w stays from the cable limits (lp.h)
+ *  - tensions from the TDA (minW by default, gives the wrench error |W.tau - w| when w is not feasible)
+ * Time spans with a negative margin (infeasible) or a margin below `near` are reported.
+ *
+ * Needs the model on the parameter server, private parameters:
+ *  file        time-stamped samples (topp / play_trajectory format)
+ *  waypoints   or a waypoint file (waypoints node format), sampled at rate [Hz]
+ *  control     TDA (minW or minT)
+ *  near        margin threshold, fraction of the tension range
+ *  threads     0 for all cores
+ *  output      optional, per-sample results: t margin residual tau_min tau_max
+ *  workspace_map   optional, also reports the samples outside this map (workspace_determination)
+ *  stiffness_map   optional, also reports the lowest translational stiffness along the trajectory (stiffness_map)
+ *  capacity_map    optional, same for the capacity margin and the tension factor (capacity_map)
+ *  capacity    optional (bool), computes the capacity margin and the tension factor of the wrench of each sample,
+ *              moments divided by length [m], they are added to the output
+ *  obstacles   optional (bool), also reports the spans where a cable is closer than its radius to the
+ *              obstacles of the model (cdpr/obstacles.h)
+ */
+
+template <class T>
+void Param(ros::NodeHandle &nh, const string &key, T &val)
+{
+    if(nh.hasParam(key))
+        nh.getParam(key, val);
+    else
+        nh.setParam(key, val);
+}
+
+struct Result
+{
+    double margin, residual, tau_min, tau_max, capacity, factor;
+};
+
+int main(int argc, char ** argv)
+{
+    ros::init(argc, argv, "check_trajectory");
+    ros::NodeHandle nh, nh_priv("~");
+    cdpr_log::setLevel(ros::param::param<std::string>("~log_level", "info"));
+
+    CDPR robot(nh);
+    const unsigned int n = robot.n_cables();
+    double f_min, f_max;
+    robot.tensionMinMax(f_min, f_max);
+
+    string file, waypoints, output, control = "minW";
+    double rate = 100, near = 0.05;
+    int threads = 0;
+    nh_priv.getParam("file", file);
+    nh_priv.getParam("waypoints", waypoints);
+    nh_priv.getParam("output", output);
+    Param(nh_priv, "control", control);
+    Param(nh_priv, "rate", rate);
+    Param(nh_priv, "near", near);
+    Param(nh_priv, "threads", threads);
+    bool capacity = false;
+    double length = 1;
+    nh_priv.getParam("capacity", capacity);
+    Param(nh_priv, "length", length);
+    if(threads <= 0)
+        threads = max(1u, thread::hardware_concurrency());
+
+    TDA::minType tda_type;
+    if(!TDA::FromName(control, tda_type) || (tda_type != TDA::minW && tda_type != TDA::minT))
+    {
+        CDPR_ERROR("check_trajectory: control should be minW or minT, not " << control);
+        return 1;
+    }
+
+    // samples
+    vector<double> t;
+    vector<vpColVector> P, Vel, Acc;
+    string line;
+    if(file.size())
+    {
+        if(!trajectory_file::loadSamples(file, t, P, Vel, Acc, line))
+        {
+            CDPR_ERROR("check_trajectory: cannot read " << file << (line.size() ? ": " + line : ""));
+            return 1;
+        }
+    }
+    else if(waypoints.size())
+    {
+        vector<double> rpy(3, 0), tw;
+        nh.getParam("model/platform/position/rpy", rpy);
+        vector<Eigen::Vector3d> position;
+        vector<Eigen::Matrix3d> orientation;
+        PoseSpline spline;
+        if(!trajectory_file::loadWaypoints(waypoints, rpy, tw, position, orientation, line)
+                || !spline.build(tw, position, orientation))
+        {
+            CDPR_ERROR("check_trajectory: cannot read " << waypoints << (line.size() ? ": " + line : ""));
+            return 1;
+        }
+        PoseSpline::Vector6 p, v, a;
+        const unsigned int samples = ceil((spline.end() - spline.start())*rate) + 1;
+        for(unsigned int k = 0; k < samples; ++k)
+        {
+            t.push_back(min(spline.start() + k/rate, spline.end()));
+            spline.evaluate(t.back(), p, v, a);
+            vpColVector pk(6), vk(6), ak(6);
+            for(unsigned int i = 0; i < 6; ++i)
+            {
+                pk[i] = p[i]; vk[i] = v[i]; ak[i] = a[i];
+            }
+            P.push_back(pk);
+            Vel.push_back(vk);
+            Acc.push_back(ak);
+        }
+    }
+    if(t.empty())
+    {
+        CDPR_ERROR("check_trajectory: no trajectory, set ~file or ~waypoints");
+        return 1;
+    }
+
+    // one TDA per thread, they keep their own solver state
+    vector<unique_ptr<TDA>> tda;
+    for(int i = 0; i < threads; ++i)
+        tda.emplace_back(new TDA(robot, nh, tda_type));
+
+    // samples are handed out by blocks
+    const unsigned int N = t.size(), block = 64;
+    vector<Result> results(N);
+    atomic<unsigned int> next(0);
+    auto worker = [&](int id)
+    {
+        typedef Eigen::Map<PlatformDynamics::Vector6d> Map6d;
+        PlatformDynamics dynamics = robot.dynamicsModel();
+        PlatformDynamics::Matrix3d R_e;
+        vpMatrix W(6, n), R_R(6, 6);
+        vpRotationMatrix R;
+        vpColVector w(6), tau;
+        CapacityMargin capacity_margin(n, f_min, f_max, length);
+        vector<vpColVector> wrench(1);
+        for(unsigned int start = next.fetch_add(block); start < N; start = next.fetch_add(block))
+        {
+            for(unsigned int k = start; k < min(start + block, N); ++k)
+            {
+                const vpHomogeneousMatrix M(P[k][0], P[k][1], P[k][2], P[k][3], P[k][4], P[k][5]);
+                M.extract(R);
+                for(unsigned int i=0;i<3;++i)
+                    for(unsigned int j=0;j<3;++j)
+                        R_e(i,j) = R_R[i][j] = R_R[i+3][j+3] = R[i][j];
+                robot.computeW(M, W);
+                W = R_R*W;
+                dynamics.update(R_e, Map6d(Vel[k].data));
+                Map6d(w.data) = dynamics.wrench(Map6d(Acc[k].data));
+
+                Result &result = results[k];
+                result.margin = solve_lp::tensionMargin(W, w, f_min, f_max);
+                tau = tda[id]->ComputeDistribution(W, w);
+                result.residual = (W*tau - w).euclideanNorm();
+                result.tau_min = tau.getMinValue();
+                result.tau_max = tau.getMaxValue();
+                if(capacity)
+                {
+                    wrench[0] = w;
+                    result.capacity = capacity_margin.compute(W, wrench);
+                    result.factor = result.margin >= 0 ? solve_lp::tensionFactor(W, w, f_min, f_max) : 0;
+                }
+            }
+        }
+    };
+
+    const auto start = chrono::steady_clock::now();
+    vector<thread> pool;
+    for(int i = 1; i < threads; ++i)
+        pool.emplace_back(worker, i);
+    worker(0);
+    for(auto &th: pool)
+        th.join();
+    const double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // spans of infeasible (2) or near-limit (1) samples
+    const double margin_near = near*(f_max - f_min);
+    auto status = [&](unsigned int k) {return results[k].margin < 0 ? 2 : (results[k].margin < margin_near ? 1 : 0);};
+    unsigned int infeasible = 0, near_limit = 0;
+    for(unsigned int k = 0; k < N;)
+    {
+        const int s = status(k);
+        if(!s)
+        {
+            k++;
+            continue;
+        }
+        unsigned int end = k, worst = k;
+        double residual = 0;
+        while(end < N && status(end) == s)
+        {
+            if(results[end].margin < results[worst].margin)
+                worst = end;
+            residual = max(residual, results[end].residual);
+            end++;
+        }
+        if(s == 2)
+        {
+            infeasible += end - k;
+            CDPR_WARN("check_trajectory: infeasible from t = " << t[k] << " to " << t[end-1] << " s, wrench error up to "
+                      << residual << ", worst at t = " << t[worst] << " s (" << P[worst].t() << ")");
+        }
+        else
+        {
+            near_limit += end - k;
+            CDPR_INFO("check_trajectory: near the tension limits from t = " << t[k] << " to " << t[end-1]
+                      << " s, margin down to " << results[worst].margin << " N at t = " << t[worst] << " s");
+        }
+        k = end;
+    }
+
+    // constant time per sample, the map is computed at a fixed orientation
+    string workspace_file;
+    if(nh_priv.getParam("workspace_map", workspace_file))
+    {
+        WorkspaceMap workspace(workspace_file);
+        if(!workspace.ok())
+            CDPR_WARN("check_trajectory: " << workspace_file << " is not a workspace map");
+        else
+        {
+            unsigned int outside = 0;
+            for(unsigned int k = 0; k < N; ++k)
+                outside += !workspace.inside(P[k][0], P[k][1], P[k][2]);
+            if(outside)
+                CDPR_WARN("check_trajectory: " << outside << " samples outside the workspace map " << workspace_file);
+        }
+    }
+
+    if(capacity)
+    {
+        unsigned int worst_capacity = 0, worst_factor = 0;
+        for(unsigned int k = 1; k < N; ++k)
+        {
+            if(results[k].capacity < results[worst_capacity].capacity)
+                worst_capacity = k;
+            if(results[k].factor < results[worst_factor].factor)
+                worst_factor = k;
+        }
+        CDPR_INFO("check_trajectory: lowest capacity margin " << results[worst_capacity].capacity << " N at t = " << t[worst_capacity]
+                  << " s, lowest tension factor " << results[worst_factor].factor << " at t = " << t[worst_factor] << " s");
+    }
+
+    // performance maps computed offline at a fixed orientation: lowest value of a field along the trajectory
+    auto lowest = [&](const string &param, const string &field, const string &label)
+    {
+        string map_file;
+        if(!nh_priv.getParam(param, map_file))
+            return;
+        const GridMap map(map_file);
+        const int f = map.field(field);
+        if(!map.ok() || f < 0)
+        {
+            CDPR_WARN("check_trajectory: " << map_file << " has no field " << field);
+            return;
+        }
+        vector<double> values(map.fields());
+        double v_min = INFINITY;
+        unsigned int worst = 0;
+        for(unsigned int k = 0; k < N; ++k)
+            if(map.interpolate(P[k][0], P[k][1], P[k][2], values.data()) && values[f] < v_min)
+            {
+                v_min = values[f];
+                worst = k;
+            }
+        if(std::isfinite(v_min))
+            CDPR_INFO("check_trajectory: lowest " << label << " " << v_min << " at t = " << t[worst] << " s");
+    };
+    lowest("stiffness_map", "k_x_min", "translational stiffness [N/m]");
+    lowest("capacity_map", "capacity", "capacity margin from the map [N]");
+    lowest("capacity_map", "tension_factor", "tension factor from the map");
+
+    // cables against the static meshes, the whole trajectory in one batch
+    bool check_obstacles = false;
+    nh_priv.getParam("obstacles", check_obstacles);
+    if(check_obstacles)
+    {
+        const Obstacles obstacles(nh);
+        if(obstacles.empty())
+            CDPR_WARN("check_trajectory: no obstacles in the model");
+        else
+        {
+            vector<vpHomogeneousMatrix> poses(N);
+            for(unsigned int k = 0; k < N; ++k)
+                poses[k] = vpHomogeneousMatrix(P[k][0], P[k][1], P[k][2], P[k][3], P[k][4], P[k][5]);
+            vector<Obstacles::Result> contacts;
+            obstacles.compute(poses, contacts, threads);
+            for(unsigned int k = 0; k < N;)
+            {
+                if(contacts[k].ok())
+                {
+                    k++;
+                    continue;
+                }
+                unsigned int end = k, worst = k;
+                while(end < N && !contacts[end].ok())
+                {
+                    if(contacts[end].clearance < contacts[worst].clearance)
+                        worst = end;
+                    end++;
+                }
+                CDPR_WARN("check_trajectory: cable " << contacts[worst].cable << " hits an obstacle from t = " << t[k]
+                          << " to " << t[end-1] << " s, " << -contacts[worst].clearance << " m deep at t = " << t[worst] << " s");
+                k = end;
+            }
+        }
+    }
+
+    if(output.size())
+    {
+        ofstream out(output, ios::trunc);
+        out << "# t margin residual tau_min tau_max" << (capacity ? " capacity tension_factor\n" : "\n");
+        for(unsigned int k = 0; k < N; ++k)
+        {
+            out << t[k] << " " << results[k].margin << " " << results[k].residual << " "
+                << results[k].tau_min << " " << results[k].tau_max;
+            if(capacity)
+                out << " " << results[k].capacity << " " << results[k].factor;
+            out << "\n";
+        }
+    }
+
+    const double duration = t.back() - t.front();
+    CDPR_INFO("check_trajectory: " << N << " samples over " << duration << " s checked in " << elapsed << " s on "
+              << threads << " threads (" << 100*elapsed/max(duration, 1e-9) << " % of the duration), "
+              << infeasible << " infeasible, " << near_limit << " near the limits");
+    cdpr_log::flush();
+    return infeasible ? 2 : 0;
+}
@@ -0,0 +1,135 @@
+#include <cdpr_controllers/control_loop.h>
+#include <thread>
+#include <cmath>
+#include <cerrno>
+#include <cstring>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+namespace
+{
+const long NSEC = 1000000000L;
+
+inline void addNs(timespec &t, long ns)
+{
+    t.tv_nsec += ns;
+    while(t.tv_nsec >= NSEC)
+    {
+        t.tv_nsec -= NSEC;
+        t.tv_sec++;
+    }
+}
+
+// a - b in seconds
+inline double diff(const timespec &a, const timespec &b)
+{
+    return (a.tv_sec - b.tv_sec) + 1e-9*(a.tv_nsec - b.tv_nsec);
+}
+}
+
+ControlLoop::ControlLoop(ros::NodeHandle &nh_priv, double default_dt)
+    : running(false)
+{
+    double rate = 1./default_dt;
+    nh_priv.param("rate", rate, rate);
+    nh_priv.param("priority", priority, 0);
+    nh_priv.param("cpu", cpu, -1);
+    dt = 1./rate;
+}
+
+void ControlLoop::configureThread()
+{
+    if(cpu >= 0)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        const int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if(err)
+            ROS_WARN("ControlLoop: cannot pin control thread to CPU %i (%s)", cpu, strerror(err));
+    }
+
+    if(priority > 0)
+    {
+        // avoid page faults in the loop
+        if(mlockall(MCL_CURRENT | MCL_FUTURE))
+            ROS_WARN("ControlLoop: cannot lock memory (%s)", strerror(errno));
+
+        sched_param param;
+        param.sched_priority = priority;
+        const int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if(err)
+            ROS_WARN("ControlLoop: cannot set SCHED_FIFO priority %i (%s), check rtprio limits", priority, strerror(err));
+    }
+}
+
+void ControlLoop::run(std::function<void()> tick)
+{
+    // message handling runs on its own thread
+    ros::AsyncSpinner spinner(1);
+    spinner.start();
+
+    running = true;
+    std::thread control([&](){configureThread(); loop(tick);});
+    control.join();
+
+    spinner.stop();
+}
+
+void ControlLoop::loop(std::function<void()> &tick)
+{
+    const long period_ns = std::lround(dt*NSEC);
+    double jitter_sum = 0, jitter_sq = 0, exec_sum = 0;
+    stats_ = Stats();
+
+    timespec deadline, wake, end;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+    while(running && ros::ok())
+    {
+        addNs(deadline, period_ns);
+        while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR) {}
+
+        clock_gettime(CLOCK_MONOTONIC, &wake);
+        tick();
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        // statistics
+        const double jitter = diff(wake, deadline);
+        const double exec = diff(end, wake);
+        if(stats_.ticks == 0)
+            stats_.jitter_min = stats_.jitter_max = jitter;
+        stats_.jitter_min = std::min(stats_.jitter_min, jitter);
+        stats_.jitter_max = std::max(stats_.jitter_max, jitter);
+        stats_.exec_max = std::max(stats_.exec_max, exec);
+        jitter_sum += jitter;
+        jitter_sq += jitter*jitter;
+        exec_sum += exec;
+        stats_.ticks++;
+
+        // missed the next deadline: skip it instead of running late ticks back to back
+        if(diff(end, deadline) > dt)
+        {
+            stats_.overruns++;
+            while(diff(end, deadline) > dt)
+                addNs(deadline, period_ns);
+        }
+    }
+
+    if(stats_.ticks)
+    {
+        stats_.jitter_mean = jitter_sum / stats_.ticks;
+        stats_.jitter_rms = std::sqrt(jitter_sq / stats_.ticks);
+        stats_.exec_mean = exec_sum / stats_.ticks;
+    }
+}
+
+void ControlLoop::printStats() const
+{
+    ROS_INFO("ControlLoop @ %.1f Hz: %lu ticks, %lu overruns", 1./dt, stats_.ticks, stats_.overruns);
+    ROS_INFO("  jitter [us]: min %.1f, mean %.1f, rms %.1f, max %.1f",
+             1e6*stats_.jitter_min, 1e6*stats_.jitter_mean, 1e6*stats_.jitter_rms, 1e6*stats_.jitter_max);
+    ROS_INFO("  tick duration [us]: mean %.1f, max %.1f", 1e6*stats_.exec_mean, 1e6*stats_.exec_max);
+}
@@ -0,0 +1,177 @@
+#include <cdpr/cdpr.h>
+#include <cdpr/log.h>
+#include <cdpr_controllers/lp.h>
+#include <cdpr_controllers/gain_table.h>
+#include <visp/vpIoTools.h>
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+
+/*
+ * Offline computation of the gain table used by CTC (~gain_table parameter)
+ *
+ * For each position of a regular grid, at the home orientation:
+ *  - tension margin of the static wrench: how far the tensions stay from their bounds
+ *  - wrench capacity along each axis of the world frame with tensions in [f_min + safety, f_max - safety]
+ *  - Kp, Kd per axis so that the feedback acceleration Kp.e_ref + Kd.v_ref uses a given ratio of the capacity,
+ *    with Kd = 2.zeta.sqrt(Kp) and Kp in [kp_min, kp_max]
+ *
+ * Needs the model on the parameter server, private parameters:
+ *  file, step, x / y / z ([min, max], default from the frame points), e_ref, e_ref_rot, v_ref, v_ref_rot,
+ *  ratio, zeta, kp_min, kp_max, safety (fraction of the tension range)
+ */
+
+template <class T>
+void Param(ros::NodeHandle &nh, const string &key, T &val)
+{
+    if(nh.hasParam(key))
+        nh.getParam(key, val);
+    else
+        nh.setParam(key, val);
+}
+
+int main(int argc, char ** argv)
+{
+    ros::init(argc, argv, "gain_table");
+    ros::NodeHandle nh, nh_priv("~");
+    cdpr_log::setLevel(ros::param::param<std::string>("~log_level", "info"));
+
+    CDPR robot(nh);
+    const unsigned int n = robot.n_cables();
+    double f_min, f_max;
+    robot.tensionMinMax(f_min, f_max);
+
+    string file = "/home/" + vpIoTools::getUserName() + "/Results/cdpr/gain_table.grd";
+    double step = 0.25, e_ref = 0.05, e_ref_rot = 0.05, v_ref = 0.1, v_ref_rot = 0.1;
+    double ratio = 0.5, zeta = 1.1, kp_min = 5, kp_max = 80, safety = 0.05;
+    Param(nh_priv, "file", file);
+    Param(nh_priv, "step", step);
+    Param(nh_priv, "e_ref", e_ref);
+    Param(nh_priv, "e_ref_rot", e_ref_rot);
+    Param(nh_priv, "v_ref", v_ref);
+    Param(nh_priv, "v_ref_rot", v_ref_rot);
+    Param(nh_priv, "ratio", ratio);
+    Param(nh_priv, "zeta", zeta);
+    Param(nh_priv, "kp_min", kp_min);
+    Param(nh_priv, "kp_max", kp_max);
+    Param(nh_priv, "safety", safety);
+
+    // grid bounds, default to the frame points and the floor
+    vector<double> rpy;
+    nh.getParam("model/platform/position/rpy", rpy);
+    XmlRpc::XmlRpcValue points;
+    nh.getParam("model/points", points);
+    vector<double> bounds[3] = {{1e6, -1e6}, {1e6, -1e6}, {0, -1e6}};
+    for(int i = 0; i < points.size(); ++i)
+        for(unsigned int a = 0; a < 3; ++a)
+        {
+            const double v = points[i]["frame"][a];
+            bounds[a][0] = min(bounds[a][0], v);
+            bounds[a][1] = max(bounds[a][1], v);
+        }
+    Param(nh_priv, "x", bounds[0]);
+    Param(nh_priv, "y", bounds[1]);
+    Param(nh_priv, "z", bounds[2]);
+
+    unsigned int size[3];
+    double origin[3], steps[3] = {step, step, step};
+    for(unsigned int a = 0; a < 3; ++a)
+    {
+        origin[a] = bounds[a][0];
+        size[a] = max(1, int((bounds[a][1] - bounds[a][0])/step + 1e-6) + 1);
+    }
+    CDPR_INFO("gain_table: " << size[0] << " x " << size[1] << " x " << size[2] << " cells, step " << step);
+
+    // home orientation, world frame structure matrix
+    const vpRxyzVector r(rpy[0], rpy[1], rpy[2]);
+    const vpRotationMatrix R(r);
+    vpMatrix R_R(6,6);
+    for(unsigned int i=0;i<3;++i)
+        for(unsigned int j=0;j<3;++j)
+            R_R[i][j] = R_R[i+3][j+3] = R[i][j];
+
+    // static wrench w = -g and inertia per axis in world frame
+    PlatformDynamics dynamics = robot.dynamicsModel();
+    PlatformDynamics::Matrix3d R_e;
+    for(unsigned int i=0;i<3;++i)
+        for(unsigned int j=0;j<3;++j)
+            R_e(i,j) = R[i][j];
+    dynamics.update(R_e, PlatformDynamics::Vector6d::Zero());
+    vpColVector w(6);
+    for(unsigned int i=0;i<6;++i)
+        w[i] = -dynamics.gravity()(i);
+    double inertia[6];
+    for(unsigned int i=0;i<6;++i)
+        inertia[i] = dynamics.massMatrix()(i,i);
+
+    // gains from the acceleration budget: Kp.e + 2.zeta.sqrt(Kp).v = budget
+    auto gains = [&](double budget, double e, double v, double &Kp, double &Kd)
+    {
+        const double s = (-zeta*v + sqrt(zeta*zeta*v*v + e*budget))/e;
+        Kp = min(max(s*s, kp_min), kp_max);
+        Kd = 2*zeta*sqrt(Kp);
+    };
+
+    const double margin_min = safety*(f_max - f_min);
+    vector<float> data;
+    data.reserve(size[0]*size[1]*size[2]*GainTable::FIELDS);
+    vpMatrix W(6, n);
+    vpColVector dir(6);
+    vpHomogeneousMatrix M;
+    M.insert(R);
+    unsigned int feasible = 0;
+    const auto start = chrono::steady_clock::now();
+    for(unsigned int k = 0; k < size[2]; ++k)
+    {
+        for(unsigned int j = 0; j < size[1]; ++j)
+            for(unsigned int i = 0; i < size[0]; ++i)
+            {
+                M.insert(vpTranslationVector(origin[0] + i*step, origin[1] + j*step, origin[2] + k*step));
+                robot.computeW(M, W);
+                W = R_R*W;
+
+                const double margin = solve_lp::tensionMargin(W, w, f_min, f_max);
+                double Kp[6], Kd[6];
+                for(unsigned int a = 0; a < 6; ++a)
+                {
+                    double budget = 0;
+                    if(margin > margin_min)
+                    {
+                        // capacity in both directions, with the safety margin on the tensions
+                        double capacity = -1;
+                        for(int sign: {1, -1})
+                        {
+                            dir = 0;
+                            dir[a] = sign;
+                            const double c = solve_lp::wrenchCapacity(W, w, dir, f_min + margin_min, f_max - margin_min);
+                            capacity = sign == 1 ? c : min(capacity, c);
+                        }
+                        budget = ratio*max(capacity, 0.)/inertia[a];
+                    }
+                    if(a < 3)
+                        gains(budget, e_ref, v_ref, Kp[a], Kd[a]);
+                    else
+                        gains(budget, e_ref_rot, v_ref_rot, Kp[a], Kd[a]);
+                }
+                if(margin > margin_min)
+                    feasible++;
+
+                for(unsigned int a = 0; a < 6; ++a)
+                    data.push_back(Kp[a]);
+                for(unsigned int a = 0; a < 6; ++a)
+                    data.push_back(Kd[a]);
+                data.push_back(margin);
+            }
+        CDPR_INFO("gain_table: layer " << k+1 << " / " << size[2]);
+    }
+    const double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    vpIoTools::makeDirectory(vpIoTools::getParent(file));
+    const bool ok = GridMap::write(file, size, origin, steps, GainTable::fieldNames(), data);
+    if(ok)
+        CDPR_INFO("gain_table: " << feasible << " / " << data.size()/GainTable::FIELDS << " cells with margin above "
+                  << margin_min << " N, written to " << file << " in " << elapsed << " s");
+    cdpr_log::flush();
+    return ok ? 0 : 1;
+}
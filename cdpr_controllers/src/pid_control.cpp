@@ -1,10 +1,13 @@
 
 #include <ros/ros.h>
 #include <cdpr/cdpr.h>
-#include <log2plot/logger.h>
+#include <visp/vpIoTools.h>
 #include <chrono>
 #include <cdpr_controllers/butterworth.h>
-#include <cdpr_controllers/tda.h>
+#include <cdpr_controllers/tuning.h>
+#include <cdpr_controllers/control_loop.h>
+#include <cdpr_controllers/telemetry.h>
+#include <cdpr/log.h>
 
 using namespace std;
 
@@ -17,7 +20,8 @@ using namespace std;
  */
 
 
-void Param(ros::NodeHandle &nh, const string &key, double &val)
+template <class T>
+void Param(ros::NodeHandle &nh, const string &key, T &val)
 {
     if(nh.hasParam(key))
         nh.getParam(key, val);
@@ -28,10 +32,10 @@ void Param(ros::NodeHandle &nh, const string &key, double &val)
 int main(int argc, char ** argv)
 {
 
-    cout.precision(3);
     // init ROS node
     ros::init(argc, argv, "cdpr_control");
     ros::NodeHandle nh, nh_priv("~");
+    cdpr_log::setLevel(ros::param::param<std::string>("~log_level", "info"));
 
     // init CDPR class from parameter server
     CDPR robot(nh);
@@ -50,15 +54,8 @@ int main(int argc, char ** argv)
     double dTau_max = 0;
     bool warm_start = false;
 
-    if(nh_priv.hasParam("control"))
-    nh_priv.getParam("control", control_type);
-    TDA::minType control = TDA::minT;
-    if(control_type == "noMin")
-        control = TDA::noMin;
-    else if(control_type == "minT")
-        control = TDA::minT;
-    else if(control_type == "minW")
-        control = TDA::minW;
+    Param(nh_priv, "control", control_type);
+    Param(nh_priv, "threshold", dTau_max);
 
     path += control_type;
 
@@ -75,53 +72,60 @@ int main(int argc, char ** argv)
     g[2] = - robot.mass() * 9.81;
     vpMatrix R_R(6,6), W(6,n);
 
-    double dt = 0.01;
-    ros::Rate loop(1/dt);
+    // control loop, rate / priority / cpu from private parameters
+    ControlLoop loop(nh_priv, 0.01);
+    const double dt = loop.period();
     vpHomogeneousMatrix M;
     vpRotationMatrix R;
 
     // gain
     double Kp = 200, Ki = 0.1, Kd = 3;  // tuned for Caroca
-    Param(nh, "Kp", Kp);
-    Param(nh, "Ki", Ki);
-    Param(nh, "Kd", Kd);
+    Param(nh_priv, "Kp", Kp);
+    Param(nh_priv, "Ki", Ki);
+    Param(nh_priv, "Kd", Kd);
 
     // variables to log
-    log2plot::Logger logger(path + "_");
+    vpIoTools::makeDirectory(path);
+    Telemetry logger(path + "pid_telemetry.tlm");
     double t;
     logger.setTime(t);
     vpPoseVector pose_err;
     //td::string name, const std::string legend, const std::string ylabel, const bool keep_file = true)
-    logger.saveTimed(pose_err, "pose_err", "[x,y,z,\\theta_x,\\theta_y,\\theta_z]", "Pose error");
-    logger.saveTimed(tau, "tau", "\\tau_", "Tensions");
+    logger.save(pose_err, "pose_err", "[x,y,z,\\theta_x,\\theta_y,\\theta_z]", "Pose error");
+    logger.save(tau, "tau", "\\tau_", "Tensions");
     vpColVector residual(6);
-    logger.saveTimed(residual, "res", "[f_x,f_y,f_z,m_x,m_y,m_z]", "Residuals");
+    logger.save(residual, "res", "[f_x,f_y,f_z,m_x,m_y,m_z]", "Residuals");
 
     // chrono
     vpColVector comp_time(1);
-    logger.saveTimed(comp_time, "dt", "[\\delta t]", "Comp. time");
-    std::chrono::time_point<std::chrono::system_clock> start, end;
+    logger.save(comp_time, "dt", "[\\delta t]", "Comp. time");
+    std::chrono::time_point<std::chrono::steady_clock> start, end;
     std::chrono::duration<double> elapsed_seconds;
 
     // filter for d_error (dim. 6)
-    Butterworth_nD filter(6, 1, dt);
+    ButterworthBank<6> filter(1, dt);
 
-    TDA tda(robot, nh, control);
-    tda.ForceContinuity(dTau_max);
+    // gains and TDA, updated through dynamic_reconfigure
+    TuningServer tuning(nh_priv, nh, robot);
 
-    cout << "CDPR control ready" << fixed << endl;
+    CDPR_INFO("CDPR control ready");
+    logger.start();
 
-    while(ros::ok())
+    loop.run([&]()
     {
       //  cout << "------------------" << endl;
-        nh.getParam("Kp", Kp);
-        nh.getParam("Ki", Ki);
-        nh.getParam("Kd", Kd);
+        if(tuning.update())
+        {
+            Kp = tuning->Kp;
+            Ki = tuning->Ki;
+            Kd = tuning->Kd;
+        }
         t = ros::Time::now().toSec();
+        robot.updateDesired();
 
         if(robot.ok())  // messages have been received
         {
-            start = std::chrono::system_clock::now();
+            start = std::chrono::steady_clock::now();
             // current position
             robot.getPose(M);
             M.extract(R);
@@ -165,14 +169,14 @@ int main(int argc, char ** argv)
             robot.computeW(W);
 
             // call cable tension distribution
-            tau = tda.ComputeDistribution(W, w)            ;
+            tau = tuning->tda->ComputeDistribution(W, w);
 
         //    cout << "sending tensions: " << tau.t() << endl;
 
             // send tensions
             robot.sendTensions(tau);
 
-            end = std::chrono::system_clock::now();
+            end = std::chrono::steady_clock::now();
             elapsed_seconds = end-start;
             // log
             M.buildFrom( robot.getPoseError());
@@ -182,9 +186,8 @@ int main(int argc, char ** argv)
             logger.update();
         }
 
-        ros::spinOnce();
-        loop.sleep();
-    }
-
-    logger.plot();
+    });
+    loop.printStats();
+    logger.close();
+    CDPR_INFO("telemetry saved to " << logger.file() << ", convert with telemetry_to_yaml");
 }
@@ -1,6 +1,9 @@
 
 #include <cdpr/cdpr.h>
 #include <cdpr_controllers/qp.h>
+#include <cdpr_controllers/control_loop.h>
+#include <cdpr_controllers/tuning.h>
+#include <cdpr/log.h>
 
 using namespace std;
 
@@ -24,10 +27,10 @@ void Param(ros::NodeHandle &nh, const string &key, double &val)
 int main(int argc, char ** argv)
 {
 
-    cout.precision(3);
     // init ROS node
     ros::init(argc, argv, "cdpr_control");
-    ros::NodeHandle nh;
+    ros::NodeHandle nh, nh_priv("~");
+    cdpr_log::setLevel(ros::param::param<std::string>("~log_level", "info"));
 
     // init CDPR class from parameter server
     CDPR robot(nh);
@@ -38,16 +41,19 @@ int main(int argc, char ** argv)
     g[2] = - robot.mass() * 9.81;
     vpMatrix R_R(6,6);
 
-    double dt = 0.01;
-    ros::Rate loop(1/dt);
+    // control loop, rate / priority / cpu from private parameters
+    ControlLoop loop(nh_priv, 0.01);
+    const double dt = loop.period();
     vpHomogeneousMatrix M;
     vpRotationMatrix R;
 
     // gain
     double Kp = 100, Ki = 0.5, Kd = 2;  // tuned for Caroca
-    Param(nh, "Kp", Kp);
-    Param(nh, "Ki", Ki);
-    Param(nh, "Kd", Kd);
+    Param(nh_priv, "Kp", Kp);
+    Param(nh_priv, "Ki", Ki);
+    Param(nh_priv, "Kd", Kd);
+    // updated through dynamic_reconfigure
+    TuningServer tuning(nh_priv, nh, robot, false);
 
     // QP variables
     double fmin, fmax;    robot.tensionMinMax(fmin, fmax);
@@ -69,14 +75,18 @@ int main(int argc, char ** argv)
     }
     std::vector<bool> active;
 
-    cout << "CDPR control ready" << fixed << endl;
+    CDPR_INFO("CDPR control ready");
 
-    while(ros::ok())
+    loop.run([&]()
     {
-        cout << "------------------" << endl;
-        nh.getParam("Kp", Kp);
-        nh.getParam("Ki", Ki);
-        nh.getParam("Kd", Kd);
+        CDPR_DEBUG("------------------");
+        if(tuning.update())
+        {
+            Kp = tuning->Kp;
+            Ki = tuning->Ki;
+            Kd = tuning->Kd;
+        }
+        robot.updateDesired();
 
         if(robot.ok())  // messages have been received
         {
@@ -86,7 +96,7 @@ int main(int argc, char ** argv)
 
             // position error in platform frame
             err = robot.getPoseError();
-            cout << "Position error in platform frame: " << err.t() << fixed << endl;
+            CDPR_DEBUG("Position error in platform frame: " << err.t());
             for(unsigned int i=0;i<3;++i)
                 for(unsigned int j=0;j<3;++j)
                     R_R[i][j] = R_R[i+3][j+3] = R[i][j];
@@ -104,7 +114,7 @@ int main(int argc, char ** argv)
             if(err0.infinityNorm())
                tau += Kp * Kd * (err - err0)/dt;
             err0 = err;
-            cout << "Desired wrench in platform frame: " << (R_R.transpose()*(tau - g)).t() << fixed << endl;
+            CDPR_DEBUG("Desired wrench in platform frame: " << (R_R.transpose()*(tau - g)).t());
 
             // build W matrix depending on current attach points
             robot.computeW(W);
@@ -115,16 +125,15 @@ int main(int argc, char ** argv)
            solve_qp::solveQPi(W, R_R.t()*(tau-g), C, d, f, active);
 
             //f = W.pseudoInverse() * RR.transpose()* (tau - g);
-            cout << "Checking W.f+g in platform frame: " << (W*f).t() << fixed << endl;
-            cout << "sending tensions: " << f.t() << endl;
+            CDPR_DEBUG("Checking W.f+g in platform frame: " << (W*f).t());
+            CDPR_DEBUG("sending tensions: " << f.t());
 
             // send tensions
             robot.sendTensions(f);
         }
 
-        ros::spinOnce();
-        loop.sleep();
-    }
+    });
+    loop.printStats();
 
 
 
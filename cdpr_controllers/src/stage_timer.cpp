@@ -0,0 +1,86 @@
+#include <cdpr_controllers/stage_timer.h>
+#include <cdpr/log.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
+#include <cstdio>
+
+StageTimer::StageTimer(ros::NodeHandle &nh, const std::string &name, const std::vector<std::string> &stages,
+                       double budget, double publish_period)
+    : name(name), budget(budget), stats(stages.size()+1)
+{
+    for(unsigned int i = 0; i < stats.size(); ++i)
+    {
+        Stats &s = stats[i];
+        s.name = i < stages.size() ? stages[i] : "tick";
+        for(auto &bin: s.bins)
+            bin.store(0);
+        s.count = s.sum = s.max = s.window_max = s.last = 0;
+    }
+    tick_start = stage_start = Clock::now();
+
+    pub = nh.advertise<diagnostic_msgs::DiagnosticArray>("/diagnostics", 1);
+    timer = nh.createWallTimer(ros::WallDuration(publish_period), &StageTimer::publish, this);
+}
+
+double StageTimer::quantile(const Stats &s, double q)
+{
+    const unsigned long count = s.count.load(std::memory_order_relaxed);
+    unsigned long cumul = 0;
+    for(unsigned int b = 0; b < BINS; ++b)
+    {
+        cumul += s.bins[b].load(std::memory_order_relaxed);
+        if(cumul >= q*count)
+            return double(1ul << b);
+    }
+    return double(1ul << (BINS-1));
+}
+
+void StageTimer::publish(const ros::WallTimerEvent &)
+{
+    diagnostic_msgs::DiagnosticStatus status;
+    status.name = name;
+    status.hardware_id = "cdpr";
+
+    char buf[200];
+    for(auto &s: stats)
+    {
+        const unsigned long count = s.count.load(std::memory_order_relaxed);
+        if(!count)
+            continue;
+        // durations are in us, quantiles are upper bounds of their histogram bin
+        snprintf(buf, sizeof(buf), "mean %.1f, p50 < %.1f, p99 < %.1f, max %.1f, max last period %.1f",
+                 1e-3*s.sum.load(std::memory_order_relaxed)/count,
+                 1e-3*quantile(s, .5), 1e-3*quantile(s, .99),
+                 1e-3*s.max.load(std::memory_order_relaxed),
+                 1e-3*s.window_max.exchange(0, std::memory_order_relaxed));
+        diagnostic_msgs::KeyValue kv;
+        kv.key = s.name + " [us]";
+        kv.value = buf;
+        status.values.push_back(kv);
+    }
+
+    const double tick_p99 = 1e-9*quantile(stats.back(), .99);
+    status.level = tick_p99 > budget ? diagnostic_msgs::DiagnosticStatus::WARN : diagnostic_msgs::DiagnosticStatus::OK;
+    snprintf(buf, sizeof(buf), "tick p99 < %.1f us, budget %.1f us", 1e6*tick_p99, 1e6*budget);
+    status.message = buf;
+
+    diagnostic_msgs::DiagnosticArray msg;
+    msg.header.stamp = ros::Time::now();
+    msg.status.push_back(status);
+    pub.publish(msg);
+}
+
+void StageTimer::print() const
+{
+    CDPR_INFO(name << " timing [us]:");
+    for(auto &s: stats)
+    {
+        const unsigned long count = s.count.load(std::memory_order_relaxed);
+        if(!count)
+            continue;
+        char buf[200];
+        snprintf(buf, sizeof(buf), "  %-12s mean %8.1f   p50 < %8.1f   p99 < %8.1f   max %8.1f",
+                 s.name.c_str(), 1e-3*s.sum.load(std::memory_order_relaxed)/count,
+                 1e-3*quantile(s, .5), 1e-3*quantile(s, .99), 1e-3*s.max.load(std::memory_order_relaxed));
+        CDPR_INFO(buf);
+    }
+}
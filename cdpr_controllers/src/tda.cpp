@@ -1,5 +1,6 @@
 #include <cdpr_controllers/tda.h>
 #include <visp/vpIoTools.h>
+#include <cdpr/log.h>
 
 // this script is associated with TDAs 
 // note that due to the dimension problem, if run "cvxgen_minT" method, must comment "cvxgen_slack"
@@ -40,11 +41,26 @@ Workspace work;
 Settings settings;
 
 
-using std::cout;
-using std::endl;
 using std::vector;
 
 
+bool TDA::FromName(const std::string &name, minType &type)
+{
+    static const std::vector<std::pair<std::string, minType>> names = {
+        {"minW", minW}, {"minT", minT}, {"noMin", noMin}, {"closed_form", closed_form},
+        {"Barycenter", Barycenter}, {"slack_v", slack_v}, {"adaptive_gains", adaptive_gains},
+        {"cvxgen_slack", cvxgen_slack}, {"cvxgen_minT", cvxgen_minT}};
+    for(const auto &candidate: names)
+    {
+        if(candidate.first == name)
+        {
+            type = candidate.second;
+            return true;
+        }
+    }
+    return false;
+}
+
 TDA::TDA(CDPR &robot, ros::NodeHandle &_nh, minType _control, bool warm_start)
 {
     // number of cables
@@ -65,7 +81,7 @@ TDA::TDA(CDPR &robot, ros::NodeHandle &_nh, minType _control, bool warm_start)
     x.resize(n);
 
     reset_active = !warm_start;
-    cout << "reset_active" << reset_active << endl;
+    CDPR_DEBUG("reset_active" << reset_active);
     active.clear();
 
     // prepare variables
@@ -258,7 +274,7 @@ vpColVector TDA::ComputeDistribution(vpMatrix &W, vpColVector &w)
         solve_qp::solveQPi(W, w, C, d, x, active);
     else if (control == cvxgen_minT)
     {
-        cout << "cvxgen minimize tension"<<endl;
+        CDPR_DEBUG("cvxgen minimize tension");
         int num_iters;
         // for the minimize tension
         for (int i = 0; i < 64; ++i)
@@ -287,20 +303,21 @@ vpColVector TDA::ComputeDistribution(vpMatrix &W, vpColVector &w)
         set_defaults();
         setup_indexing();
         // Solve problem instance for the record. 
-        settings.verbose = 1;
+        // CVXGEN prints from the control thread, the solution is logged below instead
+        settings.verbose = 0;
         num_iters = solve();
         for (int i = 0; i < n; i++)
         {
-            printf("  %9.4f\n", vars.x[i]);
+            CDPR_DEBUG("  " << vars.x[i]);
             tau[i]=vars.x[i];
         }
-        cout<<"difference"<< (W*tau-w).t()<<endl;
+        CDPR_DEBUG("difference"<< (W*tau-w).t());
     }
 
     // slack variable by qp solver
     else if(control== slack_v)  
     {
-        cout << "Using slack variable s" << endl;
+        CDPR_DEBUG("Using slack variable s");
         vpMatrix I_s;
         vpColVector tau_star(8), w_star(6);
         I_s.eye(6);
@@ -320,15 +337,15 @@ vpColVector TDA::ComputeDistribution(vpMatrix &W, vpColVector &w)
         for (int i = 0; i < 8; ++i)
             x[i]+=tauMin;
 
-        for (int i = 8; i < 14; ++i)
-            cout << "slack variables" << x[i]<< ",";
+        CDPR_DEBUG("slack variables: " << x[8] << ", " << x[9] << ", " << x[10] << ", "
+                   << x[11] << ", " << x[12] << ", " << x[13]);
     }
 
     // closed form
     else if( control == closed_form)
     {   
         // declaration 
-        cout << "Using closed form" << endl;
+        CDPR_DEBUG("Using closed form");
         int num_r, index=0;
         vpColVector fm(n), tau_(n), w_(6);
         vpMatrix W_(6,n);
@@ -357,11 +374,11 @@ vpColVector TDA::ComputeDistribution(vpMatrix &W, vpColVector &w)
                         else if  (x[j] == x.getMaxValue() && x.getMaxValue() > tauMax)
                                 i=j;
                      }
-                    cout << "previous tensions" << "  "<<x.t()<<endl;
-                    cout << " i"<<"  "<< i <<endl;
+                    CDPR_DEBUG("previous tensions" << "  "<<x.t());
+                    CDPR_DEBUG(" i"<<"  "<< i);
                     // reduce the redundancy order
                     num_r--;
-                    cout << "number of redundancy"<<"  "<< num_r<<endl;
+                    CDPR_DEBUG("number of redundancy"<<"  "<< num_r);
                     // re- calculate the external wrench with maximal element
                     if ( x.getMaxValue() > tauMax)
                     {
@@ -373,7 +390,7 @@ vpColVector TDA::ComputeDistribution(vpMatrix &W, vpColVector &w)
                         w_= - tauMin * W_.getCol(i)+w_;
                         tau_[i]=tauMin;
                     }
-                    cout << "torque" << tau_.t() << endl;
+                    CDPR_DEBUG("torque" << tau_.t());
 
                     fm[i]=0;
 
@@ -385,7 +402,7 @@ vpColVector TDA::ComputeDistribution(vpMatrix &W, vpColVector &w)
 
                     // construct the latest TD with particular components which equal to minimum and maximum
                     x=tau_+x;
-                    cout << "tensions" << x.t() << endl;
+                    CDPR_DEBUG("tensions" << x.t());
 
                     // compute the force limit
                     f_v = x - f_m;
@@ -394,16 +411,16 @@ vpColVector TDA::ComputeDistribution(vpMatrix &W, vpColVector &w)
                     i = 0;
                 }
                 else if(num_r <0)
-                    cout << "no feasible redundancy existing" << endl;
+                    CDPR_WARN("no feasible redundancy existing");
             }
             else
-                cout << "no feasible tension distribution" << endl;
+                CDPR_WARN("no feasible tension distribution");
         }
     }
 
     else if ( control == Barycenter)
     {
-        cout << "Using Barycenter" << endl;
+        CDPR_DEBUG("Using Barycenter");
         int inter=0;
         // compute the kernel of matrix W
         W.kernel(kerW);
@@ -466,12 +483,12 @@ vpColVector TDA::ComputeDistribution(vpMatrix &W, vpColVector &w)
                 }
             }
         }
-        cout << "the total amount of intersectioni points:" <<"  "<<inter << endl;
+        CDPR_DEBUG("the total amount of intersectioni points:" <<"  "<<inter);
         // print the  satisfied vertices  number
         num_v = vertices.size();
-        cout << "number of vertex:" << "  "<<num_v<< endl;
+        CDPR_DEBUG("number of vertex:" << "  "<<num_v);
         for (int i = 0; i < vertices.size(); ++i)
-           cout << "vertex " << "  "<< vertices[i].t()<<endl;
+           CDPR_DEBUG("vertex " << "  "<< vertices[i].t());
 
         vpColVector centroid(2);
         vpColVector ver(2), CoG(2);
@@ -520,12 +537,12 @@ vpColVector TDA::ComputeDistribution(vpMatrix &W, vpColVector &w)
                 centroid /= 3*a;
             }
             x = p+ H*centroid;
-            cout << "the kernel "<< "  "<<(W*(H*centroid)).t()<<endl;
+            CDPR_DEBUG("the kernel "<< "  "<<(W*(H*centroid)).t());
              //cout << "the residual "<< "  "<<(W*x-w).t()<<endl;
-            cout << "the barycenter" << "  "<< centroid.t() << endl;
+            CDPR_DEBUG("the barycenter" << "  "<< centroid.t());
         }
         else 
-            cout << "there is no vertex existing"<< endl;
+            CDPR_WARN("there is no vertex existing");
     }
 
     //************************************************************************
@@ -533,7 +550,7 @@ vpColVector TDA::ComputeDistribution(vpMatrix &W, vpColVector &w)
     //************************************************************************
     /*else if ( control == cvxgen_slack)
     {
-        cout<< "slack variable quadratic programming using CVXGEN "<<endl;
+        CDPR_DEBUG("slack variable quadratic programming using CVXGEN ");
         vpColVector tau_star(8), w_star(6) ;
         int num_iters;
 
@@ -587,28 +604,28 @@ vpColVector TDA::ComputeDistribution(vpMatrix &W, vpColVector &w)
         set_defaults();
         setup_indexing();
         // Solve problem instance for the record. 
-        settings.verbose = 1;
+        settings.verbose = 0;
         num_iters = solve();
         for (int i = 0; i < n; i++)
         {
-            printf("  %9.4f\n", vars.x[i]);
+            CDPR_DEBUG("  " << vars.x[i]);
             x[i]=vars.x[i]+(tauMin+tauMax)/2;
         }            
     }
 */
 
     else
-        cout << "No appropriate TDA " << endl;
-   cout << "check constraints :" << endl;
+        CDPR_WARN("No appropriate TDA ");
+   CDPR_DEBUG("check constraints :");
             for(int i=0;i<n;++i)
-                cout << "   " << -d[i+n] << " < " << tau[i] << " < " << d[i] << std::endl;
+                CDPR_DEBUG("   " << -d[i+n] << " < " << tau[i] << " < " << d[i]);
     update_d = dTau_max;
     return tau;
 }
 
 vpColVector TDA::ComputeDistributionG(vpMatrix &W, vpColVector &ve, vpColVector &pe, vpColVector &w )
 {   
-    cout << " using variational gains algorithm based on quadratic problem" <<endl;
+    CDPR_DEBUG(" using variational gains algorithm based on quadratic problem");
 
     //*********************************************************
     /*
@@ -694,11 +711,11 @@ vpColVector TDA::ComputeDistributionG(vpMatrix &W, vpColVector &ve, vpColVector
     set_defaults();
     setup_indexing();
     // solve problem instance for the record. 
-    settings.verbose = 1;
+    settings.verbose = 0;
     num_iters = solve();
     for (int i = 0; i < 12; i++)
     {
-        printf("  %9.4f\n", vars.x[i]);
+        CDPR_DEBUG("  " << vars.x[i]);
         x[i]=vars.x[i];
     }
     for (int i = 0; i < 3; ++i)
@@ -708,9 +725,9 @@ vpColVector TDA::ComputeDistributionG(vpMatrix &W, vpColVector &ve, vpColVector
     }
     w_d = W*tau-w;
 */
-    cout << "check constraints :" << endl;
+    CDPR_DEBUG("check constraints :");
     for(int i=0;i<n;++i)
-        cout << "   " << -d[i+n] << " < " << tau[i] << " < " << d[i] << std::endl;
+        CDPR_DEBUG("   " << -d[i+n] << " < " << tau[i] << " < " << d[i]);
     //update_d = dTau_max;
     return tau;
 }
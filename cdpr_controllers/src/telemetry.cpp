@@ -0,0 +1,327 @@
+#include <cdpr_controllers/telemetry.h>
+#include <ros/ros.h>
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace telemetry;
+
+namespace
+{
+inline size_t roundUp(size_t size, size_t page)
+{
+    return ((size + page - 1) / page) * page;
+}
+
+void writeString(std::vector<char> &buf, const std::string &s)
+{
+    const uint16_t len = std::min<size_t>(s.size(), 65535);
+    buf.insert(buf.end(), (const char*)&len, (const char*)&len + sizeof(len));
+    buf.insert(buf.end(), s.begin(), s.begin() + len);
+}
+
+bool readString(const char* &p, const char* end, std::string &s)
+{
+    uint16_t len;
+    if(p + sizeof(len) > end)
+        return false;
+    memcpy(&len, p, sizeof(len));
+    p += sizeof(len);
+    if(p + len > end)
+        return false;
+    s.assign(p, len);
+    p += len;
+    return true;
+}
+}
+
+Telemetry::Telemetry(const std::string &file, unsigned int buffer_size)
+    : filename(file), time(nullptr), capacity(std::max(buffer_size, 2u)), record_doubles(1),
+      head(0), tail(0), n_dropped(0), fd(-1), header(nullptr), chunk(nullptr),
+      chunk_index(0), chunk_records(0), written(0), started(false), running(false)
+{}
+
+Telemetry::~Telemetry()
+{
+    close();
+}
+
+void Telemetry::save(vpArray2D<double> &v, const std::string &name, const std::string &legend, const std::string &ylabel)
+{
+    if(started)
+    {
+        ROS_WARN("Telemetry: cannot add %s after start", name.c_str());
+        return;
+    }
+    Channel channel;
+    channel.name = name;
+    channel.legend = legend;
+    channel.ylabel = ylabel;
+    channel.dim = channel.offset = 0;
+    channels.push_back(channel);
+    vectors.push_back(&v);
+}
+
+bool Telemetry::open()
+{
+    // record layout from the current dimensions
+    record_doubles = 1;
+    for(unsigned int i = 0; i < channels.size(); ++i)
+    {
+        channels[i].dim = vectors[i]->size();
+        channels[i].offset = record_doubles;
+        record_doubles += channels[i].dim;
+    }
+    const size_t record_size = record_doubles*sizeof(double);
+
+    Header h;
+    memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    h.channels = channels.size();
+    h.record_size = record_size;
+    h.records = h.dropped = 0;
+
+    std::vector<char> desc;
+    for(const auto &channel: channels)
+    {
+        const uint32_t layout[2] = {channel.dim, channel.offset};
+        desc.insert(desc.end(), (const char*)layout, (const char*)layout + sizeof(layout));
+        writeString(desc, channel.name);
+        writeString(desc, channel.legend);
+        writeString(desc, channel.ylabel);
+    }
+
+    // header and chunks are page-aligned so that they can be mapped separately
+    const size_t page = sysconf(_SC_PAGESIZE);
+    header_size = roundUp(sizeof(Header) + desc.size(), page);
+    h.header_size = header_size;
+    chunk_records = page;
+    chunk_size = chunk_records * record_size;
+
+    fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0)
+    {
+        ROS_WARN("Telemetry: cannot open %s (%s)", filename.c_str(), strerror(errno));
+        return false;
+    }
+    void *p = MAP_FAILED;
+    if(ftruncate(fd, header_size) == 0)
+        p = mmap(nullptr, header_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(p == MAP_FAILED || !mapChunk())
+    {
+        ROS_WARN("Telemetry: cannot map %s (%s)", filename.c_str(), strerror(errno));
+        if(p != MAP_FAILED)
+            munmap(p, header_size);
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    header = (Header*) p;
+    memcpy(header, &h, sizeof(h));
+    memcpy((char*)header + sizeof(h), desc.data(), desc.size());
+
+    buffer.resize(capacity * record_doubles);
+    running = true;
+    writer = std::thread(&Telemetry::writerLoop, this);
+    return true;
+}
+
+bool Telemetry::mapChunk()
+{
+    const off_t offset = header_size + chunk_index*chunk_size;
+    chunk = nullptr;
+    if(ftruncate(fd, offset + chunk_size))
+        return false;
+    void *p = mmap(nullptr, chunk_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, offset);
+    if(p == MAP_FAILED)
+        return false;
+    chunk = (char*) p;
+    return true;
+}
+
+bool Telemetry::start()
+{
+    if(started)
+        return running;
+    started = true;
+    return open();
+}
+
+void Telemetry::update()
+{
+    if(!running)
+        return;
+
+    const unsigned long h = head.load(std::memory_order_relaxed);
+    if(h - tail.load(std::memory_order_acquire) == capacity)
+    {
+        n_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    double *record = &buffer[(h % capacity)*record_doubles];
+    record[0] = time ? *time : 0;
+    for(unsigned int i = 0; i < channels.size(); ++i)
+    {
+        // a vector that was resized since the first update is truncated or padded with 0
+        const unsigned int dim = channels[i].dim;
+        const unsigned int n = std::min(vectors[i]->size(), dim);
+        double *dst = record + channels[i].offset;
+        std::copy(vectors[i]->data, vectors[i]->data + n, dst);
+        std::fill(dst + n, dst + dim, 0.);
+    }
+    head.store(h+1, std::memory_order_release);
+}
+
+bool Telemetry::drain()
+{
+    const size_t record_size = record_doubles*sizeof(double);
+    unsigned long t = tail.load(std::memory_order_relaxed);
+    const unsigned long h = head.load(std::memory_order_acquire);
+    if(t == h)
+        return false;
+    if(!chunk)
+    {
+        // the file cannot grow anymore: pending records are dropped so that update() does not see a full buffer,
+        // false so that the writer thread sleeps
+        n_dropped.fetch_add(h - t, std::memory_order_relaxed);
+        tail.store(h, std::memory_order_release);
+        header->dropped = n_dropped.load(std::memory_order_relaxed);
+        return false;
+    }
+
+    for(; t != h && chunk; ++t)
+    {
+        memcpy(chunk + (written % chunk_records)*record_size, &buffer[(t % capacity)*record_doubles], record_size);
+        tail.store(t+1, std::memory_order_release);
+        if(++written % chunk_records == 0)
+        {
+            // current chunk is full: the kernel writes it back after unmapping
+            munmap(chunk, chunk_size);
+            chunk_index++;
+            if(!mapChunk())
+                ROS_WARN("Telemetry: cannot extend %s (%s), next records are dropped", filename.c_str(), strerror(errno));
+        }
+    }
+    // readers may follow a file being written
+    __atomic_store_n(&header->records, (uint64_t)written, __ATOMIC_RELEASE);
+    header->dropped = n_dropped.load(std::memory_order_relaxed);
+    return true;
+}
+
+void Telemetry::writerLoop()
+{
+    while(running)
+    {
+        if(!drain())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    drain();
+}
+
+void Telemetry::close()
+{
+    if(fd < 0)
+        return;
+
+    running = false;
+    writer.join();
+
+    header->records = written;
+    header->dropped = n_dropped;
+    if(chunk)
+        munmap(chunk, chunk_size);
+    munmap(header, header_size);
+    if(ftruncate(fd, header_size + written*record_doubles*sizeof(double)))
+        ROS_WARN("Telemetry: cannot truncate %s (%s)", filename.c_str(), strerror(errno));
+    ::close(fd);
+    fd = -1;
+    chunk = nullptr;
+    header = nullptr;
+
+    if(n_dropped)
+        ROS_WARN("Telemetry: %lu records dropped, buffer was full", n_dropped.load());
+}
+
+TelemetryReader::TelemetryReader(const std::string &file)
+    : data(nullptr), size(0), first(nullptr), n_records(0), n_dropped(0), record_doubles(0)
+{
+    const int fd = ::open(file.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        ROS_WARN("TelemetryReader: cannot open %s (%s)", file.c_str(), strerror(errno));
+        return;
+    }
+    struct stat st;
+    if(fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(Header))
+    {
+        size = st.st_size;
+        void *p = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if(p != MAP_FAILED)
+            data = (char*) p;
+    }
+    ::close(fd);
+    if(!data)
+    {
+        ROS_WARN("TelemetryReader: cannot map %s", file.c_str());
+        return;
+    }
+
+    Header h;
+    memcpy(&h, data, sizeof(h));
+    bool valid = memcmp(h.magic, MAGIC, sizeof(MAGIC)) == 0 && h.version == VERSION
+            && h.header_size <= size && h.record_size % sizeof(double) == 0 && h.record_size;
+
+    // channel descriptors
+    const char *p = data + sizeof(Header), *end = data + std::min<size_t>(size, h.header_size);
+    for(unsigned int i = 0; valid && i < h.channels; ++i)
+    {
+        Channel channel;
+        uint32_t layout[2];
+        valid = p + sizeof(layout) <= end;
+        if(valid)
+        {
+            memcpy(layout, p, sizeof(layout));
+            p += sizeof(layout);
+            channel.dim = layout[0];
+            channel.offset = layout[1];
+            valid = readString(p, end, channel.name) && readString(p, end, channel.legend) && readString(p, end, channel.ylabel)
+                    && (channel.offset + channel.dim)*sizeof(double) <= h.record_size;
+        }
+        channels_.push_back(channel);
+    }
+
+    if(!valid)
+    {
+        ROS_WARN("TelemetryReader: %s is not a telemetry file", file.c_str());
+        munmap(data, size);
+        data = nullptr;
+        channels_.clear();
+        return;
+    }
+
+    record_doubles = h.record_size / sizeof(double);
+    first = (const double*)(data + h.header_size);
+    // the file may be longer than the records if the recorder did not close it
+    n_records = std::min<unsigned long>(h.records, (size - h.header_size) / h.record_size);
+    n_dropped = h.dropped;
+}
+
+TelemetryReader::~TelemetryReader()
+{
+    if(data)
+        munmap(data, size);
+}
+
+int TelemetryReader::channel(const std::string &name) const
+{
+    for(unsigned int i = 0; i < channels_.size(); ++i)
+        if(channels_[i].name == name)
+            return i;
+    return -1;
+}
@@ -0,0 +1,92 @@
+#include <cdpr_controllers/telemetry.h>
+#include <iostream>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+
+// statistics of the absolute values of telemetry channels, as computed by scripts/time_computation.py:
+// for each component: mean, max and standard deviation of |x|
+// for each channel: mean of the means, max of the max and std of the max over components
+// computed in one pass over the mapped file
+
+using namespace std;
+
+int main(int argc, char ** argv)
+{
+    if(argc < 2)
+    {
+        cout << "usage: " << argv[0] << " file.tlm [channel ...]" << endl;
+        cout << "  default is all channels" << endl;
+        return 1;
+    }
+
+    TelemetryReader reader(argv[1]);
+    if(!reader.ok())
+        return 1;
+
+    vector<int> selected;
+    if(argc > 2)
+    {
+        for(int i = 2; i < argc; ++i)
+        {
+            const int idx = reader.channel(argv[i]);
+            if(idx < 0)
+                cout << "no channel " << argv[i] << endl;
+            else
+                selected.push_back(idx);
+        }
+    }
+    else
+        for(unsigned int i = 0; i < reader.channels().size(); ++i)
+            selected.push_back(i);
+
+    const unsigned long n = reader.records();
+    cout << n << " records";
+    if(n)
+        cout << " from t = " << reader.record(0)[0] << " to " << reader.record(n-1)[0];
+    cout << endl;
+    if(reader.dropped())
+        cout << reader.dropped() << " records were dropped during the run" << endl;
+    if(n == 0)
+        return 0;
+
+    for(const int idx: selected)
+    {
+        const auto &channel = reader.channels()[idx];
+        const unsigned int dim = channel.dim;
+
+        // Welford for the variance
+        vector<double> mean(dim, 0), m2(dim, 0), maxi(dim, 0);
+        for(unsigned long k = 0; k < n; ++k)
+        {
+            const double *v = reader.record(k) + channel.offset;
+            for(unsigned int j = 0; j < dim; ++j)
+            {
+                const double x = fabs(v[j]);
+                const double d = x - mean[j];
+                mean[j] += d / (k+1);
+                m2[j] += d * (x - mean[j]);
+                maxi[j] = std::max(maxi[j], x);
+            }
+        }
+
+        printf("\n%s (%s)\n", channel.name.c_str(), channel.ylabel.c_str());
+        printf("  %5s %14s %14s %14s\n", "", "mean |x|", "max |x|", "std |x|");
+        for(unsigned int j = 0; j < dim; ++j)
+            printf("  %5u %14.6g %14.6g %14.6g\n", j+1, mean[j], maxi[j], sqrt(m2[j]/n));
+
+        if(dim)
+        {
+            double mean_mean = 0, mean_max = 0, var_max = 0;
+            for(unsigned int j = 0; j < dim; ++j)
+            {
+                mean_mean += mean[j] / dim;
+                mean_max += maxi[j] / dim;
+            }
+            for(unsigned int j = 0; j < dim; ++j)
+                var_max += (maxi[j] - mean_max)*(maxi[j] - mean_max) / dim;
+            printf("  all   %14.6g %14.6g %14.6g\n", mean_mean, *max_element(maxi.begin(), maxi.end()), sqrt(var_max));
+        }
+    }
+    return 0;
+}
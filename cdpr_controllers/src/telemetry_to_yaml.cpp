@@ -0,0 +1,71 @@
+#include <cdpr_controllers/telemetry.h>
+#include <iostream>
+#include <fstream>
+#include <memory>
+
+// converts a telemetry file to the YAML files written by log2plot::Logger
+// one file per channel (prefix + name + .yaml), so that the existing plotting and analysis scripts can be used
+// records are streamed from the mapped file, the whole run is never loaded in memory
+
+using namespace std;
+
+int main(int argc, char ** argv)
+{
+    if(argc < 2)
+    {
+        cout << "usage: " << argv[0] << " file.tlm [prefix]" << endl;
+        cout << "  writes <prefix><channel>.yaml, default prefix is the directory of the file" << endl;
+        return 1;
+    }
+
+    TelemetryReader reader(argv[1]);
+    if(!reader.ok())
+        return 1;
+
+    string prefix;
+    if(argc > 2)
+        prefix = argv[2];
+    else
+    {
+        const string file(argv[1]);
+        const size_t slash = file.rfind('/');
+        prefix = slash == string::npos ? "" : file.substr(0, slash+1);
+    }
+
+    const auto &channels = reader.channels();
+    vector<unique_ptr<ofstream>> out;
+    for(const auto &channel: channels)
+    {
+        out.emplace_back(new ofstream(prefix + channel.name + ".yaml"));
+        ofstream &f = *out.back();
+        if(!f)
+        {
+            cout << "cannot write " << prefix + channel.name + ".yaml" << endl;
+            return 1;
+        }
+        f.precision(9);
+        f << "dataType: time-based" << endl;
+        f << "ylabel: " << channel.ylabel << endl;
+        f << "legend: " << channel.legend << endl;
+        f << "data:" << endl;
+    }
+
+    for(unsigned long k = 0; k < reader.records(); ++k)
+    {
+        const double *record = reader.record(k);
+        for(unsigned int i = 0; i < channels.size(); ++i)
+        {
+            ofstream &f = *out[i];
+            f << "  - [" << record[0];
+            const double *v = record + channels[i].offset;
+            for(unsigned int j = 0; j < channels[i].dim; ++j)
+                f << ", " << v[j];
+            f << "]\n";
+        }
+    }
+
+    cout << reader.records() << " records, " << channels.size() << " channels written to " << prefix << "*.yaml" << endl;
+    if(reader.dropped())
+        cout << reader.dropped() << " records were dropped during the run" << endl;
+    return 0;
+}
@@ -0,0 +1,243 @@
+#include <cdpr/cdpr.h>
+#include <cdpr/log.h>
+#include <cdpr/param.h>
+#include <cdpr_controllers/topp.h>
+#include <visp/vpIoTools.h>
+#include <visp/vpThetaUVector.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+using namespace std;
+
+/*
+ * Time-optimal timing of a path with feasible cable tensions (see topp.h)
+ *
+ * The path goes through waypoints in straight lines, the orientation rotates about a fixed axis on each segment,
+ * and the platform stops at each waypoint. The tensions stay in [f_min + safety, f_max - safety] with the
+ * platform dynamics, the velocity is bounded by v_max and w_max.
+ *
+ * The trajectory is resampled at dt and written as text, one line per sample:
+ *      t x y z tux tuy tuz vx vy vz wx wy wz ax ay az awx awy awz
+ * to be streamed by trajectory_generator/play_trajectory
+ *
+ * Needs the model on the parameter server, private parameters:
+ *  file, waypoints (list of [x, y, z] or [x, y, z, rx, ry, rz], default Tra/position/A and B at the home orientation),
+ *  stages (per segment), dt, v_max, w_max, safety (fraction of the tension range)
+ */
+
+template <class T>
+void Param(ros::NodeHandle &nh, const string &key, T &val)
+{
+    if(nh.hasParam(key))
+        nh.getParam(key, val);
+    else
+        nh.setParam(key, val);
+}
+
+struct Waypoint
+{
+    vpTranslationVector p;
+    vpRotationMatrix R;
+};
+
+int main(int argc, char ** argv)
+{
+    ros::init(argc, argv, "topp");
+    ros::NodeHandle nh, nh_priv("~");
+    cdpr_log::setLevel(ros::param::param<std::string>("~log_level", "info"));
+
+    CDPR robot(nh);
+    const unsigned int n = robot.n_cables();
+    double f_min, f_max;
+    robot.tensionMinMax(f_min, f_max);
+
+    string file = "/home/" + vpIoTools::getUserName() + "/Results/cdpr/topp.txt";
+    int stages = 100;
+    double dt = 0.01, v_max = 1, w_max = 1, safety = 0.05;
+    Param(nh_priv, "file", file);
+    Param(nh_priv, "stages", stages);
+    Param(nh_priv, "dt", dt);
+    Param(nh_priv, "v_max", v_max);
+    Param(nh_priv, "w_max", w_max);
+    Param(nh_priv, "safety", safety);
+    stages = max(stages, 2);
+
+    // waypoints, default orientation is the home one
+    vector<double> rpy;
+    if(!nh.getParam("model/platform/position/rpy", rpy) || rpy.size() != 3)
+    {
+        CDPR_ERROR("topp: no model/platform/position/rpy");
+        return 1;
+    }
+    const vpRxyzVector r_home(rpy[0], rpy[1], rpy[2]);
+    vector<Waypoint> waypoints;
+    XmlRpc::XmlRpcValue list;
+    if(nh_priv.getParam("waypoints", list))
+    {
+        for(int i = 0; i < list.size(); ++i)
+        {
+            Waypoint wp;
+            wp.R.buildFrom(r_home);
+            for(unsigned int k = 0; k < 3; ++k)
+                wp.p[k] = cdpr_param::toDouble(list[i][k]);
+            if(list[i].size() == 6)
+            {
+                const vpRxyzVector r(cdpr_param::toDouble(list[i][3]), cdpr_param::toDouble(list[i][4]),
+                                     cdpr_param::toDouble(list[i][5]));
+                wp.R.buildFrom(r);
+            }
+            waypoints.push_back(wp);
+        }
+    }
+    else
+    {
+        for(const string &key: {"Tra/position/A", "Tra/position/B"})
+        {
+            Waypoint wp;
+            wp.R.buildFrom(r_home);
+            if(nh.getParam(key, list))
+            {
+                for(unsigned int k = 0; k < 3; ++k)
+                    wp.p[k] = cdpr_param::toDouble(list[k]);
+                waypoints.push_back(wp);
+            }
+        }
+    }
+
+    // segments: translation dp and rotation vector theta in world frame, R(s) = exp(s.theta).R_k
+    vector<Waypoint> start;
+    vector<vpColVector> dq;
+    for(unsigned int k = 0; k+1 < waypoints.size(); ++k)
+    {
+        vpColVector q(6);
+        const vpThetaUVector theta(waypoints[k+1].R * waypoints[k].R.t());
+        for(unsigned int i = 0; i < 3; ++i)
+        {
+            q[i] = waypoints[k+1].p[i] - waypoints[k].p[i];
+            q[i+3] = theta[i];
+        }
+        if(q.euclideanNorm() < 1e-9)
+            continue;
+        start.push_back(waypoints[k]);
+        dq.push_back(q);
+    }
+    if(dq.empty())
+    {
+        CDPR_ERROR("topp: needs at least two distinct waypoints");
+        return 1;
+    }
+    const unsigned int segments = dq.size();
+
+    // pose at s in [0, segments]
+    auto pose = [&](double s, vpHomogeneousMatrix &M, unsigned int &k)
+    {
+        k = min<unsigned int>(s, segments-1);
+        const double sigma = s - k;
+        vpTranslationVector p;
+        vpThetaUVector theta;
+        for(unsigned int i = 0; i < 3; ++i)
+        {
+            p[i] = start[k].p[i] + sigma*dq[k][i];
+            theta[i] = sigma*dq[k][i+3];
+        }
+        M.insert(vpRotationMatrix(theta) * start[k].R);
+        M.insert(p);
+    };
+
+    // stages: structure matrix in world frame and wrench along the path
+    const double margin = safety*(f_max - f_min);
+    const unsigned int N = segments*stages;
+    vector<topp::Stage> path(N+1);
+    vector<double> s(N+1);
+    PlatformDynamics dynamics = robot.dynamicsModel();
+    PlatformDynamics::Matrix3d R_e;
+    PlatformDynamics::Vector6d q, a;
+    vpHomogeneousMatrix M;
+    vpRotationMatrix R;
+    vpMatrix W(6, n), R_R(6, 6);
+    const auto t_start = chrono::steady_clock::now();
+    for(unsigned int i = 0; i <= N; ++i)
+    {
+        s[i] = double(i)/stages;
+        unsigned int k;
+        pose(s[i], M, k);
+        M.extract(R);
+        for(unsigned int r=0;r<3;++r)
+            for(unsigned int c=0;c<3;++c)
+                R_e(r,c) = R_R[r][c] = R_R[r+3][c+3] = R[r][c];
+        robot.computeW(M, W);
+
+        topp::Stage &stage = path[i];
+        stage.W = R_R*W;
+        // straight segments: q'' = 0, the Coriolis term is quadratic in sdot
+        for(unsigned int j = 0; j < 6; ++j)
+            q(j) = dq[k][j];
+        dynamics.update(R_e, q);
+        a = dynamics.massMatrix()*q;
+        stage.a.resize(6);
+        stage.b.resize(6);
+        stage.c.resize(6);
+        for(unsigned int j = 0; j < 6; ++j)
+        {
+            stage.a[j] = a(j);
+            stage.b[j] = dynamics.coriolis()(j);
+            stage.c[j] = -dynamics.gravity()(j);
+        }
+
+        // velocity limits, stop at the waypoints
+        const double lin = sqrt(q(0)*q(0) + q(1)*q(1) + q(2)*q(2)), ang = sqrt(q(3)*q(3) + q(4)*q(4) + q(5)*q(5));
+        stage.x_max = 1e6;
+        if(lin > 0)
+            stage.x_max = min(stage.x_max, v_max*v_max/(lin*lin));
+        if(ang > 0)
+            stage.x_max = min(stage.x_max, w_max*w_max/(ang*ang));
+        if(i % stages == 0)
+            stage.x_max = 0;
+    }
+
+    vector<double> x, u, t;
+    if(!topp::parameterize(path, s, f_min + margin, f_max - margin, x, u) || !topp::timeStamps(s, x, t))
+    {
+        CDPR_ERROR("topp: the path cannot be followed with tensions in [" << f_min + margin << ", " << f_max - margin << "]");
+        return 1;
+    }
+    const double elapsed = chrono::duration<double>(chrono::steady_clock::now() - t_start).count();
+
+    // resample at dt, sdot is linear in time within a stage
+    vpIoTools::makeDirectory(vpIoTools::getParent(file));
+    ofstream out(file, ios::trunc);
+    out << "# t x y z tux tuy tuz vx vy vz wx wy wz ax ay az awx awy awz\n";
+    const unsigned int samples = ceil(t.back()/dt - 1e-9) + 1;
+    unsigned int i = 0;
+    for(unsigned int j = 0; j < samples; ++j)
+    {
+        const double tj = min(j*dt, t.back());
+        while(i+1 < N && t[i+1] <= tj)
+            i++;
+        const double tau = tj - t[i], sd0 = sqrt(x[i]);
+        const double sj = min(s[i] + sd0*tau + .5*u[i]*tau*tau, s[i+1]);
+        const double sd = j+1 == samples ? 0 : max(sd0 + u[i]*tau, 0.), sdd = j+1 == samples ? 0 : u[i];
+
+        unsigned int k;
+        pose(sj, M, k);
+        const vpPoseVector P(M);
+        out << tj;
+        for(unsigned int c = 0; c < 6; ++c)
+            out << " " << P[c];
+        for(unsigned int c = 0; c < 6; ++c)
+            out << " " << dq[k][c]*sd;
+        for(unsigned int c = 0; c < 6; ++c)
+            out << " " << dq[k][c]*sdd;
+        out << "\n";
+    }
+    if(!out)
+    {
+        CDPR_ERROR("topp: cannot write " << file);
+        return 1;
+    }
+    CDPR_INFO("topp: " << segments << " segments in " << t.back() << " s (" << N << " stages solved in "
+              << elapsed << " s), " << samples << " samples written to " << file);
+    cdpr_log::flush();
+    return 0;
+}
@@ -0,0 +1,36 @@
+#include <cdpr_controllers/tuning.h>
+
+TuningServer::TuningServer(ros::NodeHandle &nh_priv, ros::NodeHandle &nh, CDPR &robot, bool with_tda)
+    : nh(nh), robot(robot), with_tda(with_tda), server(nh_priv)
+{
+    // the first call is done from here with the current parameters,
+    // the control thread gets it with its first update()
+    server.setCallback(boost::bind(&TuningServer::callback, this, _1, _2));
+}
+
+void TuningServer::callback(cdpr_controllers::ControllerConfig &config, uint32_t)
+{
+    Tuning next = current;
+    next.Kp = config.Kp;
+    next.Ki = config.Ki;
+    next.Kd = config.Kd;
+
+    if(with_tda)
+    {
+        TDA::minType control = next.control;
+        if(!TDA::FromName(config.control, control))
+            ROS_WARN("TuningServer: unknown TDA %s, keeping the current one", config.control.c_str());
+
+        // the running TDA is never modified, a new one replaces it
+        if(!next.tda || control != next.control || config.threshold != next.threshold)
+        {
+            next.tda = std::make_shared<TDA>(robot, nh, control);
+            next.tda->ForceContinuity(config.threshold);
+            next.control = control;
+            next.threshold = config.threshold;
+        }
+    }
+
+    current = next;
+    live.set(next);
+}
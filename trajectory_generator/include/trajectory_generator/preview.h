@@ -0,0 +1,86 @@
+#ifndef trajectory_PREVIEW_H
+#define trajectory_PREVIEW_H
+
+#include <ros/ros.h>
+#include <ros/publisher.h>
+#include <cdpr/TrajectoryPreview.h>
+#include <visp/vpColVector.h>
+#include <visp/vpThetaUVector.h>
+#include <visp/vpQuaternionVector.h>
+#include <visp/vpRotationMatrix.h>
+#include <algorithm>
+#include <functional>
+
+// publishes the setpoints as a trajectory preview (cdpr/TrajectoryPreview.msg)
+// every `period` ticks, the next `horizon` samples go in one message and CDPR interpolates between them
+// private parameters:
+//  preview/horizon  number of samples (default 20)
+//  preview/period   ticks between two messages (default 5)
+//  preview/legacy   also publish pf_setpoint, desired_vel and desired_acc at each tick (default false)
+
+class PreviewPublisher
+{
+public:
+    // setpoint of tick k: pose (x, y, z, tux, tuy, tuz), velocity and acceleration, missing components are 0
+    typedef std::function<void(int, vpColVector&, vpColVector&, vpColVector&)> Sampler;
+
+    PreviewPublisher(ros::NodeHandle &node, double dt)
+        : horizon(20), period(5), legacy_(false), P(6), Vel(6), Acc(6)
+    {
+        ros::NodeHandle priv("~");
+        priv.param("preview/horizon", horizon, horizon);
+        priv.param("preview/period", period, period);
+        priv.param("preview/legacy", legacy_, legacy_);
+        period = std::max(period, 1);
+        // a message must cover the ticks until the next one, plus one interval to interpolate
+        horizon = std::max(horizon, period+1);
+
+        preview_pub = node.advertise<cdpr::TrajectoryPreview>("trajectory_preview", 1);
+        msg.dt = dt;
+        msg.pose.resize(horizon);
+        msg.velocity.resize(horizon);
+        msg.acceleration.resize(horizon);
+    }
+
+    inline bool legacy() const {return legacy_;}
+
+    // publishes the samples from tick k when k is a multiple of the period
+    bool update(int k, const Sampler &sample)
+    {
+        if(k % period)
+            return false;
+
+        msg.header.stamp = ros::Time::now();
+        for(int i = 0; i < horizon; ++i)
+        {
+            P = 0;
+            Vel = 0;
+            Acc = 0;
+            sample(k+i, P, Vel, Acc);
+
+            geometry_msgs::Pose &pose = msg.pose[i];
+            pose.position.x = P[0]; pose.position.y = P[1]; pose.position.z = P[2];
+            vpQuaternionVector q(vpRotationMatrix(vpThetaUVector(P[3], P[4], P[5])));
+            pose.orientation.x = q.x(); pose.orientation.y = q.y(); pose.orientation.z = q.z(); pose.orientation.w = q.w();
+            write(Vel, msg.velocity[i]);
+            write(Acc, msg.acceleration[i]);
+        }
+        preview_pub.publish(msg);
+        return true;
+    }
+
+protected:
+    int horizon, period;
+    bool legacy_;
+    ros::Publisher preview_pub;
+    cdpr::TrajectoryPreview msg;
+    vpColVector P, Vel, Acc;
+
+    inline static void write(const vpColVector &v, geometry_msgs::Twist &twist)
+    {
+        twist.linear.x = v[0]; twist.linear.y = v[1]; twist.linear.z = v[2];
+        twist.angular.x = v[3]; twist.angular.y = v[4]; twist.angular.z = v[5];
+    }
+};
+
+#endif // trajectory_PREVIEW_H
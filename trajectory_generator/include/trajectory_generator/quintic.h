@@ -0,0 +1,106 @@
+#ifndef trajectory_QUINTIC_H
+#define trajectory_QUINTIC_H
+
+#include <Eigen/Core>
+
+// quintic polynomial segment on N axes from t0 to t1
+// the coefficients are computed in closed form from the position, velocity and acceleration at both ends,
+// in normalized time tau = (t-t0)/(t1-t0) so that they stay well conditioned for any t0
+// position, velocity and acceleration are evaluated together with Horner's scheme, on all the axes at once
+// outside [t0, t1] the polynomial is extrapolated, clamp the time if the end points should be held
+
+template <int N>
+class QuinticSegment
+{
+public:
+    typedef Eigen::Array<double, N, 1> Vector;
+    // one column per time stamp, rows are contiguous for batch evaluation
+    typedef Eigen::Array<double, N, Eigen::Dynamic, Eigen::RowMajor> Samples;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    QuinticSegment() : t0(0), inv_h(1)
+    {
+        c.setZero();
+        dc.setZero();
+        ddc.setZero();
+    }
+
+    // general boundary conditions
+    QuinticSegment(double t_0, double t_1,
+                   const Vector &p0, const Vector &v0, const Vector &a0,
+                   const Vector &p1, const Vector &v1, const Vector &a1)
+    {
+        build(t_0, t_1, p0, v0, a0, p1, v1, a1);
+    }
+
+    // rest to rest
+    QuinticSegment(double t_0, double t_1, const Vector &p0, const Vector &p1)
+    {
+        build(t_0, t_1, p0, Vector::Zero(), Vector::Zero(), p1, Vector::Zero(), Vector::Zero());
+    }
+
+    inline double start() const {return t0;}
+    inline double end() const {return t0 + 1./inv_h;}
+
+    // position, velocity and acceleration at time t
+    inline void evaluate(double t, Vector &p, Vector &v, Vector &a) const
+    {
+        const double tau = (t - t0)*inv_h;
+        p = c.col(0) + tau*(c.col(1) + tau*(c.col(2) + tau*(c.col(3) + tau*(c.col(4) + tau*c.col(5)))));
+        v = dc.col(0) + tau*(dc.col(1) + tau*(dc.col(2) + tau*(dc.col(3) + tau*dc.col(4))));
+        a = ddc.col(0) + tau*(ddc.col(1) + tau*(ddc.col(2) + tau*ddc.col(3)));
+    }
+
+    inline Vector position(double t) const
+    {
+        const double tau = (t - t0)*inv_h;
+        return c.col(0) + tau*(c.col(1) + tau*(c.col(2) + tau*(c.col(3) + tau*(c.col(4) + tau*c.col(5)))));
+    }
+
+    // batch evaluation at n time stamps, vectorized along the time stamps
+    // does not allocate if the outputs already have n columns
+    void evaluate(const double *t, int n, Samples &p, Samples &v, Samples &a) const
+    {
+        p.resize(N, n);
+        v.resize(N, n);
+        a.resize(N, n);
+        const Eigen::Map<const Eigen::Array<double, 1, Eigen::Dynamic>> ts(t, n);
+        const auto tau = (ts - t0)*inv_h;
+        for(int i = 0; i < N; ++i)
+        {
+            p.row(i) = c(i,0) + tau*(c(i,1) + tau*(c(i,2) + tau*(c(i,3) + tau*(c(i,4) + tau*c(i,5)))));
+            v.row(i) = dc(i,0) + tau*(dc(i,1) + tau*(dc(i,2) + tau*(dc(i,3) + tau*dc(i,4))));
+            a.row(i) = ddc(i,0) + tau*(ddc(i,1) + tau*(ddc(i,2) + tau*ddc(i,3)));
+        }
+    }
+
+protected:
+    double t0, inv_h;
+    // position coefficients in tau, velocity and acceleration ones already scaled to physical time
+    Eigen::Array<double, N, 6> c;
+    Eigen::Array<double, N, 5> dc;
+    Eigen::Array<double, N, 4> ddc;
+
+    void build(double t_0, double t_1,
+               const Vector &p0, const Vector &v0, const Vector &a0,
+               const Vector &p1, const Vector &v1, const Vector &a1)
+    {
+        t0 = t_0;
+        const double h = t_1 - t_0;
+        inv_h = 1./h;
+        const Vector dp = p1 - p0;
+        c.col(0) = p0;
+        c.col(1) = v0*h;
+        c.col(2) = .5*a0*h*h;
+        c.col(3) = 10*dp - (6*v0 + 4*v1)*h - (1.5*a0 - .5*a1)*h*h;
+        c.col(4) = -15*dp + (8*v0 + 7*v1)*h + (1.5*a0 - a1)*h*h;
+        c.col(5) = 6*dp - 3*(v0 + v1)*h - .5*(a0 - a1)*h*h;
+        for(int k = 0; k < 5; ++k)
+            dc.col(k) = (k+1)*c.col(k+1)*inv_h;
+        for(int k = 0; k < 4; ++k)
+            ddc.col(k) = (k+1)*(k+2)*c.col(k+2)*inv_h*inv_h;
+    }
+};
+
+#endif // trajectory_QUINTIC_H
@@ -10,6 +10,7 @@
 #include <geometry_msgs/Twist.h>
 
 #include <visp/vpHomogeneousMatrix.h>
+#include <trajectory_generator/quintic.h>
 
 using std::endl;
 using std::cout;
@@ -17,6 +18,8 @@ using std::cout;
 class Trajectory
 {
         public:
+        typedef QuinticSegment<1> Segment;
+
         Trajectory(ros::NodeHandle &_node)
         {   
                 // publisher to setpoints
@@ -62,63 +65,19 @@ class Trajectory
 
 
 
-        inline vpMatrix getLmatrix(double &t_, double &t)
-        {
-                vpMatrix M;
-                M.resize(6,6);
-                M[0][0]=t_*t_*t_*t_*t_; M[0][1]=t_*t_*t_*t_; M[0][2]=t_*t_*t_; M[0][3]=t_*t_; M[0][4]=t_; M[0][5]=1;
-                M[1][0]=5*t_*t_*t_*t_; M[1][1]=4*t_*t_*t_; M[1][2]=3*t_*t_; M[1][3]=2*t_; M[1][4]=1; 
-                M[2][0]=20*t_*t_*t_; M[2][1]=12*t_*t_; M[2][2]=6*t_; M[2][3]=2; 
-              
-                M[3][0]=t*t*t*t*t; M[3][1]=t*t*t*t; M[3][2]=t*t*t; M[3][3]=t*t; M[3][4]=t; M[3][5]=1;
-                M[4][0]=5*t*t*t*t; M[4][1]=4*t*t*t; M[4][2]=3*t*t; M[4][3]=2*t; M[4][4]=1; 
-                M[5][0]=20*t*t*t; M[5][1]=12*t*t; M[5][2]=6*t; M[5][3]=2;  
-                return M;
-        }
-
-        inline  void getS( vpColVector &S1, vpColVector &S2, vpColVector &S3, vpColVector &S4, vpColVector &S5, vpColVector &S6) 
+        // normalized segments of the s-curve, from 0 to 1 with closed-form coefficients
+        //  S1: vertical rise of h_b from t0 to t1
+        //  S2, S3: vertical motion of h_c-h_b from t1 to t2, then back from t2 to t3
+        //  S4: vertical descent of h_b from t3 to t4
+        //  S5: horizontal motion from t1 to t3
+        inline void getS(Segment &S1, Segment &S2, Segment &S3, Segment &S4, Segment &S5)
         {
-            S1.resize(6);S2.resize(6);S3.resize(6);S4.resize(6);S5.resize(6);S6.resize(6);
-
-            S1[3]=1; S1[4]=vb/h_b; S1[5]= ab/h_b;
-       
-            S2[1]=vb/(h_c-h_b); S2[2]=ab/(h_c-h_b); S2[3]= 1;
-
-            S3[3]=1; S3[4]=vb/(h_c-h_b); S3[5]= -ab/(h_c-h_b);
-      
-            S4[1]=vb/h_b; S4[2]= -ab/h_b; S4[3]=1;
-     
-            S5[3]=1;
-       
-            S6[3]=1;
-        }
-
-        // get the desired position xyz
-        inline double getposition(double t, vpColVector a)
-        { 
-            vpRowVector l;
-            l.resize(6);
-            l[0]=t*t*t*t*t; l[1]=t*t*t*t; l[2]=t*t*t; l[3]=t*t; l[4]=t; l[5]=1;
-            double position= l*a;
-            return position;
-        }
-        //get the desired velocity
-        inline double getvelocity(double t, vpColVector a)
-        { 
-            vpRowVector l;
-            l.resize(6);
-             l[0]=5*t*t*t*t; l[1]=4*t*t*t; l[2]=3*t*t; l[3]=2*t; l[4]=1; 
-            double vel=l*a;
-            return vel;
-        }
-
-        inline double getacceleration(double t, vpColVector a)
-        { 
-            vpRowVector l;
-            l.resize(6);
-            l[0]=20*t*t*t; l[1]=12*t*t; l[2]=6*t; l[3]=2;  
-            double acc=l*a;
-            return acc;
+            typedef Segment::Vector V;
+            S1 = Segment(t0, t1, V(0.), V(0.), V(0.), V(1.), V(vb/h_b), V(ab/h_b));
+            S2 = Segment(t1, t2, V(0.), V(vb/(h_c-h_b)), V(ab/(h_c-h_b)), V(1.), V(0.), V(0.));
+            S3 = Segment(t2, t3, V(0.), V(0.), V(0.), V(1.), V(vb/(h_c-h_b)), V(-ab/(h_c-h_b)));
+            S4 = Segment(t3, t4, V(0.), V(vb/h_b), V(-ab/h_b), V(1.), V(0.), V(0.));
+            S5 = Segment(t1, t3, V(0.), V(1.));
         }
 
         void sendDesiredpara(vpColVector p, vpColVector v, vpColVector acc)
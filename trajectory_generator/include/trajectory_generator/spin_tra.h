@@ -55,21 +55,6 @@ class Trajectory
         inline void InitializePose(vpColVector &x_i, vpColVector &x_f) {x_i = xi; x_f = xf;}
         inline void InitializeParameter(double &alpha_ , double &beta_,  double &u_ ) { alpha_= alpha; beta_=beta; u_= u;}
         
-        // define time matrix
-        inline vpMatrix getTmatrix(double &t_, double &t)
-        {
-            vpMatrix M;
-            M.resize(6,6);
-            M[0][0]=t_*t_*t_*t_*t_; M[0][1]=t_*t_*t_*t_; M[0][2]=t_*t_*t_; M[0][3]=t_*t_; M[0][4]=t_; M[0][5]=1;
-            M[1][0]=5*t_*t_*t_*t_; M[1][1]=4*t_*t_*t_; M[1][2]=3*t_*t_; M[1][3]=2*t_; M[1][4]=1; 
-            M[2][0]=20*t_*t_*t_; M[2][1]=12*t_*t_; M[2][2]=6*t_; M[2][3]=2; 
-          
-            M[3][0]=t*t*t*t*t; M[3][1]=t*t*t*t; M[3][2]=t*t*t; M[3][3]=t*t; M[3][4]=t; M[3][5]=1;
-            M[4][0]=5*t*t*t*t; M[4][1]=4*t*t*t; M[4][2]=3*t*t; M[4][3]=2*t; M[4][4]=1; 
-            M[5][0]=20*t*t*t; M[5][1]=12*t*t; M[5][2]=6*t; M[5][3]=2;  
-            return M;
-        }
-
         // condition matrix where define the pose, velocity and acceleration of initial point and final point
         inline  void getX( vpColVector &Xx, vpColVector &Xy, vpColVector &Xz) 
         {       
@@ -98,34 +83,6 @@ class Trajectory
                 Xy[3]= asin((xf[1]-xi[1])/ beta)+2*n_c*M_PI;*/
         }
 
-        // get the desired S(t)
-        inline double getS(double t, vpColVector a)
-        { 
-            vpRowVector l;
-            l.resize(6);
-            l[0]=t*t*t*t*t; l[1]=t*t*t*t; l[2]=t*t*t; l[3]=t*t; l[4]=t; l[5]=1;
-            double S = l*a;
-            return S ;
-        }
-        //get the desired S(t)_dot
-        inline double getSdot(double t, vpColVector a)
-        { 
-            vpRowVector l;
-            l.resize(6);
-             l[0]=5*t*t*t*t; l[1]=4*t*t*t; l[2]=3*t*t; l[3]=2*t; l[4]=1; 
-            double Sdot=l*a;
-            return Sdot;
-        }
-        //get the desired S(t)_ddot
-        inline double getSddot(double t, vpColVector a)
-        { 
-            vpRowVector l;
-            l.resize(6);
-            l[0]=20*t*t*t; l[1]=12*t*t; l[2]=6*t; l[3]=2;  
-            double Sddot=l*a;
-            return Sddot;
-        }
-
         void sendDesiredpara(vpColVector p, vpColVector v, vpColVector acc)
         {
             // write effort to jointstate
@@ -0,0 +1,202 @@
+#ifndef trajectory_SPLINE_H
+#define trajectory_SPLINE_H
+
+#include <trajectory_generator/quintic.h>
+#include <Eigen/Geometry>
+#include <Eigen/StdVector>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// C2 cubic spline through waypoints (t_k, q_k) on N axes, at rest at both ends (clamped spline)
+// the knot accelerations come from a tridiagonal system solved once for all the axes,
+// each segment is then stored as a QuinticSegment with the knot position, velocity and acceleration
+// (the quintic through these conditions is the cubic itself)
+// the segment of a time stamp is found in O(1) if the knots are evenly spaced, by binary search otherwise
+
+template <int N>
+class Spline
+{
+public:
+    typedef QuinticSegment<N> Segment;
+    typedef typename Segment::Vector Vector;
+    typedef std::vector<Vector, Eigen::aligned_allocator<Vector>> Points;
+
+    // returns false if there are less than 2 waypoints or if the times are not increasing
+    bool build(const std::vector<double> &t, const Points &q)
+    {
+        const int n = int(t.size()) - 1;
+        knots.clear();
+        segments.clear();
+        if(n < 1 || q.size() != t.size())
+            return false;
+        for(int i = 0; i < n; ++i)
+            if(!(t[i+1] > t[i]))
+                return false;
+
+        // knot accelerations, Thomas algorithm on the clamped spline system
+        std::vector<double> h(n), diag(n+1), upper(n+1);
+        Points acc(n+1), rhs(n+1), vel(n+1);
+        for(int i = 0; i < n; ++i)
+            h[i] = t[i+1] - t[i];
+        for(int i = 0; i <= n; ++i)
+        {
+            const double hl = i > 0 ? h[i-1] : 0, hr = i < n ? h[i] : 0;
+            diag[i] = 2*(hl + hr);
+            upper[i] = hr;
+            rhs[i] = Vector::Zero();
+            if(i < n)
+                rhs[i] += 6*(q[i+1] - q[i])/hr;
+            if(i > 0)
+                rhs[i] -= 6*(q[i] - q[i-1])/hl;
+        }
+        for(int i = 1; i <= n; ++i)
+        {
+            const double f = h[i-1]/diag[i-1];
+            diag[i] -= f*upper[i-1];
+            rhs[i] -= f*rhs[i-1];
+        }
+        acc[n] = rhs[n]/diag[n];
+        for(int i = n-1; i >= 0; --i)
+            acc[i] = (rhs[i] - upper[i]*acc[i+1])/diag[i];
+
+        vel[n] = Vector::Zero();
+        for(int i = 0; i < n; ++i)
+            vel[i] = (q[i+1] - q[i])/h[i] - h[i]*(2*acc[i] + acc[i+1])/6;
+        vel[0] = Vector::Zero();
+
+        knots = t;
+        for(int i = 0; i < n; ++i)
+            segments.push_back(Segment(t[i], t[i+1], q[i], vel[i], acc[i], q[i+1], vel[i+1], acc[i+1]));
+
+        step = (t[n] - t[0])/n;
+        uniform = true;
+        for(int i = 0; i < n; ++i)
+            if(std::abs(h[i] - step) > 1e-9*step)
+                uniform = false;
+        return true;
+    }
+
+    inline double start() const {return knots.front();}
+    inline double end() const {return knots.back();}
+    inline unsigned int size() const {return segments.size();}
+
+    // index of the segment containing t, clamped to the spline
+    inline unsigned int segment(double t) const
+    {
+        const int last = int(segments.size()) - 1;
+        int i;
+        if(uniform)
+            i = int(std::floor((t - knots.front())/step));
+        else
+            i = int(std::upper_bound(knots.begin(), knots.end(), t) - knots.begin()) - 1;
+        return std::min(std::max(i, 0), last);
+    }
+
+    // position, velocity and acceleration at t, the end points are held outside the spline
+    inline void evaluate(double t, Vector &p, Vector &v, Vector &a) const
+    {
+        if(t >= knots.back())
+        {
+            segments.back().evaluate(knots.back(), p, v, a);
+            v.setZero();
+            a.setZero();
+            return;
+        }
+        if(t <= knots.front())
+        {
+            segments.front().evaluate(knots.front(), p, v, a);
+            v.setZero();
+            a.setZero();
+            return;
+        }
+        segments[segment(t)].evaluate(t, p, v, a);
+    }
+
+protected:
+    std::vector<double> knots;
+    std::vector<Segment, Eigen::aligned_allocator<Segment>> segments;
+    bool uniform;
+    double step;
+};
+
+// spline of poses: position and rotation vector theta with R = exp(theta).R_0
+// the rotation vectors are unwrapped from one waypoint to the next so that theta stays continuous
+// outputs (x, y, z, theta.u) as in vpPoseVector, the velocity and acceleration are twists in world frame
+
+class PoseSpline
+{
+public:
+    typedef Spline<6>::Vector Vector6;
+    typedef Spline<6>::Points Points;
+
+    // waypoints: position and orientation (platform to world)
+    bool build(const std::vector<double> &t,
+               const std::vector<Eigen::Vector3d> &position, const std::vector<Eigen::Matrix3d> &orientation)
+    {
+        if(t.empty() || position.size() != t.size() || orientation.size() != t.size())
+            return false;
+        R0 = orientation.front();
+        Points q(t.size());
+        Eigen::Vector3d prev = Eigen::Vector3d::Zero();
+        for(unsigned int k = 0; k < t.size(); ++k)
+        {
+            const Eigen::AngleAxisd aa(orientation[k]*R0.transpose());
+            Eigen::Vector3d theta = aa.angle()*aa.axis();
+            // closest equivalent rotation vector to the previous one
+            if(aa.angle() > 1e-12)
+                theta += 2*M_PI*std::round(aa.axis().dot(prev - theta)/(2*M_PI))*aa.axis();
+            q[k].head<3>() = position[k];
+            q[k].tail<3>() = theta;
+            prev = theta;
+        }
+        return spline.build(t, q);
+    }
+
+    inline double start() const {return spline.start();}
+    inline double end() const {return spline.end();}
+    inline const Spline<6>& path() const {return spline;}
+
+    // pose (x, y, z, theta.u), twist and its derivative at t, in world frame
+    void evaluate(double t, Vector6 &pose, Vector6 &vel, Vector6 &acc) const
+    {
+        Vector6 q, dq, ddq;
+        spline.evaluate(t, q, dq, ddq);
+        const Eigen::Vector3d theta = q.tail<3>(), dtheta = dq.tail<3>(), ddtheta = ddq.tail<3>();
+
+        // R = exp(theta).R_0, angular velocity J(theta).dtheta with the left Jacobian of SO(3)
+        const double angle = theta.norm();
+        const Eigen::Matrix3d R = (angle > 1e-12 ? Eigen::AngleAxisd(angle, theta/angle).toRotationMatrix()
+                                                 : Eigen::Matrix3d::Identity()) * R0;
+        const Eigen::AngleAxisd tu(R);
+        pose.head<3>() = q.head<3>();
+        pose.tail<3>() = tu.angle()*tu.axis();
+        vel.head<3>() = dq.head<3>();
+        acc.head<3>() = ddq.head<3>();
+
+        // angular acceleration J.ddtheta + dJ/dt.dtheta, the second term by central difference along dtheta
+        const double eps = 1e-6;
+        const Eigen::Matrix3d J = leftJacobian(theta);
+        vel.tail<3>() = J*dtheta;
+        acc.tail<3>() = J*ddtheta + (leftJacobian(theta + eps*dtheta) - leftJacobian(theta - eps*dtheta))/(2*eps)*dtheta;
+    }
+
+protected:
+    Spline<6> spline;
+    Eigen::Matrix3d R0;
+
+    static Eigen::Matrix3d leftJacobian(const Eigen::Vector3d &theta)
+    {
+        const double angle = theta.norm();
+        Eigen::Matrix3d S;
+        S << 0, -theta(2), theta(1),
+             theta(2), 0, -theta(0),
+             -theta(1), theta(0), 0;
+        if(angle < 1e-6)
+            return Eigen::Matrix3d::Identity() + .5*S + S*S/6;
+        return Eigen::Matrix3d::Identity() + (1 - std::cos(angle))/(angle*angle)*S
+                + (angle - std::sin(angle))/(angle*angle*angle)*S*S;
+    }
+};
+
+#endif // trajectory_SPLINE_H
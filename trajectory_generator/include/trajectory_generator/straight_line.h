@@ -51,44 +51,6 @@ class Trajectory
         inline void InitializeTime(double &t_0, double &t_1) {t_0= t0; t_1= t1;}
         inline void InitializePose(vpRowVector &x_i, vpRowVector &x_f) {x_i = xi; x_f = xf;}
 
-        inline vpMatrix getLmatrix(double &t)
-        {
-            vpMatrix M;
-            M.resize(6,6);
-            M[0][5]=1; M[1][4]=1; M[2][3]=2;
-            M[3][0]=t*t*t*t*t; M[3][1]=t*t*t*t; M[3][2]=t*t*t; M[3][3]=t*t; M[3][4]=t; M[3][5]=1;
-            M[4][0]=5*t*t*t*t; M[4][1]=4*t*t*t; M[4][2]=3*t*t; M[4][3]=2*t; M[4][4]=1; 
-            M[5][0]=20*t*t*t; M[5][1]=12*t*t; M[5][2]=6*t; M[5][3]=2;  
-            return M;
-        }
-        // get the desired position xyz
-        inline vpRowVector getposition(double t, vpMatrix a)
-        { 
-            vpRowVector position, l;
-            l.resize(6);
-            l[0]=t*t*t*t*t; l[1]=t*t*t*t; l[2]=t*t*t; l[3]=t*t; l[4]=t; l[5]=1;
-            position=l*a;
-            return position;
-        }
-        //get the desired velocity
-        inline vpRowVector getvelocity(double t, vpMatrix a)
-        { 
-            vpRowVector l;
-            l.resize(6);
-            l[0]=5*t*t*t*t; l[1]=4*t*t*t; l[2]=3*t*t; l[3]=2*t; l[4]=1; 
-            vpRowVector vel=l*a;
-            return vel;
-        }
-
-        inline vpRowVector getacceleration(double t, vpMatrix a)
-        { 
-            vpRowVector l;
-            l.resize(6);
-            l[0]=20*t*t*t; l[1]=12*t*t; l[2]=6*t; l[3]=2;  
-            vpRowVector acc=l*a;
-            return acc;
-        }
-
         void sendDesiredpara(vpColVector p, vpColVector v, vpColVector acc)
         {
                 // write desired pose 
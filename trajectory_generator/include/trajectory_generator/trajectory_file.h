@@ -0,0 +1,100 @@
+#ifndef trajectory_FILE_H
+#define trajectory_FILE_H
+
+#include <visp/vpColVector.h>
+#include <visp/vpRotationMatrix.h>
+#include <visp/vpRxyzVector.h>
+#include <Eigen/Core>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// text files read by the trajectory tools, one entry per line, lines starting with # are ignored
+// on error, line is the faulty line (empty if the file cannot be read)
+
+namespace trajectory_file
+{
+
+// time-stamped samples at a constant period, e.g. written by cdpr_controllers/topp:
+//      t x y z tux tuy tuz vx vy vz wx wy wz ax ay az awx awy awz
+inline bool loadSamples(const std::string &file, std::vector<double> &t,
+                        std::vector<vpColVector> &P, std::vector<vpColVector> &Vel, std::vector<vpColVector> &Acc,
+                        std::string &line)
+{
+    std::ifstream in(file);
+    if(!in)
+    {
+        line.clear();
+        return false;
+    }
+    while(getline(in, line))
+    {
+        if(line.empty() || line[0] == '#')
+            continue;
+        std::istringstream ss(line);
+        double tk;
+        vpColVector p(6), v(6), a(6);
+        ss >> tk;
+        for(unsigned int i = 0; i < 6; ++i)
+            ss >> p[i];
+        for(unsigned int i = 0; i < 6; ++i)
+            ss >> v[i];
+        for(unsigned int i = 0; i < 6; ++i)
+            ss >> a[i];
+        if(!ss)
+            return false;
+        t.push_back(tk);
+        P.push_back(p);
+        Vel.push_back(v);
+        Acc.push_back(a);
+    }
+    return true;
+}
+
+// waypoint from t x y z [rx ry rz], the orientation is given as Rxyz angles, rpy if not given
+inline bool addWaypoint(const std::vector<double> &w, const std::vector<double> &rpy, std::vector<double> &t,
+                        std::vector<Eigen::Vector3d> &position, std::vector<Eigen::Matrix3d> &orientation)
+{
+    if(w.size() != 4 && w.size() != 7)
+        return false;
+    const vpRotationMatrix R(w.size() == 7 ? vpRxyzVector(w[4], w[5], w[6]) : vpRxyzVector(rpy[0], rpy[1], rpy[2]));
+    Eigen::Matrix3d R_e;
+    for(unsigned int i=0;i<3;++i)
+        for(unsigned int j=0;j<3;++j)
+            R_e(i,j) = R[i][j];
+    t.push_back(w[0]);
+    position.push_back(Eigen::Vector3d(w[1], w[2], w[3]));
+    orientation.push_back(R_e);
+    return true;
+}
+
+// waypoints for PoseSpline (spline.h), one t x y z [rx ry rz] per line
+inline bool loadWaypoints(const std::string &file, const std::vector<double> &rpy, std::vector<double> &t,
+                          std::vector<Eigen::Vector3d> &position, std::vector<Eigen::Matrix3d> &orientation,
+                          std::string &line)
+{
+    std::ifstream in(file);
+    if(!in)
+    {
+        line.clear();
+        return false;
+    }
+    while(getline(in, line))
+    {
+        if(line.empty() || line[0] == '#')
+            continue;
+        std::istringstream ss(line);
+        std::vector<double> w;
+        double v;
+        while(ss >> v)
+            w.push_back(v);
+        if(!addWaypoint(w, rpy, t, position, orientation))
+            return false;
+    }
+    return true;
+}
+
+}
+
+#endif // trajectory_FILE_H
@@ -0,0 +1,80 @@
+#include <trajectory_generator/preview.h>
+#include <trajectory_generator/trajectory_file.h>
+#include <visp/vpIoTools.h>
+#include <cdpr/log.h>
+#include <cdpr/workspace_map.h>
+
+/*
+*-----------------------------------------------------------------------------------------------------
+*  Streams a time-stamped trajectory from a file, e.g. written by cdpr_controllers/topp
+*  one line per sample at a constant period: t x y z tux tuy tuz vx vy vz wx wy wz ax ay az awx awy awz
+*  lines starting with # are ignored, the last sample is held
+*  the samples are checked against ~workspace_map if given (workspace_determination)
+*------------------------------------------------------------------------------------------------------
+*/
+
+using namespace std;
+
+int main(int argc, char ** argv)
+{
+        ros::init(argc, argv, "play_trajectory");
+        ros::NodeHandle node;
+        cdpr_log::setLevel(ros::param::param<std::string>("~log_level", "info"));
+
+        const string file = ros::param::param<std::string>("~file", "/home/" + vpIoTools::getUserName() + "/Results/cdpr/topp.txt");
+        vector<double> t;
+        vector<vpColVector> P, Vel, Acc;
+        string line;
+        if(!trajectory_file::loadSamples(file, t, P, Vel, Acc, line) && !line.empty())
+        {
+                CDPR_ERROR("play_trajectory: bad line in " << file << ": " << line);
+                return 1;
+        }
+        if(t.size() < 2)
+        {
+                CDPR_ERROR("play_trajectory: no trajectory in " << file);
+                return 1;
+        }
+
+        string workspace_file;
+        if(ros::param::get("~workspace_map", workspace_file))
+        {
+                WorkspaceMap workspace(workspace_file);
+                unsigned int k;
+                if(!workspace.ok())
+                        CDPR_WARN("play_trajectory: " << workspace_file << " is not a workspace map");
+                else if((k = workspace.firstOutside(t.size(), [&](unsigned int k, double *p)
+                        {
+                                for(unsigned int i = 0; i < 3; ++i)
+                                        p[i] = P[k][i];
+                        })) < t.size())
+                        CDPR_WARN("play_trajectory: the trajectory leaves the workspace at t = " << t[k] << " s");
+        }
+
+        const double dt = t[1] - t[0];
+        const int num = t.size() - 1;
+        ros::Rate loop(1/dt);
+        PreviewPublisher preview(node, dt);
+        if(preview.legacy())
+                CDPR_WARN("play_trajectory: only publishes the trajectory preview");
+
+        // setpoint of tick k, held at the end of the trajectory
+        auto sample = [&](int k, vpColVector &p, vpColVector &v, vpColVector &a)
+        {
+                k = std::min(k, num);
+                p = P[k];
+                v = Vel[k];
+                a = Acc[k];
+        };
+
+        CDPR_INFO("play_trajectory: " << t.size() << " samples over " << t.back() - t.front() << " s from " << file);
+        int inter = 0;
+        while (ros::ok())
+        {
+                preview.update(inter, sample);
+                inter++;
+                ros::spinOnce();
+                loop.sleep();
+        }
+        return 0;
+};
@@ -1,6 +1,8 @@
 #include <log2plot/logger.h>
 #include <trajectory_generator/s_curve.h>
+#include <trajectory_generator/preview.h>
 #include <visp/vpIoTools.h>
+#include <cdpr/log.h>
 
 
 /*
@@ -16,10 +18,10 @@ using namespace log2plot;
 
 int main(int argc, char ** argv)
 {
-        cout.precision(3);
         // init ROS node
         ros::init(argc, argv, "s_curve");
         ros::NodeHandle node;
+        cdpr_log::setLevel(ros::param::param<std::string>("~log_level", "info"));
 
         Trajectory path(node);
         std::string dir = "/home/" + vpIoTools::getUserName() + "/Results/cdpr/";
@@ -34,12 +36,8 @@ int main(int argc, char ** argv)
         // initialization
         vpColVector x_i(3), x_f(3), v_i(3), v_f(3), a_i(3), a_f(3);
         vpColVector P, Vel, Acc, T;
-        double t_0, t_1, t_2, t_3, t_4, w, l, t, h_b, h_c;
-        vpColVector A1, A2, A3, A4, A5, A6;
-        vpColVector  S1, S2, S3, S4, S5, S6;
-        vpMatrix W1, W2, W3, W4, W5, W6;
-        W1.resize(6,6); W2.resize(6,6); W3.resize(6,6); W4.resize(6,6); W5.resize(6,6); 
-        A1.resize(6);  A2.resize(6);  A3.resize(6);  A4.resize(6);
+        double t_0, t_1, t_2, t_3, t_4, w, l, h_b, h_c;
+        Trajectory::Segment S1, S2, S3, S4, S5;
         P.resize(6); Vel.resize(6); Acc.resize(6), T.resize(5);
 
        path.InitializeTime(t_0, t_1, t_2, t_3,t_4);
@@ -48,68 +46,71 @@ int main(int argc, char ** argv)
         path.InitializePose(x_i,x_f);
         path.InitializeParam(w, l, h_c, h_b);
 
-       //  obtain the time matrix
-        W1=path.getLmatrix(t_0,t_1);
-        W2=path.getLmatrix(t_1,t_2);
-        W3=path.getLmatrix(t_2,t_3);
-        W4=path.getLmatrix(t_3,t_4);
-        W5=path.getLmatrix(t_1,t_3);
-     
-        //  obtain the desired S matrix
-        path.getS(S1, S2, S3, S4, S5, S6);
-        
-        // coefficient  matrix
-        A1= W1.inverseByLU()*S1;
-        A2= W2.inverseByLU()*S2;
-        A3= W3.inverseByLU()*S3;
-        A4= W4.inverseByLU()*S4;
-        A5= W5.inverseByLU()*S5;
-        A6= W5.inverseByLU()*S6;
+        // segments with closed-form coefficients
+        path.getS(S1, S2, S3, S4, S5);
 
         double dt = 0.01;
         ros::Rate loop(1/dt);
         int num=0, inter=0;
+        PreviewPublisher preview(node, dt);
 
-        cout << "--------------------------------trajectory-------------------------------" << endl;
-      while (ros::ok())
-      {
+        // setpoint of tick k, held at the end of the trajectory
+        auto sample = [&](int k, vpColVector &P, vpColVector &Vel, vpColVector &Acc)
+        {
+                k = std::min<int>(k, t_4/dt);
                 // relative time from the beginning
-                t=t_0+inter*dt;
-                // Check the time period 
-                if (inter<t_1/dt)
+                const double t=t_0+k*dt;
+                // Check the time period, each segment is evaluated once
+                Trajectory::Segment::Vector s, ds, dds, h, dh, ddh;
+                if (k<t_1/dt)
                 {
-                  P[0]= x_i[0]; P[1]= x_i[1]; P[2]=h_b*path.getposition(t,A1)+x_i[2];
-                  Vel[2]=h_b*path.getvelocity(t,A1);
-                  Acc[2]=h_b*path.getacceleration(t,A1);
+                  S1.evaluate(t, s, ds, dds);
+                  P[0]= x_i[0]; P[1]= x_i[1]; P[2]=h_b*s[0]+x_i[2];
+                  Vel[0]=0; Vel[1]=0; Vel[2]=h_b*ds[0];
+                  Acc[0]=0; Acc[1]=0; Acc[2]=h_b*dds[0];
                 }
-                else if (inter >= t_1/dt && inter < t_2/dt)
+                else if (k >= t_1/dt && k < t_2/dt)
                 {
-                  P[0]= x_i[0]+w*path.getposition(t,A5); P[1]= x_i[1]+l*path.getposition(t,A5); P[2]=(h_c-h_b)*path.getposition(t,A2)+h_b+x_i[2];
-                  Vel[0]= w*path.getvelocity(t,A5); Vel[1]=l*path.getvelocity(t,A5); Vel[2]=(h_c-h_b)*path.getvelocity(t,A2);
-                  Acc[0]=w*path.getacceleration(t,A5);  Acc[1]=l*path.getacceleration(t,A5); Acc[2]=(h_c-h_b)*path.getacceleration(t,A2);
+                  S5.evaluate(t, h, dh, ddh);
+                  S2.evaluate(t, s, ds, dds);
+                  P[0]= x_i[0]+w*h[0]; P[1]= x_i[1]+l*h[0]; P[2]=(h_c-h_b)*s[0]+h_b+x_i[2];
+                  Vel[0]= w*dh[0]; Vel[1]=l*dh[0]; Vel[2]=(h_c-h_b)*ds[0];
+                  Acc[0]=w*ddh[0];  Acc[1]=l*ddh[0]; Acc[2]=(h_c-h_b)*dds[0];
                 }
-                else if (inter>= t_2/dt && inter< t_3/dt)
+                else if (k>= t_2/dt && k< t_3/dt)
                 {
-                  P[0]= x_i[0]+w*path.getposition(t,A5); P[1]= x_i[1]+l*path.getposition(t,A5); P[2]=-(h_c-h_b)*path.getposition(t,A3)+h_c+x_i[2];
-                  Vel[0]= w*path.getvelocity(t,A5); Vel[1]=l*path.getvelocity(t,A5); Vel[2]= -(h_c-h_b)*path.getvelocity(t,A3);
-                  Acc[0]=w*path.getacceleration(t,A5);  Acc[1]=l*path.getacceleration(t,A5); Acc[2]= -(h_c-h_b)*path.getacceleration(t,A3);
+                  S5.evaluate(t, h, dh, ddh);
+                  S3.evaluate(t, s, ds, dds);
+                  P[0]= x_i[0]+w*h[0]; P[1]= x_i[1]+l*h[0]; P[2]=-(h_c-h_b)*s[0]+h_c+x_i[2];
+                  Vel[0]= w*dh[0]; Vel[1]=l*dh[0]; Vel[2]= -(h_c-h_b)*ds[0];
+                  Acc[0]=w*ddh[0];  Acc[1]=l*ddh[0]; Acc[2]= -(h_c-h_b)*dds[0];
                 }
-                else if (inter>= t_3/dt && inter<= t_4/dt)
+                else
                 {
-                  P[0]= x_f[0]; P[1]= x_f[1]; P[2]= -h_b*path.getposition(t,A4)+h_b+x_i[2];
-                  Vel[0]=0;  Vel[1]=0; Vel[2]= -h_b*path.getvelocity(t,A4);
-                  Acc[0]=0; Acc[1]=0; Acc[2]= -h_b*path.getacceleration(t,A4);
+                  S4.evaluate(t, s, ds, dds);
+                  P[0]= x_f[0]; P[1]= x_f[1]; P[2]= -h_b*s[0]+h_b+x_i[2];
+                  Vel[0]=0;  Vel[1]=0; Vel[2]= -h_b*ds[0];
+                  Acc[0]=0; Acc[1]=0; Acc[2]= -h_b*dds[0];
                 }
+        };
+
+        CDPR_INFO("--------------------------------trajectory-------------------------------");
+      while (ros::ok())
+      {
+                sample(inter, P, Vel, Acc);
 
-                path.sendDesiredpara(P, Vel, Acc) ;
+                // preview every few ticks, single setpoints if required
+                preview.update(inter, sample);
+                if(preview.legacy())
+                    path.sendDesiredpara(P, Vel, Acc) ;
                 pose.buildFrom(P[0], P[1],  P[2],  P[3],  P[4],  P[5]);
 
                 // log
                 logger.update();
 
-                cout << " Desired position" << P.t() <<endl;
-                cout << " Desired velocity" << Vel .t()<<endl;
-                cout << " Desired acceleration" << Acc.t() <<endl;
+                CDPR_DEBUG(" Desired position" << P.t());
+                CDPR_DEBUG(" Desired velocity" << Vel .t());
+                CDPR_DEBUG(" Desired acceleration" << Acc.t());
 
                 inter++;
                 ros::spinOnce();
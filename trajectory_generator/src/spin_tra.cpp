@@ -1,7 +1,10 @@
 #include <log2plot/logger.h>
 #include <trajectory_generator/spin_tra.h>
+#include <trajectory_generator/preview.h>
+#include <trajectory_generator/quintic.h>
 #include <visp/vpIoTools.h>
 #include <math.h>
+#include <cdpr/log.h>
 
 
 //-------------------------------------------------------------------------------------------------------------
@@ -13,10 +16,10 @@ using namespace log2plot;
 
 int main(int argc, char ** argv)
 {
-    cout.precision(3);
     // init ROS node
     ros::init(argc, argv, "spin_tra");
     ros::NodeHandle node;
+    cdpr_log::setLevel(ros::param::param<std::string>("~log_level", "info"));
 
     Trajectory path(node);
     std::string dir = "/home/" + vpIoTools::getUserName() + "/Results/cdpr/";
@@ -31,10 +34,8 @@ int main(int argc, char ** argv)
 
     // initialization
     vpColVector x_i(3), x_f(3);
-    vpColVector P, Vel, Acc, Ax, Ay, Az, Xx,Xy,Xz;
+    vpColVector P, Vel, Acc, Xx,Xy,Xz;
     double t_0, t_1,t;
-    vpMatrix T;
-    T.resize(6,6); 
 
     P.resize(6); Vel.resize(6); Acc.resize(6);
 
@@ -45,45 +46,57 @@ int main(int argc, char ** argv)
     //beta1= (x_i[0]-x_f[0])/((x_f[2]-x_i[2])*cos(t_1*u));
     //beta2= (x_i[1]-x_f[1])/((x_f[2]-x_i[2])*sin(t_1*u));
 
-    //  obtain the time matrix
-    T=path.getTmatrix(t_0,t_1);
     // gain condition vector
     path.getX(Xx, Xy, Xz);
-    
-    // coefficient  matrix 
-    Ax= T.inverseByLU()*Xx;
-    Ay= T.inverseByLU()*Xy;
-    Az= T.inverseByLU()*Xz;
 
+    // S(t) on the three axes as a single segment, closed-form coefficients
+    typedef QuinticSegment<3> Segment;
+    Segment::Vector S0, S1;
+    S0 << Xx[0], Xy[0], Xz[0];
+    S1 << Xx[3], Xy[3], Xz[3];
+    const Segment S(t_0, t_1, S0, S1);
 
     double dt = 0.01;
     ros::Rate loop(1/dt);
     int num=0, inter=0;
     num= t_1/dt;
 
+    PreviewPublisher preview(node, dt);
+
+    // setpoint of tick k, held at the end of the trajectory
+    auto sample = [&](int k, vpColVector &P, vpColVector &Vel, vpColVector &Acc)
+    {
+        // relative time from the start
+        const double t=t_0+std::min(k, num)*dt;
+
+        // S(t), S(t)_dot and S(t)_ddot of the x, y, z axes in one evaluation
+        Segment::Vector s, ds, dds;
+        S.evaluate(t, s, ds, dds);
+        const double cx = cos(u*s[0]), sx = sin(u*s[0]), cy = cos(u*s[1]), sy = sin(u*s[1]);
+
+        // Spin trajectory generator with variational radius 
+        // desired setpoints pose
+        P[2]=x_i[2] + alpha*s[2];
+        P[0]= x_i[0] + beta*(P[2]-x_i[2])*cx;
+        P[1]= x_i[1] + beta*(P[2]-x_i[2])*sy;
+        // desired velocity computation
+        Vel[2]= alpha*ds[2];
+        Vel[0]= - beta* (P[2]-x_i[2]) *sx*ds[0];
+        Vel[1]=  beta* (P[2]-x_i[2])*cy*ds[1];
+        // desierd acceleration computation
+        Acc[2]= alpha*dds[2];
+        Acc[0]= -beta*(P[2]-x_i[2]) *( cx*ds[0]*ds[0]+sx*dds[0]);
+        Acc[1]= -beta* (P[2]-x_i[2])*(sx*ds[1]*ds[1]-cx*dds[1]);
+    };
+
+  CDPR_INFO("--------------------------trajectory------------------");
   while (ros::ok())
   {
 
-        cout << "--------------------------trajectory------------------" << endl; 
          // relative time from the start
          t=t_0+inter*dt;
+         sample(inter, P, Vel, Acc);
 
-        // Spin trajectory generator with variational radius 
-        if (inter<= num)
-             {
-                        // desired setpoints pose
-                        P[2]=x_i[2] + alpha*path.getS(t,Az); 
-                        P[0]= x_i[0] + beta*(P[2]-x_i[2])*cos(u*path.getS(t,Ax)); 
-                        P[1]= x_i[1] + beta*(P[2]-x_i[2])*sin(u*path.getS(t,Ay)); 
-                        // desired velocity computation
-                        Vel[2]= alpha*path.getSdot(t, Az); 
-                        Vel[0]= - beta* (P[2]-x_i[2]) *sin(u*path.getS(t,Ax))*path.getSdot(t, Ax) ; 
-                        Vel[1]=  beta* (P[2]-x_i[2])*cos(u*path.getS(t,Ay)) *path.getSdot(t, Ay);
-                        // desierd acceleration computation
-                        Acc[2]= alpha*path.getSddot(t, Az);  
-                        Acc[0]= -beta*(P[2]-x_i[2]) *( cos(u*path.getS(t,Ax)) *path.getSdot(t, Ax) *path.getSdot(t, Ax)+sin(u*path.getS(t,Ax))*path.getSddot(t, Ax)); 
-                        Acc[1]= -beta* (P[2]-x_i[2])*(sin(u*path.getS(t,Ax)) *path.getSdot(t, Ay)*path.getSdot(t, Ay)-cos(u*path.getS(t,Ax))*path.getSddot(t, Ay));
-                 }
                 // Spin trajectory generator without variational radius 
 /*                if (inter<= num)
                  {
@@ -113,15 +126,18 @@ int main(int argc, char ** argv)
                 Acc[1]= beta2* Acc[2]*sin(u*t)+u*beta2*Vel[2]*cos(u*t) - u*u*beta2*(P[2]-x_i[2])*sin(u*t);
             }*/
 
-        path.sendDesiredpara(P, Vel, Acc) ;
+        // preview every few ticks, single setpoints if required
+        preview.update(inter, sample);
+        if(preview.legacy())
+            path.sendDesiredpara(P, Vel, Acc) ;
         pose.buildFrom(P[0], P[1],  P[2],  P[3],  P[4],  P[5]);
 
         // log
         logger.update();
 
-        cout << " Desired position: "<< P.t() <<endl;
-        cout << " Desired velocity:" << Vel .t()<<endl;
-        cout << " Desired acceleration:" << Acc.t() <<endl;
+        CDPR_DEBUG(" Desired position: "<< P.t());
+        CDPR_DEBUG(" Desired velocity:" << Vel .t());
+        CDPR_DEBUG(" Desired acceleration:" << Acc.t());
         inter++;
 
         ros::spinOnce();
@@ -1,8 +1,11 @@
  
 #include <trajectory_generator/straight_line.h>
+#include <trajectory_generator/preview.h>
+#include <trajectory_generator/quintic.h>
 #include <log2plot/logger.h>
 #include <chrono>
 #include <visp/vpIoTools.h>
+#include <cdpr/log.h>
 
 /*
 *-----------------------------------------------------------------------------------------------------
@@ -17,10 +20,10 @@ using namespace log2plot;
 
 int main(int argc, char ** argv)
 {
-        cout.precision(3);
         // init ROS node
         ros::init(argc, argv, "trajectory_generator");
         ros::NodeHandle node;
+        cdpr_log::setLevel(ros::param::param<std::string>("~log_level", "info"));
 
         Trajectory path(node);
         std::string dir = "/home/" + vpIoTools::getUserName() + "/Results/cdpr/";
@@ -40,53 +43,53 @@ int main(int argc, char ** argv)
         std::chrono::time_point<std::chrono::system_clock> start, end;
         std::chrono::duration<double> elapsed_seconds;
 
-        vpRowVector x_i(3), x_f(3), v_i(3), v_f(3), a_i(3), a_f(3);
-        vpRowVector P, Vel, Acc;
+        vpRowVector x_i(3), x_f(3);
+        vpColVector P(6), Vel(6), Acc(6);
         double t_i,t_f;
-        vpMatrix L, A, C;
-        L.resize(6,6);
-        A.resize(6,3);
-        C.resize(6,3);
 
         path.InitializeTime(t_i,t_f);
         path.InitializePose(x_i,x_f);
 
-        for (int i = 0; i < 3; ++i)
-        {
-          C[0][i]=x_i[i];
-          C[3][i]=x_f[i];
-        }
-        cout << " C matrix:"<< "  \n"<< C<<endl;
-         L=path.getLmatrix(t_f);
-         cout << " L matrix:"<< "  \n"<< L<<endl;
-         A= L.inverseByLU()*C;
-        cout << " A matrix:"<< "  \n"<< A<<endl;
-        cout << "  matrix:"<< "  \n"<<L*A<<endl;
+        // rest to rest segment on the 3 axes, closed-form coefficients
+        typedef QuinticSegment<3> Segment;
+        Segment::Vector p_i, p_f;
+        p_i << x_i[0], x_i[1], x_i[2];
+        p_f << x_f[0], x_f[1], x_f[2];
+        const Segment line(0, t_f, p_i, p_f);
 
         double dt = 0.01;
         ros::Rate loop(1/dt);
         int num=0, inter=0;
         num= t_f/dt;
-        cout << "-----------------------------trajectory------------------" <<fixed << endl;
+        PreviewPublisher preview(node, dt);
+
+        // setpoint of tick k, held at the end of the trajectory
+        auto sample = [&](int k, vpColVector &P, vpColVector &Vel, vpColVector &Acc)
+        {
+                const double t = t_i + std::min(k, num)*dt;
+                Segment::Vector p, v, a;
+                line.evaluate(t, p, v, a);
+                for (int i = 0; i < 3; ++i)
+                {
+                  P[i] = p[i]; Vel[i] = v[i]; Acc[i] = a[i];
+                }
+        };
+
+        CDPR_INFO("-----------------------------trajectory------------------");
         while (ros::ok())
         {
                 // relative time from the beginning
                 t=t_i+inter*dt;
-                //t = ros::Time::now().toSec() ;
-                cout << "timer" << " "<<t << endl;
+                CDPR_DEBUG("timer" << " "<<t);
                 // extract the current time
                 start = std::chrono::system_clock::now();
-                cout << "interation number:" <<" "<< inter <<endl;
-                // Check the time period 
-                if (inter<= num)
-                {
-                  P=path.getposition(t,A);
-                  Vel=path.getvelocity(t,A);
-                  Acc=path.getacceleration(t,A);
-                  path.sendDesiredpara(P.t(), Vel.t(), Acc.t());
-                }
-                else
-                 path.sendDesiredpara(P.t(), Vel.t(), Acc.t());
+                CDPR_DEBUG("interation number:" <<" "<< inter);
+                sample(inter, P, Vel, Acc);
+
+                // preview every few ticks, single setpoints if required
+                preview.update(inter, sample);
+                if(preview.legacy())
+                  path.sendDesiredpara(P, Vel, Acc);
 
                 // construct the pose vector
                 pose.buildFrom(P[0], P[1],  P[2],  P[3],  P[4],  P[5]);
@@ -99,9 +102,9 @@ int main(int argc, char ** argv)
                 logger.update();
 
                 // print the desired parameters
-                cout << " Desired position:" << " "<<P.t() <<endl;
-                cout << " Desired velocity:" << " "<<Vel.t() <<endl;
-                cout << " Desired acceleration:" << " "<<Acc.t() <<endl;
+                CDPR_DEBUG(" Desired position:" << " "<<P.t());
+                CDPR_DEBUG(" Desired velocity:" << " "<<Vel.t());
+                CDPR_DEBUG(" Desired acceleration:" << " "<<Acc.t());
 
                 inter++;
                 ros::spinOnce();
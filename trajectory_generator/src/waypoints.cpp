@@ -0,0 +1,111 @@
+#include <trajectory_generator/spline.h>
+#include <trajectory_generator/preview.h>
+#include <trajectory_generator/trajectory_file.h>
+#include <cdpr/log.h>
+#include <cdpr/param.h>
+#include <cdpr/workspace_map.h>
+
+/*
+*-----------------------------------------------------------------------------------------------------
+*  C2 spline trajectory through a list of waypoints, see spline.h
+*  one waypoint per line of ~file: t x y z [rx ry rz], lines starting with # are ignored
+*  or the ~waypoints parameter: list of [t, x, y, z] or [t, x, y, z, rx, ry, rz]
+*  the orientation is given as Rxyz angles, the home orientation of the model if not given
+*  the setpoints are checked against ~workspace_map if given (workspace_determination)
+*------------------------------------------------------------------------------------------------------
+*/
+
+using namespace std;
+
+int main(int argc, char ** argv)
+{
+        ros::init(argc, argv, "waypoints");
+        ros::NodeHandle node;
+        cdpr_log::setLevel(ros::param::param<std::string>("~log_level", "info"));
+
+        vector<double> rpy(3, 0);
+        node.getParam("model/platform/position/rpy", rpy);
+
+        vector<double> t;
+        vector<Eigen::Vector3d> position;
+        vector<Eigen::Matrix3d> orientation;
+        string file;
+        XmlRpc::XmlRpcValue list;
+        if(ros::param::get("~file", file))
+        {
+                string line;
+                if(!trajectory_file::loadWaypoints(file, rpy, t, position, orientation, line) && !line.empty())
+                {
+                        CDPR_ERROR("waypoints: bad line in " << file << ": " << line);
+                        return 1;
+                }
+        }
+        else if(ros::param::get("~waypoints", list))
+        {
+                for(int k = 0; k < list.size(); ++k)
+                {
+                        vector<double> w;
+                        for(int i = 0; i < list[k].size(); ++i)
+                                w.push_back(cdpr_param::toDouble(list[k][i]));
+                        if(!trajectory_file::addWaypoint(w, rpy, t, position, orientation))
+                        {
+                                CDPR_ERROR("waypoints: waypoint " << k << " should be [t, x, y, z] or [t, x, y, z, rx, ry, rz]");
+                                return 1;
+                        }
+                }
+        }
+
+        PoseSpline spline;
+        if(!spline.build(t, position, orientation))
+        {
+                CDPR_ERROR("waypoints: needs at least 2 waypoints with increasing times");
+                return 1;
+        }
+
+        double dt = 0.01;
+        ros::Rate loop(1/dt);
+        const unsigned int ticks = ceil((spline.end() - spline.start())/dt) + 1;
+
+        string workspace_file;
+        if(ros::param::get("~workspace_map", workspace_file))
+        {
+                WorkspaceMap workspace(workspace_file);
+                PoseSpline::Vector6 p, v, a;
+                auto sample_position = [&](unsigned int k, double *P)
+                {
+                        spline.evaluate(spline.start() + k*dt, p, v, a);
+                        for(unsigned int i = 0; i < 3; ++i)
+                                P[i] = p[i];
+                };
+                unsigned int k;
+                if(!workspace.ok())
+                        CDPR_WARN("waypoints: " << workspace_file << " is not a workspace map");
+                else if((k = workspace.firstOutside(ticks, sample_position)) < ticks)
+                        CDPR_WARN("waypoints: the trajectory leaves the workspace at t = " << spline.start() + k*dt << " s");
+        }
+        PreviewPublisher preview(node, dt);
+        if(preview.legacy())
+                CDPR_WARN("waypoints: only publishes the trajectory preview");
+
+        // setpoint of tick k, held at the end of the trajectory
+        PoseSpline::Vector6 p, v, a;
+        auto sample = [&](int k, vpColVector &P, vpColVector &Vel, vpColVector &Acc)
+        {
+                spline.evaluate(spline.start() + k*dt, p, v, a);
+                for(unsigned int i = 0; i < 6; ++i)
+                {
+                        P[i] = p[i]; Vel[i] = v[i]; Acc[i] = a[i];
+                }
+        };
+
+        CDPR_INFO("waypoints: " << t.size() << " waypoints over " << spline.end() - spline.start() << " s");
+        int inter = 0;
+        while (ros::ok())
+        {
+                preview.update(inter, sample);
+                inter++;
+                ros::spinOnce();
+                loop.sleep();
+        }
+        return 0;
+};
@@ -0,0 +1,177 @@
+#ifndef workspace_INTERVAL_H
+#define workspace_INTERVAL_H
+
+#include <workspace_determination/workspace.h>
+#include <cdpr_controllers/lp.h>
+#include <cdpr_controllers/qp.h>
+#include <algorithm>
+#include <cmath>
+
+// certification of whole boxes of positions at a fixed orientation with interval analysis
+//
+// the structure matrix is bounded element-wise over the box: [W] = W0 +/- Rw
+// inside:  tau0 with margin m0 for W0, for any W in [W] the tensions tau0 + W0+.(I + D.W0+)^-1.(W0 - W).tau0 generate w
+//          and stay in the bounds if |W0+|.|Rw.|tau0||/(1 - |Rw.|W0+||) <= m0 (infinity norms)
+// outside: y = w - W0.tau* with tau* the closest feasible wrench of W0 (box-constrained QP) separates w from
+//          every feasible wrench of every W in [W] if max_tau y.W.tau < y.w over the interval (Farkas)
+
+namespace workspace
+{
+
+enum BoxStatus {OUTSIDE = 0, INSIDE = 1, UNDECIDED = 2};
+
+// bounds of x/sqrt(x^2 + r) for x in [lo, hi] and r in [r_lo, r_hi], increasing in x
+inline void unitBounds(double lo, double hi, double r_lo, double r_hi, double &u_lo, double &u_hi)
+{
+    auto f = [](double x, double r) {return x == 0 ? 0 : x/std::sqrt(x*x + r);};
+    u_lo = f(lo, lo >= 0 ? r_hi : r_lo);
+    u_hi = f(hi, hi >= 0 ? r_lo : r_hi);
+}
+
+// bounds of x^2 for x in [lo, hi]
+inline void squareBounds(double lo, double hi, double &s_lo, double &s_hi)
+{
+    if(lo >= 0)
+    {
+        s_lo = lo*lo; s_hi = hi*hi;
+    }
+    else if(hi <= 0)
+    {
+        s_lo = hi*hi; s_hi = lo*lo;
+    }
+    else
+    {
+        s_lo = 0; s_hi = std::max(lo*lo, hi*hi);
+    }
+}
+
+// element-wise bounds of the structure matrix in world frame for positions in [lo, hi] at orientation R
+inline void intervalW(const Workspace &space, const vpRotationMatrix &R, const double lo[3], const double hi[3],
+                      vpMatrix &W_lo, vpMatrix &W_hi)
+{
+    const unsigned int n = space.n_cables();
+    W_lo.resize(6, n, false);
+    W_hi.resize(6, n, false);
+    for(unsigned int i = 0; i < n; ++i)
+    {
+        // b is constant, d = Pf - p - b is a box
+        double b[3], d_lo[3], d_hi[3], s_lo[3], s_hi[3], u_lo[3], u_hi[3];
+        for(unsigned int k = 0; k < 3; ++k)
+            b[k] = R[k][0]*space.platformPoint(i)[0] + R[k][1]*space.platformPoint(i)[1] + R[k][2]*space.platformPoint(i)[2];
+        for(unsigned int k = 0; k < 3; ++k)
+        {
+            d_lo[k] = space.framePoint(i)[k] - hi[k] - b[k];
+            d_hi[k] = space.framePoint(i)[k] - lo[k] - b[k];
+            squareBounds(d_lo[k], d_hi[k], s_lo[k], s_hi[k]);
+        }
+        // u_k = d_k / sqrt(d_k^2 + other squares)
+        for(unsigned int k = 0; k < 3; ++k)
+        {
+            const unsigned int k1 = (k+1)%3, k2 = (k+2)%3;
+            unitBounds(d_lo[k], d_hi[k], s_lo[k1] + s_lo[k2], s_hi[k1] + s_hi[k2], u_lo[k], u_hi[k]);
+            W_lo[k][i] = u_lo[k];
+            W_hi[k][i] = u_hi[k];
+        }
+        // b x u
+        for(unsigned int k = 0; k < 3; ++k)
+        {
+            const unsigned int k1 = (k+1)%3, k2 = (k+2)%3;
+            // b[k1].u[k2] - b[k2].u[k1]
+            const double p1 = b[k1]*u_lo[k2], p2 = b[k1]*u_hi[k2], q1 = b[k2]*u_lo[k1], q2 = b[k2]*u_hi[k1];
+            W_lo[3+k][i] = std::min(p1, p2) - std::max(q1, q2);
+            W_hi[3+k][i] = std::max(p1, p2) - std::min(q1, q2);
+        }
+    }
+}
+
+// classifies the box of structure matrices [W_lo, W_hi] for the wrench set of the model
+inline BoxStatus classify(const Workspace &space, const vpMatrix &W_lo, const vpMatrix &W_hi)
+{
+    const unsigned int n = space.n_cables();
+    double f_min, f_max;
+    space.tensionMinMax(f_min, f_max);
+    const vpMatrix W0 = 0.5*(W_lo + W_hi), Rw = 0.5*(W_hi - W_lo);
+
+    vpMatrix W0p;
+    double bound_W0p = 0, bound_A = 0;
+    const bool full_rank = W0.pseudoInverse(W0p, 1e-9) == 6;
+    if(full_rank)
+    {
+        // |W0+| and |Rw.|W0+||
+        for(unsigned int i = 0; i < n; ++i)
+        {
+            double sum = 0;
+            for(unsigned int k = 0; k < 6; ++k)
+                sum += std::abs(W0p[i][k]);
+            bound_W0p = std::max(bound_W0p, sum);
+        }
+        for(unsigned int k = 0; k < 6; ++k)
+        {
+            double sum = 0;
+            for(unsigned int l = 0; l < 6; ++l)
+            {
+                double a = 0;
+                for(unsigned int i = 0; i < n; ++i)
+                    a += Rw[k][i]*std::abs(W0p[i][l]);
+                sum += a;
+            }
+            bound_A = std::max(bound_A, sum);
+        }
+    }
+
+    bool inside = true;
+    vpColVector tau;
+    for(const auto &w: space.wrenchSet())
+    {
+        const double m0 = solve_lp::tensionMargin(W0, w, f_min, f_max, tau);
+        if(m0 >= 0)
+        {
+            if(!inside || !full_rank || bound_A >= 1)
+            {
+                inside = false;
+                continue;
+            }
+            double r = 0;
+            for(unsigned int k = 0; k < 6; ++k)
+            {
+                double sum = 0;
+                for(unsigned int i = 0; i < n; ++i)
+                    sum += Rw[k][i]*std::abs(tau[i]);
+                r = std::max(r, sum);
+            }
+            inside = bound_W0p*r/(1 - bound_A) <= m0;
+            continue;
+        }
+
+        // separating direction from the closest wrench that W0 can generate
+        inside = false;
+        vpMatrix C(2*n, n);
+        vpColVector d(2*n), x(n);
+        std::vector<bool> active;
+        for(unsigned int i = 0; i < n; ++i)
+        {
+            C[i][i] = 1;
+            d[i] = f_max;
+            C[n+i][i] = -1;
+            d[n+i] = -f_min;
+        }
+        solve_qp::solveQPi(W0, w, C, d, x, active);
+        const vpColVector y = w - W0*x;
+        double reach = 0;
+        for(unsigned int i = 0; i < n; ++i)
+        {
+            // bounds of y.W_i, then the best tension for it
+            double c_hi = 0;
+            for(unsigned int k = 0; k < 6; ++k)
+                c_hi += std::max(y[k]*W_lo[k][i], y[k]*W_hi[k][i]);
+            reach += std::max(f_min*c_hi, f_max*c_hi);
+        }
+        if(reach < vpColVector::dotProd(y, w))
+            return OUTSIDE;
+    }
+    return inside ? INSIDE : UNDECIDED;
+}
+
+}
+
+#endif // workspace_INTERVAL_H
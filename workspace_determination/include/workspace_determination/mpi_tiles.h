@@ -0,0 +1,136 @@
+#ifndef workspace_MPI_TILES_H
+#define workspace_MPI_TILES_H
+
+#include <mpi.h>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+// master-worker distribution of tiles over MPI ranks, with dynamic load balancing
+//
+// rank 0 hands out one tile at a time to the first idle worker, the cost of a tile may vary a lot
+// the results come back as uint32 buffers and are merged by rank 0 in tile order: tiles finished early
+// are kept until their turn, so that the merge can stream to a file
+// with a single rank, rank 0 evaluates all tiles itself
+//
+// only the calling thread uses MPI, the evaluation may use threads (MPI_THREAD_FUNNELED)
+
+namespace workspace
+{
+namespace mpi
+{
+
+enum {TAG_TILE = 1, TAG_RESULT = 2, TAG_STOP = 3};
+
+struct Stats
+{
+    std::vector<unsigned int> tiles;    // tiles evaluated by each rank
+    std::vector<double> busy;           // time spent evaluating by each rank [s]
+    size_t pending;                     // most results kept waiting for their turn
+};
+
+// evaluate(tile, buffer) fills the buffer of a tile on any rank
+// merge(tile, buffer) is called on rank 0 for tiles 0, 1, 2...
+// stats are only complete on rank 0
+template <class Evaluate, class Merge>
+Stats distribute(MPI_Comm comm, uint32_t tiles, const Evaluate &evaluate, const Merge &merge)
+{
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    Stats stats;
+    stats.tiles.resize(size, 0);
+    stats.busy.resize(size, 0);
+    stats.pending = 0;
+    std::vector<uint32_t> buffer;
+
+    auto timed = [&](uint32_t tile)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        buffer.clear();
+        evaluate(tile, buffer);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    if(size == 1)
+    {
+        for(uint32_t tile = 0; tile < tiles; ++tile)
+        {
+            stats.busy[0] += timed(tile);
+            stats.tiles[0]++;
+            merge(tile, buffer);
+        }
+        return stats;
+    }
+
+    if(rank)
+    {
+        // result messages: tile, then its buffer, the first one is empty to ask for work
+        std::vector<uint32_t> message(1, tiles);
+        double busy = 0;
+        unsigned int count = 0;
+        while(true)
+        {
+            MPI_Send(message.data(), message.size(), MPI_UINT32_T, 0, TAG_RESULT, comm);
+            MPI_Status status;
+            uint32_t tile;
+            MPI_Recv(&tile, 1, MPI_UINT32_T, 0, MPI_ANY_TAG, comm, &status);
+            if(status.MPI_TAG == TAG_STOP)
+                break;
+            busy += timed(tile);
+            count++;
+            message.resize(1 + buffer.size());
+            message[0] = tile;
+            std::copy(buffer.begin(), buffer.end(), message.begin() + 1);
+        }
+        MPI_Gather(&busy, 1, MPI_DOUBLE, nullptr, 1, MPI_DOUBLE, 0, comm);
+        MPI_Gather(&count, 1, MPI_UNSIGNED, nullptr, 1, MPI_UNSIGNED, 0, comm);
+        return stats;
+    }
+
+    uint32_t next = 0, merged = 0;
+    int workers = size - 1;
+    std::map<uint32_t, std::vector<uint32_t>> pending;
+    std::vector<uint32_t> message;
+    while(workers)
+    {
+        MPI_Status status;
+        MPI_Probe(MPI_ANY_SOURCE, TAG_RESULT, comm, &status);
+        int count;
+        MPI_Get_count(&status, MPI_UINT32_T, &count);
+        message.resize(count);
+        MPI_Recv(message.data(), count, MPI_UINT32_T, status.MPI_SOURCE, TAG_RESULT, comm, MPI_STATUS_IGNORE);
+
+        // hand out the next tile first, the worker should not wait for the merge
+        if(next < tiles)
+        {
+            MPI_Send(&next, 1, MPI_UINT32_T, status.MPI_SOURCE, TAG_TILE, comm);
+            next++;
+        }
+        else
+        {
+            MPI_Send(&next, 1, MPI_UINT32_T, status.MPI_SOURCE, TAG_STOP, comm);
+            workers--;
+        }
+
+        if(message[0] < tiles)
+        {
+            pending[message[0]].assign(message.begin() + 1, message.end());
+            stats.pending = std::max(stats.pending, pending.size());
+            for(auto it = pending.begin(); it != pending.end() && it->first == merged; it = pending.erase(it), merged++)
+                merge(merged, it->second);
+        }
+    }
+
+    double busy = 0;
+    unsigned int count = 0;
+    MPI_Gather(&busy, 1, MPI_DOUBLE, stats.busy.data(), 1, MPI_DOUBLE, 0, comm);
+    MPI_Gather(&count, 1, MPI_UNSIGNED, stats.tiles.data(), 1, MPI_UNSIGNED, 0, comm);
+    return stats;
+}
+
+}
+}
+
+#endif // workspace_MPI_TILES_H
@@ -0,0 +1,129 @@
+#ifndef workspace_OCTREE_H
+#define workspace_OCTREE_H
+
+#include <workspace_determination/parallel.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace workspace
+{
+
+// adaptive sampling of a margin over a lattice of size[0] x size[1] x size[2] points, x varies fastest
+// each size should be a multiple of 2^levels plus one
+//
+// the margin is first evaluated at the corners of cells of 2^levels points, then the cells whose corners
+// disagree on feasibility or have a margin below near are split in 8, down to the lattice step
+// features smaller than the first cells may be missed if they do not reach a corner
+//
+// values: margin at all lattice points, evaluated or interpolated from the corners of the smallest cell around
+// margin(i, j, k, thread) is called in parallel, returns the number of evaluations
+template <class F>
+size_t adaptiveSample(const unsigned int size[3], unsigned int levels, double near, unsigned int threads,
+                      const F &margin, std::vector<float> &values)
+{
+    typedef std::array<unsigned int, 3> Cell;
+    auto index = [&](unsigned int i, unsigned int j, unsigned int k)
+    {
+        return i + (size_t) size[0]*(j + (size_t) size[1]*k);
+    };
+
+    values.assign((size_t) size[0]*size[1]*size[2], NAN);
+    unsigned int s = 1u << levels;
+    std::vector<Cell> cells, next;
+    std::vector<std::pair<Cell, unsigned int>> leaves;
+    for(unsigned int k = 0; k+1 < std::max(size[2], 2u); k += s)
+        for(unsigned int j = 0; j+1 < std::max(size[1], 2u); j += s)
+            for(unsigned int i = 0; i+1 < std::max(size[0], 2u); i += s)
+                cells.push_back({i, j, k});
+
+    // corners of a cell, clamped for flat lattices
+    auto corner = [&](const Cell &c, unsigned int n, unsigned int s)
+    {
+        return index(std::min(c[0] + (n & 1 ? s : 0), size[0]-1),
+                     std::min(c[1] + (n & 2 ? s : 0), size[1]-1),
+                     std::min(c[2] + (n & 4 ? s : 0), size[2]-1));
+    };
+
+    size_t evaluations = 0;
+    std::vector<size_t> todo;
+    for(; s && cells.size(); s /= 2)
+    {
+        // corners not evaluated yet
+        todo.clear();
+        for(const auto &c: cells)
+            for(unsigned int n = 0; n < 8; ++n)
+            {
+                const size_t idx = corner(c, n, s);
+                if(std::isnan(values[idx]))
+                    todo.push_back(idx);
+            }
+        std::sort(todo.begin(), todo.end());
+        todo.erase(std::unique(todo.begin(), todo.end()), todo.end());
+        parallelFor(todo.size(), threads, [&](size_t n, unsigned int thread)
+        {
+            const size_t idx = todo[n];
+            values[idx] = margin(idx % size[0], (idx / size[0]) % size[1], idx / ((size_t) size[0]*size[1]), thread);
+        });
+        evaluations += todo.size();
+
+        // split the cells on the boundary
+        next.clear();
+        for(const auto &c: cells)
+        {
+            unsigned int feasible = 0;
+            bool split = false;
+            for(unsigned int n = 0; n < 8; ++n)
+            {
+                const float m = values[corner(c, n, s)];
+                feasible += m >= 0;
+                split |= std::abs(m) < near;
+            }
+            split |= feasible != 0 && feasible != 8;
+            if(split && s > 1)
+            {
+                for(unsigned int n = 0; n < 8; ++n)
+                {
+                    const Cell child = {c[0] + (n & 1 ? s/2 : 0), c[1] + (n & 2 ? s/2 : 0), c[2] + (n & 4 ? s/2 : 0)};
+                    if(child[0]+1 < std::max(size[0], 2u) && child[1]+1 < std::max(size[1], 2u) && child[2]+1 < std::max(size[2], 2u))
+                        next.push_back(child);
+                }
+            }
+            else
+                leaves.push_back({c, s});
+        }
+        cells.swap(next);
+    }
+
+    // trilinear interpolation in the leaves, each point belongs to the leaf where it is not on the upper faces
+    parallelFor(leaves.size(), threads, [&](size_t l, unsigned int)
+    {
+        const Cell &c = leaves[l].first;
+        const unsigned int s = leaves[l].second;
+        unsigned int end[3];
+        double v[8];
+        for(unsigned int a = 0; a < 3; ++a)
+            end[a] = c[a] + s < size[a]-1 ? c[a] + s : size[a];
+        for(unsigned int n = 0; n < 8; ++n)
+            v[n] = values[corner(c, n, s)];
+        for(unsigned int k = c[2]; k < end[2]; ++k)
+            for(unsigned int j = c[1]; j < end[1]; ++j)
+                for(unsigned int i = c[0]; i < end[0]; ++i)
+                {
+                    float &value = values[index(i, j, k)];
+                    if(!std::isnan(value))
+                        continue;
+                    const double x = double(i - c[0])/s, y = double(j - c[1])/s, z = double(k - c[2])/s;
+                    const double v00 = v[0] + x*(v[1]-v[0]), v10 = v[2] + x*(v[3]-v[2]);
+                    const double v01 = v[4] + x*(v[5]-v[4]), v11 = v[6] + x*(v[7]-v[6]);
+                    const double v0 = v00 + y*(v10-v00), v1 = v01 + y*(v11-v01);
+                    value = v0 + z*(v1-v0);
+                }
+    }, 1);
+    return evaluations;
+}
+
+}
+
+#endif // workspace_OCTREE_H
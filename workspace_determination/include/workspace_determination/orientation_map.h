@@ -0,0 +1,117 @@
+#ifndef workspace_ORIENTATION_MAP_H
+#define workspace_ORIENTATION_MAP_H
+
+#include <visp/vpThetaUVector.h>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// feasible orientations of the platform for each cell of a regular 3D grid, memory-mapped
+// orientations are a fixed list of samples, the feasible ones of a cell are stored as runs of consecutive samples
+//
+// file layout (native endianness):
+//  - orientation_map::Header
+//  - orientations, theta-u in world frame as 3 doubles each
+//  - runs [begin, end) of feasible orientations as 2 uint32, all cells one after the other
+//  - index of the first run of each cell as uint64, cells+1 values, x varies fastest
+
+namespace orientation_map
+{
+
+const char MAGIC[8] = {'C','D','P','R','O','R','I','\0'};
+const uint32_t VERSION = 1;
+
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t samples;       // orientations
+    uint32_t size[3];       // cells along x, y, z
+    uint32_t reserved;
+    double origin[3];       // position of cell (0,0,0)
+    double step[3];
+    uint64_t orientation_offset;   // bytes
+    uint64_t runs_offset;
+    uint64_t index_offset;
+    uint64_t runs;
+};
+
+struct Run
+{
+    uint32_t begin, end;
+};
+
+}
+
+class OrientationMap
+{
+public:
+    typedef orientation_map::Run Run;
+
+    // runs of the non-zero values in feasible[0, n)
+    static void encode(const char *feasible, uint32_t n, std::vector<Run> &runs);
+
+    // writes the cells in order, runs are streamed to the file
+    class Writer
+    {
+    public:
+        Writer(const std::string &file, const unsigned int size[3], const double origin[3], const double step[3],
+               const std::vector<vpThetaUVector> &orientations);
+        // runs of the next cell
+        void add(const std::vector<Run> &runs);
+        // writes the index, false if the file could not be written or some cells are missing
+        bool close();
+
+    protected:
+        std::ofstream out;
+        orientation_map::Header header;
+        std::vector<uint64_t> index;
+        std::string file;
+    };
+
+    explicit OrientationMap(const std::string &file);
+    ~OrientationMap();
+    OrientationMap(const OrientationMap&) = delete;
+    OrientationMap& operator=(const OrientationMap&) = delete;
+
+    inline bool ok() const {return runs_ != nullptr;}
+    inline unsigned int samples() const {return header.samples;}
+    inline unsigned int size(unsigned int axis) const {return header.size[axis];}
+    inline double origin(unsigned int axis) const {return header.origin[axis];}
+    inline double step(unsigned int axis) const {return header.step[axis];}
+    inline size_t cells() const {return (size_t) header.size[0]*header.size[1]*header.size[2];}
+
+    // theta-u of an orientation sample
+    inline vpThetaUVector orientation(unsigned int sample) const
+    {
+        const double *tu = orientations + 3*sample;
+        return vpThetaUVector(tu[0], tu[1], tu[2]);
+    }
+
+    inline size_t index(unsigned int i, unsigned int j, unsigned int k) const
+    {
+        return i + (size_t) header.size[0]*(j + (size_t) header.size[1]*k);
+    }
+    // nearest cell, false if (x, y, z) is outside the grid
+    bool cell(double x, double y, double z, size_t &index) const;
+
+    // runs of a cell
+    inline const Run* begin(size_t cell) const {return runs_ + first[cell];}
+    inline const Run* end(size_t cell) const {return runs_ + first[cell+1];}
+
+    // binary search in the runs of the cell
+    bool feasible(size_t cell, unsigned int sample) const;
+    // number of feasible orientations
+    unsigned int count(size_t cell) const;
+
+protected:
+    orientation_map::Header header;
+    char* data;
+    size_t bytes;
+    const double* orientations;
+    const Run* runs_;
+    const uint64_t* first;
+};
+
+#endif // workspace_ORIENTATION_MAP_H
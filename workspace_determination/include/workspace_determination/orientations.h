@@ -0,0 +1,73 @@
+#ifndef workspace_ORIENTATIONS_H
+#define workspace_ORIENTATIONS_H
+
+#include <cdpr/log.h>
+#include <visp/vpRotationMatrix.h>
+#include <visp/vpRxyzVector.h>
+#include <visp/vpThetaUVector.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// orientation samples for the 6D workspace, ordered so that close samples tend to have close indices
+// which keeps the runs of feasible orientations long in an OrientationMap
+
+namespace workspace
+{
+
+// Rxyz angles on a regular grid in [rpy_min, rpy_max], steps samples per axis, roll varies fastest
+// empty if the vectors do not have 3 values
+inline std::vector<vpRotationMatrix> rpyBox(const std::vector<double> &rpy_min, const std::vector<double> &rpy_max,
+                                            const std::vector<int> &steps)
+{
+    std::vector<vpRotationMatrix> samples;
+    if(rpy_min.size() != 3 || rpy_max.size() != 3 || steps.size() != 3)
+    {
+        CDPR_WARN("rpyBox: rpy_min, rpy_max and rpy_steps should have 3 values");
+        return samples;
+    }
+    auto angle = [&](unsigned int a, int i)
+    {
+        return steps[a] > 1 ? rpy_min[a] + i*(rpy_max[a]-rpy_min[a])/(steps[a]-1) : 0.5*(rpy_min[a]+rpy_max[a]);
+    };
+    for(int k = 0; k < steps[2]; ++k)
+        for(int j = 0; j < steps[1]; ++j)
+            for(int i = 0; i < steps[0]; ++i)
+                samples.push_back(vpRotationMatrix(vpRxyzVector(angle(0, i), angle(1, j), angle(2, k))));
+    return samples;
+}
+
+// about n nearly uniform rotations within max_angle of R0
+// super-Fibonacci samples of the unit quaternions (Alexa, Super-Fibonacci spirals, CVPR 2022) over the whole SO(3),
+// only the ones in the angle bound are kept: a ratio (max_angle - sin(max_angle))/pi of them
+inline std::vector<vpRotationMatrix> so3Set(unsigned int n, const vpRotationMatrix &R0, double max_angle)
+{
+    std::vector<vpRotationMatrix> samples;
+    max_angle = std::min(max_angle, M_PI);
+    const double ratio = (max_angle - std::sin(max_angle))/M_PI;
+    const size_t total = ratio > 0 ? std::ceil(n/ratio) : 0;
+    const double phi = std::sqrt(2.), psi = 1.533751168755204288118041;
+    for(size_t i = 0; i < total; ++i)
+    {
+        const double s = i + 0.5, r = std::sqrt(s/total), R = std::sqrt(1 - s/total);
+        const double alpha = 2*M_PI*s/phi, beta = 2*M_PI*s/psi;
+        double q[4] = {r*std::sin(alpha), r*std::cos(alpha), R*std::sin(beta), R*std::cos(beta)};
+        // q and -q are the same rotation
+        if(q[3] < 0)
+            for(auto &v: q)
+                v = -v;
+        const double angle = 2*std::acos(std::min(q[3], 1.));
+        if(angle > max_angle)
+            continue;
+        const double norm = std::sqrt(q[0]*q[0] + q[1]*q[1] + q[2]*q[2]);
+        vpThetaUVector tu;
+        for(unsigned int a = 0; a < 3; ++a)
+            tu[a] = norm > 1e-12 ? angle*q[a]/norm : 0;
+        samples.push_back(R0*vpRotationMatrix(tu));
+    }
+    return samples;
+}
+
+}
+
+#endif // workspace_ORIENTATIONS_H
@@ -0,0 +1,40 @@
+#ifndef workspace_PARALLEL_H
+#define workspace_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace workspace
+{
+
+// number of threads to use, 0 for all cores
+inline unsigned int threadCount(int threads)
+{
+    return threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+// runs f(i, thread) for i in [0, n) on the given number of threads, thread in [0, threads)
+// indices are handed out by blocks so that the threads stay busy when the cost varies between indices
+template <class F>
+void parallelFor(size_t n, unsigned int threads, const F &f, size_t block = 64)
+{
+    std::atomic<size_t> next(0);
+    auto worker = [&](unsigned int thread)
+    {
+        for(size_t start = next.fetch_add(block); start < n; start = next.fetch_add(block))
+            for(size_t i = start; i < std::min(start + block, n); ++i)
+                f(i, thread);
+    };
+    std::vector<std::thread> pool;
+    for(unsigned int t = 1; t < threads; ++t)
+        pool.emplace_back(worker, t);
+    worker(0);
+    for(auto &th: pool)
+        th.join();
+}
+
+}
+
+#endif // workspace_PARALLEL_H
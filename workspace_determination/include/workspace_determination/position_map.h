@@ -0,0 +1,95 @@
+#ifndef workspace_POSITION_MAP_H
+#define workspace_POSITION_MAP_H
+
+#include <cdpr/grid_map.h>
+#include <cdpr/log.h>
+#include <workspace_determination/workspace.h>
+#include <workspace_determination/parallel.h>
+#include <visp/vpIoTools.h>
+#include <string>
+#include <vector>
+
+// common part of the maps over a regular grid of positions at a fixed orientation (stiffness_map, capacity_map)
+// private parameters:
+//  file, dx / dy / dz (grid steps), x / y / z ([min, max], default from the frame points),
+//  rpy (orientation, default home), threads (0 for all cores)
+
+namespace workspace
+{
+
+class PositionMap
+{
+public:
+    std::string name, file;
+    Grid grid;
+    vpRotationMatrix R;
+    unsigned int threads;
+
+    // name for the logs, default file in ~/Results/cdpr
+    PositionMap(ros::NodeHandle &nh_priv, const Workspace &space, const std::string &name, const std::string &file_name,
+                double step = 0.05)
+        : name(name), file("/home/" + vpIoTools::getUserName() + "/Results/cdpr/" + file_name)
+    {
+        double steps[3] = {step, step, step};
+        int n_threads = 0;
+        std::vector<double> bounds[3], rpy;
+        space.frameBounds(bounds);
+        const vpRxyzVector rpy_home(space.homeRotation());
+        for(unsigned int a = 0; a < 3; ++a)
+            rpy.push_back(rpy_home[a]);
+        param(nh_priv, "file", file);
+        param(nh_priv, "dx", steps[0]);
+        param(nh_priv, "dy", steps[1]);
+        param(nh_priv, "dz", steps[2]);
+        param(nh_priv, "x", bounds[0]);
+        param(nh_priv, "y", bounds[1]);
+        param(nh_priv, "z", bounds[2]);
+        param(nh_priv, "rpy", rpy);
+        param(nh_priv, "threads", n_threads);
+        if(rpy.size() != 3)
+        {
+            CDPR_WARN(name << ": rpy should have 3 angles, using the home orientation");
+            rpy = {rpy_home[0], rpy_home[1], rpy_home[2]};
+        }
+        grid = Grid(bounds, steps);
+        R.buildFrom(vpRxyzVector(rpy[0], rpy[1], rpy[2]));
+        threads = threadCount(n_threads);
+    }
+
+    inline vpHomogeneousMatrix pose(size_t cell) const
+    {
+        double p[3];
+        grid.position(cell, p);
+        return vpHomogeneousMatrix(vpTranslationVector(p[0], p[1], p[2]), R);
+    }
+
+    // writes the fields, the first one tells if the cell is feasible
+    bool write(const std::vector<std::string> &names, const std::vector<float> &data, double elapsed) const
+    {
+        const size_t cells = grid.cells(), fields = names.size();
+        size_t feasible = 0;
+        for(size_t c = 0; c < cells; ++c)
+            if(data[fields*c] > 0)
+                feasible++;
+        vpIoTools::makeDirectory(vpIoTools::getParent(file));
+        if(!GridMap::write(file, grid.size, grid.origin, grid.step, names, data))
+            return false;
+        CDPR_INFO(name << ": " << feasible << " / " << cells << " feasible cells in " << elapsed << " s, "
+                  << 1e6*elapsed*threads/std::max<size_t>(cells, 1) << " us per cell and thread, written to " << file);
+        return true;
+    }
+
+protected:
+    template <class T>
+    static void param(ros::NodeHandle &nh, const std::string &key, T &val)
+    {
+        if(nh.hasParam(key))
+            nh.getParam(key, val);
+        else
+            nh.setParam(key, val);
+    }
+};
+
+}
+
+#endif // workspace_POSITION_MAP_H
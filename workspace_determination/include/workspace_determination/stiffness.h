@@ -0,0 +1,91 @@
+#ifndef workspace_STIFFNESS_H
+#define workspace_STIFFNESS_H
+
+#include <workspace_determination/workspace.h>
+#include <Eigen/Core>
+#include <Eigen/Cholesky>
+#include <Eigen/Eigenvalues>
+
+// Cartesian stiffness of the platform in world frame, for small displacements (dp, dtheta)
+// K = -dw/dx = Ke + Kg
+//  Ke = W.diag(EA/L).W^T, elastic part from the axial stiffness of the cables
+//  Kg, geometric part from the tensions tau: the cable directions u and the lever arms b turn with the pose
+//      sum_i tau_i/L_i [ P        -P.[b]x           ]    with P = I - u.u^T
+//                      [ [b]x.P   -[b]x.P.[b]x - L_i.[u]x.[b]x ]
+//      it is not symmetric out of equilibrium, the summary uses the symmetric part
+// fixed-size Eigen blocks, the rank-1 updates of each cable are vectorized
+
+namespace workspace
+{
+
+typedef Eigen::Matrix<double, 6, 6> Matrix6d;
+
+struct StiffnessSummary
+{
+    bool stable;                // symmetric part positive definite
+    double k_x_min, k_x_max;    // translational stiffness under a pure force [N/m]
+    double k_r_min, k_r_max;    // rotational stiffness under a pure moment [Nm/rad]
+};
+
+// cross product matrix
+inline Eigen::Matrix3d skew(const Eigen::Vector3d &v)
+{
+    Eigen::Matrix3d S;
+    S <<     0, -v(2),  v(1),
+          v(2),     0, -v(0),
+         -v(1),  v(0),     0;
+    return S;
+}
+
+// stiffness at pose M (platform to world) with tensions tau, without the geometric part if tau is empty
+inline void stiffness(const Workspace &space, const vpHomogeneousMatrix &M, const vpColVector &tau, Matrix6d &K)
+{
+    const double EA = space.cableStiffness();
+    K.setZero();
+    for(unsigned int i = 0; i < space.n_cables(); ++i)
+    {
+        // same geometry as Workspace::computeW
+        Eigen::Vector3d b, u;
+        const double L = space.cable(M, i, b.data(), u.data());
+
+        // elastic: EA/L.Wi.Wi^T
+        Eigen::Matrix<double, 6, 1> Wi;
+        Wi << u, b.cross(u);
+        K.noalias() += (EA/L)*Wi*Wi.transpose();
+
+        if(tau.size() == 0)
+            continue;
+        // geometric
+        const Eigen::Matrix3d P = Eigen::Matrix3d::Identity() - u*u.transpose(), B = skew(b);
+        const Eigen::Matrix3d PB = P*B;
+        const double t = tau[i]/L;
+        K.topLeftCorner<3,3>() += t*P;
+        K.topRightCorner<3,3>() -= t*PB;
+        K.bottomLeftCorner<3,3>() += t*B*P;
+        K.bottomRightCorner<3,3>() -= t*B*PB + tau[i]*skew(u)*B;
+    }
+}
+
+// stiffness along the worst and best directions, from the compliance K^-1 of the symmetric part
+inline StiffnessSummary summarize(const Matrix6d &K)
+{
+    StiffnessSummary s = {false, 0, 0, 0, 0};
+    const Matrix6d Ks = 0.5*(K + K.transpose());
+    const Eigen::LLT<Matrix6d> llt(Ks);
+    if(llt.info() != Eigen::Success)
+        return s;
+    const Matrix6d C = llt.solve(Matrix6d::Identity());
+    Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> eig;
+    eig.computeDirect(C.topLeftCorner<3,3>(), Eigen::EigenvaluesOnly);
+    s.k_x_min = 1/eig.eigenvalues()(2);
+    s.k_x_max = 1/eig.eigenvalues()(0);
+    eig.computeDirect(C.bottomRightCorner<3,3>(), Eigen::EigenvaluesOnly);
+    s.k_r_min = 1/eig.eigenvalues()(2);
+    s.k_r_max = 1/eig.eigenvalues()(0);
+    s.stable = true;
+    return s;
+}
+
+}
+
+#endif // workspace_STIFFNESS_H
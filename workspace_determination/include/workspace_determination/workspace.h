@@ -2,34 +2,72 @@
 #define workspace_H
 
 #include <ros/ros.h>
-#include <ros/publisher.h>
-#include <ros/subscriber.h>
-#include <sensor_msgs/JointState.h>
-#include <gazebo_msgs/LinkState.h>
-#include <geometry_msgs/Pose.h>
-#include <geometry_msgs/Twist.h>
-
+#include <cdpr/log.h>
+#include <cdpr/param.h>
+#include <cdpr_controllers/lp.h>
 #include <visp/vpHomogeneousMatrix.h>
+#include <visp/vpRxyzVector.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+// model of the robot for workspace analysis, loaded from the parameter server as in CDPR
+// without subscribers, all computations are const and can run in parallel
+//
+// a pose is feasible if the cables can generate each wrench of the required set with tensions in [f_min, f_max]:
+// gravity compensation, plus each wrench of the ~wrench_set parameter (world frame) if given
+// with a convex set of wrenches, its vertices are enough
+
+// regular grid of positions, x varies fastest as in GridMap
+struct Grid
+{
+    unsigned int size[3];
+    double origin[3], step[3];
+
+    Grid() : size{0, 0, 0}, origin{0, 0, 0}, step{1, 1, 1} {}
+
+    // bounds [min, max] along each axis
+    Grid(const std::vector<double> bounds[3], const double steps[3])
+    {
+        for(unsigned int a = 0; a < 3; ++a)
+        {
+            origin[a] = bounds[a][0];
+            step[a] = steps[a];
+            size[a] = std::max(1, int((bounds[a][1] - bounds[a][0])/steps[a] + 1e-6) + 1);
+        }
+    }
 
-using std::endl;
-using std::cout;
+    inline size_t cells() const {return (size_t) size[0]*size[1]*size[2];}
+
+    inline size_t index(unsigned int i, unsigned int j, unsigned int k) const
+    {
+        return i + (size_t) size[0]*(j + (size_t) size[1]*k);
+    }
+
+    inline void position(size_t index, double p[3]) const
+    {
+        p[0] = origin[0] + step[0]*(index % size[0]);
+        index /= size[0];
+        p[1] = origin[1] + step[1]*(index % size[1]);
+        p[2] = origin[2] + step[2]*(index / size[1]);
+    }
+};
 
 class Workspace
 {
 public:
     Workspace(ros::NodeHandle &w_node)
-    {   
-       /* // publisher to setpoints
-        setpointPose_pub = w_node.advertise<geometry_msgs::Pose>("pf_setpoint", 1);
-        setpointVel_pub = w_node.advertise<geometry_msgs::Twist>("desired_vel",1);
-        setpointAcc_pub = w_node.advertise<geometry_msgs::Twist>("desired_acc",1);*/
-
+    {
         // load model parameters
         ros::NodeHandle model(w_node, "model");
 
         model.getParam("platform/mass",mass_);
+        model.getParam("joints/actuated/effort", f_max);
+        model.getParam("joints/actuated/min", f_min);
+        model.getParam("cable/stiffness", stiffness_);
 
-        // initialize the size of the basic frame
+        // attach points
         XmlRpc::XmlRpcValue element;
         model.getParam("points", element);
         n_cable = element.size();
@@ -40,51 +78,127 @@ public:
             y = element[i]["frame"][1];
             z = element[i]["frame"][2];
             Pf.push_back(vpTranslationVector(x, y, z));
-            /*x = element[i]["platform"][0];
-            y= element[i]["platform"][1];
+            x = element[i]["platform"][0];
+            y = element[i]["platform"][1];
             z = element[i]["platform"][2];
-            Pp.push_back(vpTranslationVector(x, y, z));*/
+            Pp.push_back(vpTranslationVector(x, y, z));
         }
-            bi=Pf[1];
 
         model.getParam("platform/size", element);
         size_pf.resize(3);
-
         for(unsigned int i=0;i<3;++i)
+            size_pf[i] = element[i];
+
+        // identity if the home orientation is missing
+        std::vector<double> rpy;
+        if(model.getParam("platform/position/rpy", rpy) && rpy.size() == 3)
+            R_home.buildFrom(vpRxyzVector(rpy[0], rpy[1], rpy[2]));
+        else
+            CDPR_WARN("Workspace: model/platform/position/rpy should have 3 angles, using the identity");
+
+        // required wrenches: gravity compensation, plus the given set
+        vpColVector w0(6);
+        w0[2] = mass_*9.81;
+        ros::NodeHandle priv("~");
+        if(priv.getParam("wrench_set", element) && element.getType() == XmlRpc::XmlRpcValue::TypeArray)
         {
-           size_pf[i] = element[i];
-          
-        }   
-           
-       para_ok=true;
-    }
-
-    //inline void InitializeTime(double &t_i, double &t_f) {t_i = t0; t_f = t4;}
-
-    // initialize the boundary 
-    inline void getBoundary(vpColVector &b_i){b_i= bi;}
-    inline vpColVector getSize(vpColVector &s){s=size_pf;}
-    inline double mass() {return mass_;}
+            for(int k = 0; k < element.size(); ++k)
+            {
+                if(element[k].getType() != XmlRpc::XmlRpcValue::TypeArray || element[k].size() != 6)
+                {
+                    CDPR_WARN("Workspace: wrench_set entry " << k << " should have 6 values, skipped");
+                    continue;
+                }
+                vpColVector w(w0);
+                for(unsigned int i = 0; i < 6; ++i)
+                    w[i] += cdpr_param::toDouble(element[k][i]);
+                wrenches.push_back(w);
+            }
+        }
+        if(wrenches.empty())
+            wrenches.push_back(w0);
 
-    inline bool Para_ok() {return para_ok;}
+        para_ok=true;
+    }
 
+    inline unsigned int n_cables() const {return n_cable;}
+    inline double mass() const {return mass_;}
+    inline void tensionMinMax(double &fmin, double &fmax) const {fmin = f_min; fmax = f_max;}
+    inline double cableStiffness() const {return stiffness_;}
+    inline void getSize(vpColVector &s) const {s = size_pf;}
+    inline const vpRotationMatrix& homeRotation() const {return R_home;}
+    inline const std::vector<vpColVector>& wrenchSet() const {return wrenches;}
+    inline const vpTranslationVector& framePoint(unsigned int i) const {return Pf[i];}
+    inline const vpTranslationVector& platformPoint(unsigned int i) const {return Pp[i];}
+
+    inline bool Para_ok() const {return para_ok;}
+
+    // bounds of the frame points, from the floor along z
+    inline void frameBounds(std::vector<double> bounds[3]) const
+    {
+        for(unsigned int a = 0; a < 3; ++a)
+            bounds[a] = {1e6, -1e6};
+        bounds[2][0] = 0;
+        for(const auto &P: Pf)
+            for(unsigned int a = 0; a < 3; ++a)
+            {
+                bounds[a][0] = std::min(bounds[a][0], P[a]);
+                bounds[a][1] = std::max(bounds[a][1], P[a]);
+            }
+    }
 
-    //inline void InitializePose(vpRowVector &x_i, vpRowVector &x_f) {x_i = xi; x_f = xf;}
-    //inline void InitializeGain(double &t_i, double &t_f) {t_i = Kp; t_f = Kd;}
+    // structure matrix in world frame at pose M (platform to world)
+    // cable i at pose M: lever arm b (platform point in world frame, from the platform origin) and unit direction u
+    // towards the frame, returns the length
+    inline double cable(const vpHomogeneousMatrix &M, unsigned int i, double b[3], double u[3]) const
+    {
+        for(unsigned int k=0;k<3;++k)
+            b[k] = M[k][0]*Pp[i][0] + M[k][1]*Pp[i][1] + M[k][2]*Pp[i][2];
+        for(unsigned int k=0;k<3;++k)
+            u[k] = Pf[i][k] - M[k][3] - b[k];
+        const double norm = std::sqrt(u[0]*u[0] + u[1]*u[1] + u[2]*u[2]);
+        for(unsigned int k=0;k<3;++k)
+            u[k] /= norm;
+        return norm;
+    }
 
+    void computeW(const vpHomogeneousMatrix &M, vpMatrix &W) const
+    {
+        W.resize(6, n_cable, false);
+        for(unsigned int i=0;i<n_cable;++i)
+        {
+            double b[3], u[3];
+            cable(M, i, b, u);
+            for(unsigned int k=0;k<3;++k)
+                W[k][i] = u[k];
+            W[3][i] = b[1]*u[2] - b[2]*u[1];
+            W[4][i] = b[2]*u[0] - b[0]*u[2];
+            W[5][i] = b[0]*u[1] - b[1]*u[0];
+        }
+    }
 
-    // publisher to the desired pose , volecity and acceleration
-    protected:
-    ros::Publisher setpointPose_pub, setpointVel_pub, setpointAcc_pub;
-    geometry_msgs::Twist vel_d, acc_d; 
-    geometry_msgs::Pose pf_d;
+    // smallest tension margin over the wrench set, negative if some wrench cannot be generated
+    double margin(const vpMatrix &W) const
+    {
+        double m = INFINITY;
+        for(const auto &w: wrenches)
+        {
+            m = std::min(m, solve_lp::tensionMargin(W, w, f_min, f_max));
+            if(m < 0)
+                break;
+        }
+        return m;
+    }
 
+protected:
     // model parameter
-    double mass_;
-    vpColVector  size_pf, bi;
+    unsigned int n_cable;
+    double mass_, f_min, f_max, stiffness_ = 0;
+    vpColVector size_pf;
+    vpRotationMatrix R_home;
     std::vector<vpTranslationVector> Pf, Pp;
+    std::vector<vpColVector> wrenches;
     bool para_ok = false;
-
 };
 
 #endif // workspace_H
@@ -0,0 +1,51 @@
+#!/usr/bin/env python
+
+'''
+Scaling of workspace_mpi from 1 to N ranks on the same sweep
+
+    rosrun workspace_determination mpi_scaling.py 8 [--threads 1] [--hostfile hosts] [_dx:=0.05 ...]
+
+The model should be on the parameter server. Other arguments are passed to the node as is.
+With one rank, rank 0 evaluates all tiles itself. With more ranks it only hands them out and merges,
+so k ranks have k-1 workers: the efficiency is given per worker.
+Threads default to 1 per rank so that only the ranks scale.
+'''
+
+import argparse
+import re
+import subprocess
+import sys
+
+parser = argparse.ArgumentParser(description='Scaling of workspace_mpi')
+parser.add_argument('ranks', type=int, help='largest number of ranks')
+parser.add_argument('--threads', type=int, default=1, help='threads per rank, 0 for all cores')
+parser.add_argument('--hostfile', help='MPI hostfile, ranks on the local machine by default')
+parser.add_argument('--mpirun', default='mpirun', help='MPI launcher')
+args, node_args = parser.parse_known_args()
+
+elapsed = re.compile(r'feasible poses in ([0-9.eE+-]+) s')
+
+
+def run(ranks):
+    cmd = [args.mpirun, '-np', str(ranks)]
+    if args.hostfile:
+        cmd += ['--hostfile', args.hostfile, '-x', 'ROS_MASTER_URI']
+    cmd += ['rosrun', 'workspace_determination', 'workspace_mpi', '_threads:=%i' % args.threads] + node_args
+    proc = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    out = proc.communicate()[0]
+    match = elapsed.search(out)
+    if proc.returncode or not match:
+        sys.stderr.write(out)
+        sys.exit('workspace_mpi failed with %i ranks' % ranks)
+    return float(match.group(1))
+
+
+print('ranks  workers  time [s]  speedup  efficiency')
+t1 = None
+for ranks in range(1, args.ranks + 1):
+    t = run(ranks)
+    if t1 is None:
+        t1 = t
+    workers = max(ranks - 1, 1)
+    print('%5i  %7i  %8.3f  %7.2f  %9.0f %%' % (ranks, workers, t, t1 / t, 100 * t1 / (t * workers)))
+    sys.stdout.flush()
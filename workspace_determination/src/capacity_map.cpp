@@ -0,0 +1,86 @@
+#include <workspace_determination/position_map.h>
+#include <cdpr_controllers/capacity.h>
+#include <chrono>
+
+using namespace std;
+
+/*
+ * Performance maps over a regular grid of positions at a fixed orientation
+ *
+ * For the required wrench set (see workspace.h), each cell gets:
+ *  - the capacity margin, distance of the wrenches to the boundary of the available wrench set (capacity.h)
+ *  - the tension factor, min(tau)/max(tau) of the most even tension distribution, smallest over the wrenches (lp.h)
+ * Cells are evaluated in parallel on all cores, by blocks.
+ *
+ * Writes a GridMap with fields:
+ *  feasible        1 or 0, the map can be given as workspace_map to the controllers and trajectory tools
+ *  capacity        capacity margin [N, moments divided by length], negative outside
+ *  tension_factor  in [0, 1], 0 outside
+ *
+ * Needs the model on the parameter server, private parameters of position_map.h and:
+ *  wrench_set (list of 6-vectors, world frame), length (characteristic length [m] to compare moments with forces)
+ */
+
+template <class T>
+void Param(ros::NodeHandle &nh, const string &key, T &val)
+{
+    if(nh.hasParam(key))
+        nh.getParam(key, val);
+    else
+        nh.setParam(key, val);
+}
+
+int main(int argc, char ** argv)
+{
+    ros::init(argc, argv, "capacity_map");
+    ros::NodeHandle node_w, nh_priv("~");
+    cdpr_log::setLevel(ros::param::param<std::string>("~log_level", "info"));
+
+    Workspace space(node_w);
+
+    const workspace::PositionMap map(nh_priv, space, "capacity_map", "capacity.grd");
+    double length = 1;
+    Param(nh_priv, "length", length);
+    double f_min, f_max;
+    space.tensionMinMax(f_min, f_max);
+    const unsigned int n_threads = map.threads;
+    const size_t cells = map.grid.cells();
+    vector<CapacityMargin> capacity(n_threads, CapacityMargin(space.n_cables(), f_min, f_max, length));
+    CDPR_INFO("capacity_map: " << map.grid.size[0] << " x " << map.grid.size[1] << " x " << map.grid.size[2] << " cells, "
+              << space.wrenchSet().size() << " wrenches, " << capacity[0].facets() << " facet normals, " << n_threads << " threads");
+
+    const vector<string> names = {"feasible", "capacity", "tension_factor"};
+    const unsigned int fields = names.size();
+    vector<float> data(cells*fields, 0);
+    vector<vpMatrix> W(n_threads);
+
+    const auto start = chrono::steady_clock::now();
+    workspace::parallelFor(cells, n_threads, [&](size_t c, unsigned int thread)
+    {
+        space.computeW(map.pose(c), W[thread]);
+        float *cell = &data[fields*c];
+        cell[1] = capacity[thread].compute(W[thread], space.wrenchSet());
+        if(cell[1] < 0)
+            return;
+        double factor = 1;
+        for(const auto &w: space.wrenchSet())
+            factor = min(factor, solve_lp::tensionFactor(W[thread], w, f_min, f_max));
+        cell[0] = factor >= 0;
+        cell[2] = max(factor, 0.);
+    });
+    const double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    double capacity_max = 0, factor_max = 0;
+    for(size_t c = 0; c < cells; ++c)
+        if(data[fields*c] > 0)
+        {
+            capacity_max = max<double>(capacity_max, data[fields*c+1]);
+            factor_max = max<double>(factor_max, data[fields*c+2]);
+        }
+
+    const bool ok = map.write(names, data, elapsed);
+    if(ok)
+        CDPR_INFO("capacity_map: capacity up to " << capacity_max << " N, tension factor up to " << factor_max);
+    cdpr_log::flush();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,163 @@
+#include <workspace_determination/orientation_map.h>
+#include <cdpr/log.h>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace orientation_map;
+
+void OrientationMap::encode(const char *feasible, uint32_t n, std::vector<Run> &runs)
+{
+    runs.clear();
+    for(uint32_t i = 0; i < n; ++i)
+    {
+        if(!feasible[i])
+            continue;
+        if(runs.size() && runs.back().end == i)
+            runs.back().end++;
+        else
+            runs.push_back({i, i+1});
+    }
+}
+
+OrientationMap::Writer::Writer(const std::string &file, const unsigned int size[3], const double origin[3], const double step[3],
+                               const std::vector<vpThetaUVector> &orientations)
+    : out(file, std::ios::binary | std::ios::trunc), index(1, 0), file(file)
+{
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.samples = orientations.size();
+    for(unsigned int i = 0; i < 3; ++i)
+    {
+        header.size[i] = size[i];
+        header.origin[i] = origin[i];
+        header.step[i] = step[i];
+    }
+    header.orientation_offset = sizeof(Header);
+    header.runs_offset = header.orientation_offset + 3*sizeof(double)*header.samples;
+    index.reserve((size_t) size[0]*size[1]*size[2] + 1);
+
+    // header is written again when closing
+    out.write((const char*) &header, sizeof(header));
+    for(const auto &tu: orientations)
+        for(unsigned int i = 0; i < 3; ++i)
+        {
+            const double v = tu[i];
+            out.write((const char*) &v, sizeof(double));
+        }
+}
+
+void OrientationMap::Writer::add(const std::vector<Run> &runs)
+{
+    out.write((const char*) runs.data(), runs.size()*sizeof(Run));
+    index.push_back(index.back() + runs.size());
+}
+
+bool OrientationMap::Writer::close()
+{
+    const size_t cells = (size_t) header.size[0]*header.size[1]*header.size[2];
+    if(index.size() != cells + 1)
+    {
+        CDPR_WARN("OrientationMap: " << index.size()-1 << " cells written to " << file << " instead of " << cells);
+        return false;
+    }
+    header.runs = index.back();
+    header.index_offset = header.runs_offset + header.runs*sizeof(Run);
+    out.write((const char*) index.data(), index.size()*sizeof(uint64_t));
+    out.seekp(0);
+    out.write((const char*) &header, sizeof(header));
+    out.close();
+    if(!out)
+    {
+        CDPR_WARN("OrientationMap: cannot write " << file);
+        return false;
+    }
+    return true;
+}
+
+OrientationMap::OrientationMap(const std::string &file)
+    : data(nullptr), bytes(0), orientations(nullptr), runs_(nullptr), first(nullptr)
+{
+    memset(&header, 0, sizeof(header));
+    const int fd = ::open(file.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        CDPR_WARN("OrientationMap: cannot open " << file << " (" << strerror(errno) << ")");
+        return;
+    }
+    struct stat st;
+    if(fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(Header))
+    {
+        bytes = st.st_size;
+        void *p = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+        if(p != MAP_FAILED)
+            data = (char*) p;
+    }
+    ::close(fd);
+    if(!data)
+    {
+        CDPR_WARN("OrientationMap: cannot map " << file);
+        return;
+    }
+
+    memcpy(&header, data, sizeof(header));
+    const size_t n = cells();
+    const bool valid = memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version == VERSION
+            && n && header.orientation_offset == sizeof(Header)
+            && header.runs_offset == header.orientation_offset + 3*sizeof(double)*header.samples
+            && header.index_offset == header.runs_offset + header.runs*sizeof(Run)
+            && header.index_offset + (n+1)*sizeof(uint64_t) <= bytes;
+    if(!valid)
+    {
+        CDPR_WARN("OrientationMap: " << file << " is not an orientation map");
+        munmap(data, bytes);
+        data = nullptr;
+        return;
+    }
+    orientations = (const double*)(data + header.orientation_offset);
+    first = (const uint64_t*)(data + header.index_offset);
+    runs_ = (const Run*)(data + header.runs_offset);
+}
+
+OrientationMap::~OrientationMap()
+{
+    if(data)
+        munmap(data, bytes);
+}
+
+bool OrientationMap::cell(double x, double y, double z, size_t &index) const
+{
+    const double pos[3] = {x, y, z};
+    unsigned int idx[3];
+    for(unsigned int a = 0; a < 3; ++a)
+    {
+        const double u = std::round((pos[a] - header.origin[a]) / header.step[a]);
+        if(u < 0 || u > header.size[a] - 1)
+            return false;
+        idx[a] = u;
+    }
+    index = this->index(idx[0], idx[1], idx[2]);
+    return true;
+}
+
+bool OrientationMap::feasible(size_t cell, unsigned int sample) const
+{
+    // last run starting at or before the sample
+    const Run *run = std::upper_bound(begin(cell), end(cell), sample,
+                                      [](unsigned int s, const Run &r){return s < r.begin;});
+    return run != begin(cell) && sample < (run-1)->end;
+}
+
+unsigned int OrientationMap::count(size_t cell) const
+{
+    unsigned int n = 0;
+    for(const Run *run = begin(cell); run != end(cell); ++run)
+        n += run->end - run->begin;
+    return n;
+}
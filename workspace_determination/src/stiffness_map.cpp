@@ -0,0 +1,103 @@
+#include <workspace_determination/position_map.h>
+#include <workspace_determination/stiffness.h>
+#include <chrono>
+
+using namespace std;
+
+/*
+ * Cartesian stiffness of the platform over a regular grid of positions at a fixed orientation (stiffness.h)
+ *
+ * The tensions are those of largest margin for gravity compensation (lp.h), they give the geometric part.
+ * Cells are evaluated in parallel on all cores.
+ *
+ * Writes a GridMap with fields:
+ *  feasible    1 if gravity can be compensated with the tension limits and the stiffness is positive definite
+ *  k_x_min     translational stiffness along the softest / stiffest direction [N/m]
+ *  k_x_max
+ *  k_r_min     rotational stiffness [Nm/rad]
+ *  k_r_max
+ * all 0 where not feasible
+ *
+ * Needs the model on the parameter server with cable/stiffness (EA [N]), private parameters of position_map.h and:
+ *  geometric (bool, tension-dependent part)
+ */
+
+template <class T>
+void Param(ros::NodeHandle &nh, const string &key, T &val)
+{
+    if(nh.hasParam(key))
+        nh.getParam(key, val);
+    else
+        nh.setParam(key, val);
+}
+
+int main(int argc, char ** argv)
+{
+    ros::init(argc, argv, "stiffness_map");
+    ros::NodeHandle node_w, nh_priv("~");
+    cdpr_log::setLevel(ros::param::param<std::string>("~log_level", "info"));
+
+    Workspace space(node_w);
+    if(space.cableStiffness() <= 0)
+    {
+        CDPR_ERROR("stiffness_map: no cable/stiffness in the model");
+        return 1;
+    }
+
+    const workspace::PositionMap map(nh_priv, space, "stiffness_map", "stiffness.grd");
+    bool geometric = true;
+    Param(nh_priv, "geometric", geometric);
+    double f_min, f_max;
+    space.tensionMinMax(f_min, f_max);
+    const unsigned int n_threads = map.threads;
+    const size_t cells = map.grid.cells();
+    CDPR_INFO("stiffness_map: " << map.grid.size[0] << " x " << map.grid.size[1] << " x " << map.grid.size[2] << " cells, EA = "
+              << space.cableStiffness() << " N, " << n_threads << " threads");
+
+    const vector<string> names = {"feasible", "k_x_min", "k_x_max", "k_r_min", "k_r_max"};
+    const unsigned int fields = names.size();
+    vector<float> data(cells*fields, 0);
+    vector<vpMatrix> W(n_threads);
+    vector<vpColVector> tau(n_threads);
+    const vpColVector empty;
+    vpColVector w0(6);
+    w0[2] = space.mass()*9.81;
+
+    const auto start = chrono::steady_clock::now();
+    workspace::parallelFor(cells, n_threads, [&](size_t c, unsigned int thread)
+    {
+        const vpHomogeneousMatrix M = map.pose(c);
+        space.computeW(M, W[thread]);
+        if(solve_lp::tensionMargin(W[thread], w0, f_min, f_max, tau[thread]) < 0)
+            return;
+        workspace::Matrix6d K;
+        workspace::stiffness(space, M, geometric ? tau[thread] : empty, K);
+        const workspace::StiffnessSummary s = workspace::summarize(K);
+        if(!s.stable)
+            return;
+        float *cell = &data[fields*c];
+        cell[0] = 1;
+        cell[1] = s.k_x_min;
+        cell[2] = s.k_x_max;
+        cell[3] = s.k_r_min;
+        cell[4] = s.k_r_max;
+    });
+    const double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // softest feasible cell
+    size_t softest = cells;
+    for(size_t c = 0; c < cells; ++c)
+        if(data[fields*c] > 0 && (softest == cells || data[fields*c+1] < data[fields*softest+1]))
+            softest = c;
+
+    const bool ok = map.write(names, data, elapsed);
+    if(ok && softest < cells)
+    {
+        double p[3];
+        map.grid.position(softest, p);
+        CDPR_INFO("stiffness_map: softest at (" << p[0] << ", " << p[1] << ", " << p[2] << "), "
+                  << data[fields*softest+1] << " N/m and " << data[fields*softest+3] << " Nm/rad");
+    }
+    cdpr_log::flush();
+    return ok ? 0 : 1;
+}
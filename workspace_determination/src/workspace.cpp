@@ -1,22 +1,40 @@
-
-#include <cdpr/cdpr.h>
-#include <cdpr_controllers/qp.h>
-#include <math.h>
+#include <cdpr/grid_map.h>
+#include <cdpr/log.h>
+#include <cdpr/interference.h>
 #include <workspace_determination/workspace.h>
+#include <workspace_determination/parallel.h>
+#include <workspace_determination/octree.h>
+#include <visp/vpIoTools.h>
+#include <chrono>
 
 using namespace std;
 
-
 /*
- * Closed form controller to show input/output of the CDPR class
+ * Wrench-feasible workspace over a regular grid of positions at a fixed orientation
+ *
+ * A position is feasible if each wrench of the required set (see workspace.h) can be generated
+ * with tensions in [f_min, f_max]. Cells are evaluated in parallel on all cores.
  *
- * Does not consider positive-only cable tensions and assumes it is more or less a UPS parallel robot
+ * mode:
+ *  grid        evaluates every cell
+ *  octree      evaluates the corners of cells of 2^levels steps and only splits the cells that cross the
+ *              boundary or have a margin below near (fraction of the tension range), see octree.h
+ *              other cells are interpolated, the coarse cells should be smaller than the thinnest feature
  *
+ * Writes a GridMap with fields:
+ *  feasible    1 or 0
+ *  margin      smallest tension margin over the wrench set [N], negative outside
+ *  clearance   with interference, smallest cable-cable or cable-platform clearance [m] (cdpr/interference.h),
+ *              cells where the cables interfere are not feasible
  *
+ * Needs the model on the parameter server, private parameters:
+ *  file, dx / dy / dz (grid steps), x / y / z ([min, max], default from the frame points),
+ *  rpy (orientation, default home), threads (0 for all cores), wrench_set (list of 6-vectors, world frame),
+ *  mode, levels, near, interference (bool), interference_range
  */
 
-
-void Param(ros::NodeHandle &nh, const string &key, double &val)
+template <class T>
+void Param(ros::NodeHandle &nh, const string &key, T &val)
 {
     if(nh.hasParam(key))
         nh.getParam(key, val);
@@ -26,81 +44,145 @@ void Param(ros::NodeHandle &nh, const string &key, double &val)
 
 int main(int argc, char ** argv)
 {
-
-    cout.precision(3);
     // init ROS node
     ros::init(argc, argv, "workspace_determination");
-    ros::NodeHandle node_w;
-    
-    // declaration of the node
-    Workspace space(node_w);
-
-
-    //initiallization of the parameter
-    double mass, x_b, y_b, z_b, x_s, y_s, z_s;
-    vpColVector boxsize(3), B(3);
-
+    ros::NodeHandle node_w, nh_priv("~");
+    cdpr_log::setLevel(ros::param::param<std::string>("~log_level", "info"));
 
+    // declaration of the model
+    Workspace space(node_w);
 
-    // 
-
-    mass = node_w.mass();
-    node_w.getSize(boxsize);
-    node_w.getBoundary(B);
-    
-    x_b=abs(B[0]);
-    y_b=abs(B[1]);
-    z_b=abs(B[2]);
-    x_s=1/2*boxsize[0];
-    y_s=1/2*boxsize[1];
-    z_s=1/2*boxsize[2];
-
-    double inter, x, y, z=0;
-
-    dx=0.005;
-    dy=0.005;
-    dz=0.01;
-
-    inter_x= 2* x_b/dx;
-    inter_y= 2* y_b/dy;
-    inter_z= z_b/dz;
-
-    double dt = 0.01;
-    ros::Rate loop(1/dt);
-    std::vector<vpTranslationVector> P;
-
-  
-    cout << "workspace analysis ready" << fixed << endl; 
-    while(ros::ok())
+    string file = "/home/" + vpIoTools::getUserName() + "/Results/cdpr/workspace.grd", mode = "grid";
+    double steps[3] = {0.005, 0.005, 0.01}, near = 0.01;
+    int threads = 0, levels = 4;
+    bool interference = false;
+    double interference_range = 0.1;
+    vector<double> bounds[3], rpy;
+    space.frameBounds(bounds);
+    const vpRxyzVector rpy_home(space.homeRotation());
+    for(unsigned int a = 0; a < 3; ++a)
+        rpy.push_back(rpy_home[a]);
+    Param(nh_priv, "file", file);
+    Param(nh_priv, "dx", steps[0]);
+    Param(nh_priv, "dy", steps[1]);
+    Param(nh_priv, "dz", steps[2]);
+    Param(nh_priv, "x", bounds[0]);
+    Param(nh_priv, "y", bounds[1]);
+    Param(nh_priv, "z", bounds[2]);
+    Param(nh_priv, "rpy", rpy);
+    Param(nh_priv, "threads", threads);
+    if(rpy.size() != 3)
     {
-        cout << "------------------" << endl;
-        
-        if ( node_w.Para_ok())
-        {  
-            for (unsigned int i = 0; i <= inter_y; ++i)
-            {
-                y=y_b-i*dy;
-
-                for (unsigned int k = 0 ; k <= inter_x; ++k)
+        CDPR_WARN("workspace: rpy should have 3 angles, using the home orientation");
+        rpy = {rpy_home[0], rpy_home[1], rpy_home[2]};
+    }
+    Param(nh_priv, "mode", mode);
+    Param(nh_priv, "levels", levels);
+    levels = max(0, min(levels, 10));
+    Param(nh_priv, "near", near);
+    Param(nh_priv, "interference", interference);
+    Param(nh_priv, "interference_range", interference_range);
+    if(mode != "grid" && mode != "octree")
+    {
+        CDPR_ERROR("workspace: mode should be grid or octree, not " << mode);
+        return 1;
+    }
+    double f_min, f_max;
+    space.tensionMinMax(f_min, f_max);
+    const unsigned int n_threads = workspace::threadCount(threads);
+
+    const Grid grid(bounds, steps);
+    const size_t cells = grid.cells();
+    const vpRotationMatrix R(vpRxyzVector(rpy[0], rpy[1], rpy[2]));
+    CDPR_INFO("workspace: " << grid.size[0] << " x " << grid.size[1] << " x " << grid.size[2] << " cells, "
+              << space.wrenchSet().size() << " wrenches, " << n_threads << " threads");
+
+    // fields of each cell, written by a single thread
+    vector<string> names = {"feasible", "margin"};
+    if(interference)
+        names.push_back("clearance");
+    const unsigned int fields = names.size();
+    vector<float> data(cells*fields);
+    vector<vpMatrix> W(n_threads);
+    auto margin = [&](const double p[3], unsigned int thread)
+    {
+        const vpHomogeneousMatrix M(vpTranslationVector(p[0], p[1], p[2]), R);
+        space.computeW(M, W[thread]);
+        return space.margin(W[thread]);
+    };
+
+    size_t evaluations = cells;
+    const auto start = chrono::steady_clock::now();
+    if(mode == "grid")
+    {
+        workspace::parallelFor(cells, n_threads, [&](size_t c, unsigned int thread)
+        {
+            double p[3];
+            grid.position(c, p);
+            const double m = margin(p, thread);
+            data[fields*c] = m >= 0;
+            data[fields*c+1] = m;
+        });
+    }
+    else
+    {
+        // lattice of the grid steps, extended to a whole number of coarse cells
+        const unsigned int s = 1u << levels;
+        unsigned int size[3];
+        for(unsigned int a = 0; a < 3; ++a)
+            size[a] = grid.size[a] > 1 ? ((grid.size[a] - 2)/s + 1)*s + 1 : 1;
+        vector<float> values;
+        evaluations = workspace::adaptiveSample(size, levels, near*(f_max - f_min), n_threads,
+                                                [&](unsigned int i, unsigned int j, unsigned int k, unsigned int thread)
+        {
+            const double p[3] = {grid.origin[0] + i*grid.step[0], grid.origin[1] + j*grid.step[1], grid.origin[2] + k*grid.step[2]};
+            return margin(p, thread);
+        }, values);
+        for(unsigned int k = 0; k < grid.size[2]; ++k)
+            for(unsigned int j = 0; j < grid.size[1]; ++j)
+                for(unsigned int i = 0; i < grid.size[0]; ++i)
                 {
-                    x=x_b-k*dx;
-                    P.push_back(vpTranslationVector(x, y, z));
+                    const size_t c = grid.index(i, j, k);
+                    const float m = values[i + (size_t) size[0]*(j + (size_t) size[1]*k)];
+                    data[fields*c] = m >= 0;
+                    data[fields*c+1] = m;
                 }
-
-            }
-
-        }
-        z+=dz;
-
-        
-
-        
-        ros::spinOnce();
-        loop.sleep();
     }
 
-
-
-
-
+    // geometric check of every cell, much cheaper than the wrench feasibility
+    if(interference)
+    {
+        vector<Interference> check(n_threads, Interference(node_w, interference_range));
+        vector<Interference::Result> result(n_threads);
+        double Rd[9];
+        for(unsigned int i = 0; i < 3; ++i)
+            for(unsigned int j = 0; j < 3; ++j)
+                Rd[3*i+j] = R[i][j];
+        workspace::parallelFor(cells, n_threads, [&](size_t c, unsigned int thread)
+        {
+            double p[3];
+            grid.position(c, p);
+            Interference::Result &res = result[thread];
+            check[thread].compute(Rd, p, res);
+            data[fields*c+2] = min(res.cable, res.platform);
+            if(!res.ok())
+                data[fields*c] = 0;
+        });
+    }
+    const double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    size_t feasible = 0;
+    for(size_t c = 0; c < cells; ++c)
+        feasible += data[fields*c] > 0;
+
+    vpIoTools::makeDirectory(vpIoTools::getParent(file));
+    const bool ok = GridMap::write(file, grid.size, grid.origin, grid.step, names, data);
+    if(ok)
+        CDPR_INFO("workspace: " << feasible << " / " << cells << " feasible cells ("
+                  << feasible*steps[0]*steps[1]*steps[2] << " m3) in " << elapsed << " s, "
+                  << evaluations << " evaluations (" << 100.*evaluations/cells << " % of the cells), "
+                  << evaluations/max(elapsed, 1e-9) << " evaluations/s, " << 1e6*elapsed*n_threads/max<size_t>(evaluations, 1)
+                  << " us per evaluation and thread, written to " << file);
+    cdpr_log::flush();
+    return ok ? 0 : 1;
 }
@@ -0,0 +1,153 @@
+#include <cdpr/grid_map.h>
+#include <cdpr/log.h>
+#include <workspace_determination/workspace.h>
+#include <workspace_determination/parallel.h>
+#include <workspace_determination/orientations.h>
+#include <workspace_determination/orientation_map.h>
+#include <visp/vpIoTools.h>
+#include <chrono>
+
+using namespace std;
+
+/*
+ * 6D wrench-feasible workspace: feasible orientations for each cell of a regular grid of positions
+ *
+ * Orientations are a fixed list of samples (orientations.h):
+ *  rpy         Rxyz angles on a grid in [rpy_min, rpy_max] with rpy_steps samples per axis
+ *  so3         about so3_samples nearly uniform rotations within max_angle of the home orientation
+ * The (cell, orientation) pairs are evaluated in parallel, by chunks of cells.
+ *
+ * Writes an OrientationMap (runs of feasible orientations per cell) to file, and optionally a GridMap to summary with fields:
+ *  fraction    ratio of feasible orientations
+ *  feasible    1 if some orientation is feasible
+ *
+ * Needs the model on the parameter server, private parameters:
+ *  file, summary, dx / dy / dz (grid steps), x / y / z ([min, max], default from the frame points),
+ *  orientations (rpy or so3), rpy_min, rpy_max, rpy_steps, so3_samples, max_angle,
+ *  threads (0 for all cores), wrench_set (list of 6-vectors, world frame)
+ */
+
+template <class T>
+void Param(ros::NodeHandle &nh, const string &key, T &val)
+{
+    if(nh.hasParam(key))
+        nh.getParam(key, val);
+    else
+        nh.setParam(key, val);
+}
+
+int main(int argc, char ** argv)
+{
+    ros::init(argc, argv, "workspace_6d");
+    ros::NodeHandle node_w, nh_priv("~");
+    cdpr_log::setLevel(ros::param::param<std::string>("~log_level", "info"));
+
+    Workspace space(node_w);
+
+    string file = "/home/" + vpIoTools::getUserName() + "/Results/cdpr/workspace_6d.ori", summary, orientations = "rpy";
+    double steps[3] = {0.1, 0.1, 0.1}, max_angle = 0.3;
+    int threads = 0, so3_samples = 500;
+    vector<double> bounds[3], rpy_min, rpy_max;
+    vector<int> rpy_steps = {7, 7, 7};
+    space.frameBounds(bounds);
+    const vpRxyzVector rpy_home(space.homeRotation());
+    for(unsigned int a = 0; a < 3; ++a)
+    {
+        rpy_min.push_back(rpy_home[a] - 0.3);
+        rpy_max.push_back(rpy_home[a] + 0.3);
+    }
+    Param(nh_priv, "file", file);
+    nh_priv.getParam("summary", summary);
+    Param(nh_priv, "dx", steps[0]);
+    Param(nh_priv, "dy", steps[1]);
+    Param(nh_priv, "dz", steps[2]);
+    Param(nh_priv, "x", bounds[0]);
+    Param(nh_priv, "y", bounds[1]);
+    Param(nh_priv, "z", bounds[2]);
+    Param(nh_priv, "orientations", orientations);
+    Param(nh_priv, "rpy_min", rpy_min);
+    Param(nh_priv, "rpy_max", rpy_max);
+    Param(nh_priv, "rpy_steps", rpy_steps);
+    Param(nh_priv, "so3_samples", so3_samples);
+    Param(nh_priv, "max_angle", max_angle);
+    Param(nh_priv, "threads", threads);
+    const unsigned int n_threads = workspace::threadCount(threads);
+
+    vector<vpRotationMatrix> R;
+    if(orientations == "rpy")
+        R = workspace::rpyBox(rpy_min, rpy_max, rpy_steps);
+    else if(orientations == "so3")
+        R = workspace::so3Set(max(so3_samples, 1), space.homeRotation(), max_angle);
+    else
+    {
+        CDPR_ERROR("workspace_6d: orientations should be rpy or so3, not " << orientations);
+        return 1;
+    }
+    const unsigned int samples = R.size();
+    if(!samples)
+    {
+        CDPR_ERROR("workspace_6d: no orientation samples");
+        return 1;
+    }
+    vector<vpThetaUVector> tu;
+    for(const auto &Ri: R)
+        tu.push_back(vpThetaUVector(Ri));
+
+    const Grid grid(bounds, steps);
+    // cells are evaluated by chunks of about 4M poses
+    const size_t cells = grid.cells(), chunk = max<size_t>(1, (1 << 22)/samples);
+    CDPR_INFO("workspace_6d: " << grid.size[0] << " x " << grid.size[1] << " x " << grid.size[2] << " cells, "
+              << samples << " orientations, " << space.wrenchSet().size() << " wrenches, " << n_threads << " threads");
+
+    vpIoTools::makeDirectory(vpIoTools::getParent(file));
+    OrientationMap::Writer writer(file, grid.size, grid.origin, grid.step, tu);
+    vector<float> fractions;
+    vector<vpMatrix> W(n_threads);
+    vector<char> feasible(min(chunk, cells)*samples);
+    vector<OrientationMap::Run> runs;
+    size_t total_runs = 0, total_feasible = 0;
+
+    const auto start = chrono::steady_clock::now();
+    for(size_t first = 0; first < cells; first += chunk)
+    {
+        // orientations of a cell are contiguous
+        const size_t n_cells = min(chunk, cells - first);
+        workspace::parallelFor(n_cells*samples, n_threads, [&](size_t n, unsigned int thread)
+        {
+            double p[3];
+            grid.position(first + n/samples, p);
+            const vpHomogeneousMatrix M(vpTranslationVector(p[0], p[1], p[2]), R[n % samples]);
+            space.computeW(M, W[thread]);
+            feasible[n] = space.margin(W[thread]) >= 0;
+        });
+        for(size_t c = 0; c < n_cells; ++c)
+        {
+            OrientationMap::encode(feasible.data() + c*samples, samples, runs);
+            writer.add(runs);
+            total_runs += runs.size();
+            unsigned int count = 0;
+            for(const auto &run: runs)
+                count += run.end - run.begin;
+            total_feasible += count;
+            // only kept for the summary, 2 floats per cell
+            if(summary.size())
+            {
+                fractions.push_back(float(count)/samples);
+                fractions.push_back(count > 0);
+            }
+        }
+        CDPR_DEBUG("workspace_6d: " << first + n_cells << " / " << cells << " cells");
+    }
+    const double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    bool ok = writer.close();
+    if(ok && summary.size())
+        ok = GridMap::write(summary, grid.size, grid.origin, grid.step, {"fraction", "feasible"}, fractions);
+    const size_t poses = cells*samples, bytes = total_runs*sizeof(OrientationMap::Run) + (cells+1)*sizeof(uint64_t);
+    if(ok)
+        CDPR_INFO("workspace_6d: " << total_feasible << " / " << poses << " feasible poses in " << elapsed << " s, "
+                  << poses/max(elapsed, 1e-9) << " poses/s, " << 1e6*elapsed*n_threads/poses << " us per pose and thread, "
+                  << total_runs << " runs, " << bytes/1e6 << " MB instead of " << poses/8e6 << " MB as a bitset, written to " << file);
+    cdpr_log::flush();
+    return ok ? 0 : 1;
+}
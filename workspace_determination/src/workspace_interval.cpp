@@ -0,0 +1,181 @@
+#include <cdpr/grid_map.h>
+#include <cdpr/log.h>
+#include <workspace_determination/workspace.h>
+#include <workspace_determination/parallel.h>
+#include <workspace_determination/interval.h>
+#include <visp/vpIoTools.h>
+#include <chrono>
+#include <fstream>
+
+using namespace std;
+
+/*
+ * Certified wrench-feasible workspace at a fixed orientation with interval analysis (interval.h)
+ *
+ * Boxes of positions are classified as inside (all positions feasible), outside (none) or undecided.
+ * Undecided boxes are split in two along their largest side until min_size. Each wave of the box queue
+ * is evaluated in parallel.
+ *
+ * Writes the boxes to file, one per line: x_min x_max y_min y_max z_min z_max status (1 inside, 0 outside, 2 undecided)
+ * and optionally a GridMap of step map_step to map with fields:
+ *  feasible    1 in inside boxes, 0 elsewhere
+ *  certified   status of the box
+ *
+ * Needs the model on the parameter server, private parameters:
+ *  file, map, map_step, min_size, x / y / z ([min, max], default from the frame points),
+ *  rpy (orientation, default home), threads (0 for all cores), wrench_set (list of 6-vectors, world frame)
+ */
+
+template <class T>
+void Param(ros::NodeHandle &nh, const string &key, T &val)
+{
+    if(nh.hasParam(key))
+        nh.getParam(key, val);
+    else
+        nh.setParam(key, val);
+}
+
+struct Box
+{
+    double lo[3], hi[3];
+    workspace::BoxStatus status;
+
+    inline double volume() const {return (hi[0]-lo[0])*(hi[1]-lo[1])*(hi[2]-lo[2]);}
+};
+
+int main(int argc, char ** argv)
+{
+    ros::init(argc, argv, "workspace_interval");
+    ros::NodeHandle node_w, nh_priv("~");
+    cdpr_log::setLevel(ros::param::param<std::string>("~log_level", "info"));
+
+    Workspace space(node_w);
+
+    string file = "/home/" + vpIoTools::getUserName() + "/Results/cdpr/workspace_boxes.txt", map;
+    double min_size = 0.02, map_step = 0.05;
+    int threads = 0;
+    vector<double> bounds[3], rpy;
+    space.frameBounds(bounds);
+    const vpRxyzVector rpy_home(space.homeRotation());
+    for(unsigned int a = 0; a < 3; ++a)
+        rpy.push_back(rpy_home[a]);
+    Param(nh_priv, "file", file);
+    nh_priv.getParam("map", map);
+    Param(nh_priv, "map_step", map_step);
+    Param(nh_priv, "min_size", min_size);
+    Param(nh_priv, "x", bounds[0]);
+    Param(nh_priv, "y", bounds[1]);
+    Param(nh_priv, "z", bounds[2]);
+    Param(nh_priv, "rpy", rpy);
+    Param(nh_priv, "threads", threads);
+    if(rpy.size() != 3)
+    {
+        CDPR_WARN("workspace_interval: rpy should have 3 angles, using the home orientation");
+        rpy = {rpy_home[0], rpy_home[1], rpy_home[2]};
+    }
+    const unsigned int n_threads = workspace::threadCount(threads);
+    const vpRotationMatrix R(vpRxyzVector(rpy[0], rpy[1], rpy[2]));
+
+    Box root;
+    for(unsigned int a = 0; a < 3; ++a)
+    {
+        root.lo[a] = bounds[a][0];
+        root.hi[a] = bounds[a][1];
+    }
+    vector<Box> queue(1, root), next, boxes;
+    vector<vpMatrix> W_lo(n_threads), W_hi(n_threads);
+    size_t evaluations = 0;
+
+    const auto start = chrono::steady_clock::now();
+    while(queue.size())
+    {
+        workspace::parallelFor(queue.size(), n_threads, [&](size_t b, unsigned int thread)
+        {
+            Box &box = queue[b];
+            workspace::intervalW(space, R, box.lo, box.hi, W_lo[thread], W_hi[thread]);
+            box.status = workspace::classify(space, W_lo[thread], W_hi[thread]);
+        }, 1);
+        evaluations += queue.size();
+
+        next.clear();
+        for(const auto &box: queue)
+        {
+            unsigned int axis = 0;
+            for(unsigned int a = 1; a < 3; ++a)
+                if(box.hi[a] - box.lo[a] > box.hi[axis] - box.lo[axis])
+                    axis = a;
+            if(box.status != workspace::UNDECIDED || box.hi[axis] - box.lo[axis] <= min_size)
+            {
+                boxes.push_back(box);
+                continue;
+            }
+            Box half = box;
+            half.hi[axis] = 0.5*(box.lo[axis] + box.hi[axis]);
+            next.push_back(half);
+            half.lo[axis] = half.hi[axis];
+            half.hi[axis] = box.hi[axis];
+            next.push_back(half);
+        }
+        queue.swap(next);
+    }
+    const double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    double volume[3] = {0, 0, 0};
+    size_t count[3] = {0, 0, 0};
+    for(const auto &box: boxes)
+    {
+        volume[box.status] += box.volume();
+        count[box.status]++;
+    }
+
+    vpIoTools::makeDirectory(vpIoTools::getParent(file));
+    ofstream out(file, ios::trunc);
+    out << "# x_min x_max y_min y_max z_min z_max status (1 inside, 0 outside, 2 undecided)\n";
+    for(const auto &box: boxes)
+        out << box.lo[0] << " " << box.hi[0] << " " << box.lo[1] << " " << box.hi[1] << " "
+            << box.lo[2] << " " << box.hi[2] << " " << box.status << "\n";
+    bool ok = bool(out);
+    if(!ok)
+        CDPR_ERROR("workspace_interval: cannot write " << file);
+
+    if(ok && map.size())
+    {
+        // cells whose center is in a box
+        const double steps[3] = {map_step, map_step, map_step};
+        const Grid grid(bounds, steps);
+        vector<float> data(2*grid.cells(), 0);
+        for(const auto &box: boxes)
+        {
+            unsigned int first[3], last[3];
+            bool empty = false;
+            for(unsigned int a = 0; a < 3; ++a)
+            {
+                const double lo = max(0., ceil((box.lo[a] - grid.origin[a])/grid.step[a]));
+                const double hi = min(grid.size[a] - 1., floor((box.hi[a] - grid.origin[a])/grid.step[a]));
+                empty |= lo > hi;
+                first[a] = lo;
+                last[a] = hi;
+            }
+            if(empty)
+                continue;
+            for(unsigned int k = first[2]; k <= last[2]; ++k)
+                for(unsigned int j = first[1]; j <= last[1]; ++j)
+                    for(unsigned int i = first[0]; i <= last[0]; ++i)
+                    {
+                        const size_t c = grid.index(i, j, k);
+                        data[2*c] = box.status == workspace::INSIDE;
+                        data[2*c+1] = box.status;
+                    }
+        }
+        vpIoTools::makeDirectory(vpIoTools::getParent(map));
+        ok = GridMap::write(map, grid.size, grid.origin, grid.step, {"feasible", "certified"}, data);
+    }
+
+    if(ok)
+        CDPR_INFO("workspace_interval: " << evaluations << " box evaluations in " << elapsed << " s on " << n_threads << " threads, "
+                  << count[workspace::INSIDE] << " boxes inside (" << volume[workspace::INSIDE] << " m3), "
+                  << count[workspace::OUTSIDE] << " outside (" << volume[workspace::OUTSIDE] << " m3), "
+                  << count[workspace::UNDECIDED] << " undecided (" << volume[workspace::UNDECIDED] << " m3), written to " << file);
+    cdpr_log::flush();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,235 @@
+#include <cdpr/grid_map.h>
+#include <cdpr/log.h>
+#include <workspace_determination/workspace.h>
+#include <workspace_determination/parallel.h>
+#include <workspace_determination/orientations.h>
+#include <workspace_determination/orientation_map.h>
+#include <workspace_determination/mpi_tiles.h>
+#include <visp/vpIoTools.h>
+#include <chrono>
+#include <memory>
+
+using namespace std;
+
+/*
+ * 6D wrench-feasible workspace distributed over MPI ranks, same output as workspace_6d
+ *
+ * The grid is split into tiles of consecutive cells. Rank 0 hands out the tiles to the other ranks as they become idle,
+ * feasibility is cheaper in some regions so tiles do not all take the same time (mpi_tiles.h).
+ * Each rank evaluates its tile with all its threads and sends back the runs of feasible orientations of each cell,
+ * rank 0 merges them in cell order into one OrientationMap. With a single rank it evaluates the tiles itself.
+ *
+ *  mpirun -np 4 rosrun workspace_determination workspace_mpi _file:=...
+ * every rank reads the model from the parameter server, on several machines ROS_MASTER_URI should be exported to all of
+ * them (mpirun -x ROS_MASTER_URI). The other parameters are read by rank 0 only.
+ * scripts/mpi_scaling.py runs the same sweep from 1 to N ranks.
+ *
+ * Private parameters of workspace_6d, and:
+ *  tile        cells per tile (0 for one row along x)
+ *  threads     per rank (0 for all cores of its machine)
+ */
+
+template <class T>
+void Param(ros::NodeHandle &nh, const string &key, T &val)
+{
+    if(nh.hasParam(key))
+        nh.getParam(key, val);
+    else
+        nh.setParam(key, val);
+}
+
+int main(int argc, char ** argv)
+{
+    int provided, rank, size;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    // node names have to be unique
+    ros::init(argc, argv, rank ? "workspace_mpi_" + to_string(rank) : "workspace_mpi");
+    ros::NodeHandle node_w, nh_priv("~");
+    cdpr_log::setLevel(ros::param::param<std::string>("~log_level", "info"));
+
+    Workspace space(node_w);
+
+    string file = "/home/" + vpIoTools::getUserName() + "/Results/cdpr/workspace_6d.ori", summary, orientations = "rpy";
+    int threads = 0, tile = 0;
+    Grid grid;
+    vector<vpThetaUVector> tu;
+    if(!rank)
+    {
+        double steps[3] = {0.1, 0.1, 0.1}, max_angle = 0.3;
+        int so3_samples = 500;
+        vector<double> bounds[3], rpy_min, rpy_max;
+        vector<int> rpy_steps = {7, 7, 7};
+        space.frameBounds(bounds);
+        const vpRxyzVector rpy_home(space.homeRotation());
+        for(unsigned int a = 0; a < 3; ++a)
+        {
+            rpy_min.push_back(rpy_home[a] - 0.3);
+            rpy_max.push_back(rpy_home[a] + 0.3);
+        }
+        Param(nh_priv, "file", file);
+        nh_priv.getParam("summary", summary);
+        Param(nh_priv, "dx", steps[0]);
+        Param(nh_priv, "dy", steps[1]);
+        Param(nh_priv, "dz", steps[2]);
+        Param(nh_priv, "x", bounds[0]);
+        Param(nh_priv, "y", bounds[1]);
+        Param(nh_priv, "z", bounds[2]);
+        Param(nh_priv, "orientations", orientations);
+        Param(nh_priv, "rpy_min", rpy_min);
+        Param(nh_priv, "rpy_max", rpy_max);
+        Param(nh_priv, "rpy_steps", rpy_steps);
+        Param(nh_priv, "so3_samples", so3_samples);
+        Param(nh_priv, "max_angle", max_angle);
+        Param(nh_priv, "threads", threads);
+        Param(nh_priv, "tile", tile);
+
+        grid = Grid(bounds, steps);
+        if(orientations == "rpy")
+            for(const auto &Ri: workspace::rpyBox(rpy_min, rpy_max, rpy_steps))
+                tu.push_back(vpThetaUVector(Ri));
+        else if(orientations == "so3")
+            for(const auto &Ri: workspace::so3Set(max(so3_samples, 1), space.homeRotation(), max_angle))
+                tu.push_back(vpThetaUVector(Ri));
+        else
+            CDPR_ERROR("workspace_mpi: orientations should be rpy or so3, not " << orientations);
+    }
+
+    // share the grid and the orientations, no samples to stop all ranks
+    unsigned int samples = tu.size();
+    MPI_Bcast(&samples, 1, MPI_UNSIGNED, 0, MPI_COMM_WORLD);
+    if(!samples)
+    {
+        if(!rank)
+            CDPR_ERROR("workspace_mpi: no orientation samples");
+        cdpr_log::flush();
+        MPI_Finalize();
+        return 1;
+    }
+    MPI_Bcast(grid.size, 3, MPI_UNSIGNED, 0, MPI_COMM_WORLD);
+    MPI_Bcast(grid.origin, 3, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    MPI_Bcast(grid.step, 3, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&threads, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&tile, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    vector<double> angles(3*samples);
+    if(!rank)
+        for(unsigned int i = 0; i < samples; ++i)
+            for(unsigned int k = 0; k < 3; ++k)
+                angles[3*i+k] = tu[i][k];
+    MPI_Bcast(angles.data(), angles.size(), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    vector<vpRotationMatrix> R;
+    for(unsigned int i = 0; i < samples; ++i)
+        R.push_back(vpRotationMatrix(vpThetaUVector(angles[3*i], angles[3*i+1], angles[3*i+2])));
+
+    // the evaluation threads do not call MPI, but the library should still allow them
+    if(provided < MPI_THREAD_FUNNELED)
+    {
+        if(!rank)
+            CDPR_WARN("workspace_mpi: MPI without thread support, 1 thread per rank");
+        threads = 1;
+    }
+    const unsigned int n_threads = workspace::threadCount(threads);
+    // tiles of at most 4M poses
+    const size_t cells = grid.cells();
+    const size_t tile_cells = min<size_t>(tile > 0 ? tile : grid.size[0], max<size_t>(1, (1 << 22)/samples));
+    const uint32_t tiles = (cells + tile_cells - 1)/tile_cells;
+    if(!rank)
+        CDPR_INFO("workspace_mpi: " << grid.size[0] << " x " << grid.size[1] << " x " << grid.size[2] << " cells, "
+                  << samples << " orientations, " << space.wrenchSet().size() << " wrenches, "
+                  << tiles << " tiles of " << tile_cells << " cells, " << size << " ranks, " << n_threads << " threads on rank 0");
+
+    vector<vpMatrix> W(n_threads);
+    vector<char> feasible(tile_cells*samples);
+    vector<OrientationMap::Run> runs;
+
+    // tile buffer: for each cell the number of runs, then their bounds
+    auto evaluate = [&](uint32_t t, vector<uint32_t> &buffer)
+    {
+        const size_t first = t*tile_cells, n_cells = min(tile_cells, cells - first);
+        workspace::parallelFor(n_cells*samples, n_threads, [&](size_t n, unsigned int thread)
+        {
+            double p[3];
+            grid.position(first + n/samples, p);
+            const vpHomogeneousMatrix M(vpTranslationVector(p[0], p[1], p[2]), R[n % samples]);
+            space.computeW(M, W[thread]);
+            feasible[n] = space.margin(W[thread]) >= 0;
+        });
+        for(size_t c = 0; c < n_cells; ++c)
+        {
+            OrientationMap::encode(feasible.data() + c*samples, samples, runs);
+            buffer.push_back(runs.size());
+            for(const auto &run: runs)
+            {
+                buffer.push_back(run.begin);
+                buffer.push_back(run.end);
+            }
+        }
+    };
+
+    // only rank 0 writes
+    unique_ptr<OrientationMap::Writer> writer;
+    if(!rank)
+    {
+        vpIoTools::makeDirectory(vpIoTools::getParent(file));
+        writer.reset(new OrientationMap::Writer(file, grid.size, grid.origin, grid.step, tu));
+    }
+    vector<float> fractions;
+    size_t total_runs = 0, total_feasible = 0;
+    vector<OrientationMap::Run> merged;
+    auto merge = [&](uint32_t t, const vector<uint32_t> &buffer)
+    {
+        size_t k = 0;
+        while(k < buffer.size())
+        {
+            merged.resize(buffer[k++]);
+            unsigned int count = 0;
+            for(auto &run: merged)
+            {
+                run.begin = buffer[k++];
+                run.end = buffer[k++];
+                count += run.end - run.begin;
+            }
+            writer->add(merged);
+            total_runs += merged.size();
+            total_feasible += count;
+            if(summary.size())
+            {
+                fractions.push_back(float(count)/samples);
+                fractions.push_back(count > 0);
+            }
+        }
+        CDPR_DEBUG("workspace_mpi: " << t + 1 << " / " << tiles << " tiles");
+    };
+
+    const auto start = chrono::steady_clock::now();
+    const workspace::mpi::Stats stats = workspace::mpi::distribute(MPI_COMM_WORLD, tiles, evaluate, merge);
+    const double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    bool ok = true;
+    if(!rank)
+    {
+        ok = writer->close();
+        if(ok && summary.size())
+            ok = GridMap::write(summary, grid.size, grid.origin, grid.step, {"fraction", "feasible"}, fractions);
+        const size_t poses = cells*samples;
+        if(ok)
+        {
+            CDPR_INFO("workspace_mpi: " << total_feasible << " / " << poses << " feasible poses in " << elapsed << " s, "
+                      << poses/max(elapsed, 1e-9) << " poses/s, " << total_runs << " runs, written to " << file);
+            // balance between the ranks that evaluated tiles
+            for(int r = 0; r < size; ++r)
+                if(stats.tiles[r])
+                    CDPR_INFO("workspace_mpi: rank " << r << " " << stats.tiles[r] << " tiles, busy "
+                              << 100*stats.busy[r]/max(elapsed, 1e-9) << " %");
+            CDPR_DEBUG("workspace_mpi: at most " << stats.pending << " tiles waiting to be merged");
+        }
+    }
+    // the other ranks should not report success if rank 0 could not write
+    int status = ok ? 0 : 1;
+    MPI_Bcast(&status, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    cdpr_log::flush();
+    MPI_Finalize();
+    return status;
+}